@@ -0,0 +1,606 @@
+#ifndef ARRAY_HEAP_H
+#define ARRAY_HEAP_H
+
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <functional>
+#include <queue>
+#include <vector>
+#include <sstream>
+#include "data_types.h" // Включаем определения пользовательских типов
+#include "text_io.h"
+#include "value_index.h"
+
+// Шаблонный класс d-арной кучи на непрерывном массиве (max heap по умолчанию)
+// Узлы хранятся в уровневом порядке: потомки элемента i занимают позиции
+// Arity*i+1 ... Arity*i+Arity, родитель - позицию (i-1)/Arity.
+// При Arity = 2 это обычная бинарная куча с тем же публичным интерфейсом, что и BinaryHeap.
+// Большая арность уменьшает глубину дерева, а потомки одного узла лежат подряд в памяти.
+template <typename T, typename Comparator = std::less<T>, size_t Arity = 2>
+class ArrayHeap {
+    static_assert(Arity >= 2, "Арность кучи должна быть не меньше 2");
+    
+private:
+    std::vector<T> data;  // Элементы кучи в уровневом порядке
+    Comparator comp;      // Компаратор для определения порядка элементов
+    
+    // Вычисление позиций по индексу
+    static size_t parentOf(size_t index) { return (index - 1) / Arity; }
+    static size_t firstChildOf(size_t index) { return Arity * index + 1; }
+    
+    // Вспомогательные методы
+    
+    // Восстановление свойства кучи при добавлении элемента (просеивание вверх)
+    void heapifyUp(size_t index);
+    
+    // Восстановление свойства кучи при удалении элемента (просеивание вниз)
+    void heapifyDown(size_t index);
+    
+    // Поиск позиции элемента по значению (size() если не найден)
+    size_t findIndex(const T& value) const;
+    
+    // Удаление элемента по позиции
+    void removeAt(size_t index);
+    
+    // Сравнение поддерева с корнем index с другой кучей
+    bool areIdentical(size_t index, const ArrayHeap& other) const;
+    
+    // Обход поддерева с корнем index в порядке, заданном форматом
+    void collectByFormat(size_t index, const std::string& format, std::vector<T>& values) const;
+
+public:
+    // Конструкторы и деструкторы
+    ArrayHeap();
+    
+    // Базовые операции
+    void insert(const T& value);       // Вставка элемента
+    bool search(const T& value) const; // Поиск элемента
+    bool remove(const T& value);       // Удаление элемента
+    T extractMax();                    // Извлечение максимального элемента (для max-heap)
+    
+    // Дополнительные операции
+    bool isEmpty() const;              // Проверка на пустоту
+    size_t getSize() const;            // Получение размера кучи
+    void clear();                      // Очистка кучи
+    void reserve(size_t capacity);     // Резервирование памяти под элементы
+    
+    // Построение кучи из набора значений за O(n) (просеивание снизу вверх, метод Флойда)
+    // Текущее содержимое кучи заменяется
+    void build(const std::vector<T>& values);
+    template <typename InputIt>
+    void build(InputIt first, InputIt last);
+    
+    // 2.2 Извлечение поддерева (по заданному элементу)
+    ArrayHeap<T, Comparator, Arity> extractSubHeap(const T& value);
+    
+    // 2.3 Поиск на вхождение поддерева
+    bool containsSubHeap(const ArrayHeap<T, Comparator, Arity>& subheap) const;
+    
+    // 2.4 Сохранение в строку
+    // 2.4.1 по фиксированному обходу
+    std::string toString() const;
+    
+    // 2.4.2 по обходу, задаваемому строкой форматирования
+    std::string toStringFormatted(const std::string& format) const;
+    
+    // 2.4.3 в формате списка пар «узел-родитель»
+    std::string toNodeParentPairs() const;
+    
+    // 2.5 Чтение из строки
+    // 2.5.1 по фиксированному обходу
+    static ArrayHeap<T, Comparator, Arity> fromString(const std::string& str);
+    
+    // 2.5.2 по обходу, задаваемому строкой форматирования
+    static ArrayHeap<T, Comparator, Arity> fromStringFormatted(const std::string& str, const std::string& format);
+    
+    // 2.5.3 в формате списка пар «узел-родитель»
+    static ArrayHeap<T, Comparator, Arity> fromNodeParentPairs(const std::vector<std::pair<T, T>>& pairs);
+    
+    // Получение вершины кучи
+    T top() const;
+    
+    // Обход кучи с вызовом функции обратного вызова для каждого элемента
+    // Шаблонная версия принимает любой вызываемый объект и встраивается компилятором
+    void traverse(std::function<void(const T&)> callback) const;
+    template <typename F>
+    void traverse(F&& callback) const;
+    
+    // Вывод кучи в консоль (для отладки)
+    void printHeap() const;
+};
+
+// Реализация методов класса ArrayHeap
+
+// Конструктор по умолчанию
+template <typename T, typename Comparator, size_t Arity>
+ArrayHeap<T, Comparator, Arity>::ArrayHeap() : data(), comp() {}
+
+// Проверка, пуста ли куча
+template <typename T, typename Comparator, size_t Arity>
+bool ArrayHeap<T, Comparator, Arity>::isEmpty() const {
+    return data.empty();
+}
+
+// Получение размера кучи
+template <typename T, typename Comparator, size_t Arity>
+size_t ArrayHeap<T, Comparator, Arity>::getSize() const {
+    return data.size();
+}
+
+// Очистка кучи
+template <typename T, typename Comparator, size_t Arity>
+void ArrayHeap<T, Comparator, Arity>::clear() {
+    data.clear();
+}
+
+// Резервирование памяти под элементы
+template <typename T, typename Comparator, size_t Arity>
+void ArrayHeap<T, Comparator, Arity>::reserve(size_t capacity) {
+    data.reserve(capacity);
+}
+
+// Построение кучи из вектора значений за O(n)
+template <typename T, typename Comparator, size_t Arity>
+void ArrayHeap<T, Comparator, Arity>::build(const std::vector<T>& values) {
+    build(values.begin(), values.end());
+}
+
+// Построение кучи из диапазона значений за O(n)
+template <typename T, typename Comparator, size_t Arity>
+template <typename InputIt>
+void ArrayHeap<T, Comparator, Arity>::build(InputIt first, InputIt last) {
+    data.assign(first, last);
+    
+    // Просеиваем вниз все внутренние узлы, начиная с родителя последнего элемента
+    size_t internalCount = data.size() > 1 ? parentOf(data.size() - 1) + 1 : 0;
+    for (size_t i = internalCount; i-- > 0; ) {
+        heapifyDown(i);
+    }
+}
+
+// Восстановление свойства кучи при добавлении элемента (просеивание вверх)
+template <typename T, typename Comparator, size_t Arity>
+void ArrayHeap<T, Comparator, Arity>::heapifyUp(size_t index) {
+    // Поднимаем элемент "дыркой", без лишних обменов
+    T value = std::move(data[index]);
+    while (index > 0) {
+        size_t parent = parentOf(index);
+        if (!comp(data[parent], value)) break;
+        data[index] = std::move(data[parent]);
+        index = parent;
+    }
+    data[index] = std::move(value);
+}
+
+// Восстановление свойства кучи при удалении элемента (просеивание вниз)
+template <typename T, typename Comparator, size_t Arity>
+void ArrayHeap<T, Comparator, Arity>::heapifyDown(size_t index) {
+    const size_t count = data.size();
+    T value = std::move(data[index]);
+    
+    while (true) {
+        size_t first = firstChildOf(index);
+        if (first >= count) break;
+        
+        // Выбираем наибольшего из потомков
+        size_t largest = first;
+        if constexpr (Arity == 2) {
+            size_t right = first + 1;
+            if (right < count && comp(data[largest], data[right])) {
+                largest = right;
+            }
+        } else if (first + Arity <= count) {
+            // Все потомки на месте: цикл фиксированной длины разворачивается компилятором
+            for (size_t child = first + 1; child < first + Arity; ++child) {
+                if (comp(data[largest], data[child])) {
+                    largest = child;
+                }
+            }
+        } else {
+            // Последний узел с неполным набором потомков
+            for (size_t child = first + 1; child < count; ++child) {
+                if (comp(data[largest], data[child])) {
+                    largest = child;
+                }
+            }
+        }
+        
+        // Если текущий элемент не меньше потомка, завершаем
+        if (!comp(value, data[largest])) break;
+        
+        data[index] = std::move(data[largest]);
+        index = largest;
+    }
+    
+    data[index] = std::move(value);
+}
+
+// Поиск позиции элемента по значению
+template <typename T, typename Comparator, size_t Arity>
+size_t ArrayHeap<T, Comparator, Arity>::findIndex(const T& value) const {
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (data[i] == value) return i;
+    }
+    return data.size();
+}
+
+// Удаление элемента по позиции
+template <typename T, typename Comparator, size_t Arity>
+void ArrayHeap<T, Comparator, Arity>::removeAt(size_t index) {
+    // Заменяем удаляемый элемент последним
+    if (index + 1 != data.size()) {
+        data[index] = std::move(data.back());
+        data.pop_back();
+        
+        // Восстанавливаем свойство кучи
+        heapifyDown(index);
+        heapifyUp(index);
+    } else {
+        data.pop_back();
+    }
+}
+
+// Вставка элемента в кучу
+template <typename T, typename Comparator, size_t Arity>
+void ArrayHeap<T, Comparator, Arity>::insert(const T& value) {
+    data.push_back(value);
+    heapifyUp(data.size() - 1);
+}
+
+// Поиск элемента в куче
+template <typename T, typename Comparator, size_t Arity>
+bool ArrayHeap<T, Comparator, Arity>::search(const T& value) const {
+    return findIndex(value) != data.size();
+}
+
+// Удаление элемента из кучи
+template <typename T, typename Comparator, size_t Arity>
+bool ArrayHeap<T, Comparator, Arity>::remove(const T& value) {
+    size_t index = findIndex(value);
+    if (index == data.size()) return false;
+    
+    removeAt(index);
+    return true;
+}
+
+// Извлечение максимального элемента (для max-heap)
+template <typename T, typename Comparator, size_t Arity>
+T ArrayHeap<T, Comparator, Arity>::extractMax() {
+    if (isEmpty()) {
+        throw std::runtime_error("Куча пуста");
+    }
+    
+    T result = std::move(data[0]);
+    if (data.size() > 1) {
+        data[0] = std::move(data.back());
+        data.pop_back();
+        heapifyDown(0);
+    } else {
+        data.pop_back();
+    }
+    return result;
+}
+
+// Получение вершины кучи
+template <typename T, typename Comparator, size_t Arity>
+T ArrayHeap<T, Comparator, Arity>::top() const {
+    if (isEmpty()) {
+        throw std::runtime_error("Куча пуста");
+    }
+    
+    return data[0];
+}
+
+// 2.2 Извлечение поддерева (по заданному элементу)
+template <typename T, typename Comparator, size_t Arity>
+ArrayHeap<T, Comparator, Arity> ArrayHeap<T, Comparator, Arity>::extractSubHeap(const T& value) {
+    ArrayHeap<T, Comparator, Arity> result;
+    
+    size_t index = findIndex(value);
+    if (index == data.size()) return result;
+    
+    // Потомки узла на каждом уровне занимают непрерывный отрезок массива,
+    // поэтому поддерево копируется по уровням без потери формы
+    size_t first = index;
+    size_t width = 1;
+    while (first < data.size()) {
+        size_t last = std::min(first + width, data.size());
+        result.data.insert(result.data.end(), data.begin() + first, data.begin() + last);
+        first = firstChildOf(first);
+        width *= Arity;
+    }
+    
+    return result;
+}
+
+// Сравнение поддерева с корнем index с другой кучей
+template <typename T, typename Comparator, size_t Arity>
+bool ArrayHeap<T, Comparator, Arity>::areIdentical(size_t index, const ArrayHeap& other) const {
+    // Сравниваем уровни поддерева с уровнями другой кучи
+    size_t first = index;
+    size_t otherFirst = 0;
+    size_t width = 1;
+    while (first < data.size() || otherFirst < other.data.size()) {
+        size_t last = std::min(first + width, data.size());
+        size_t otherLast = std::min(otherFirst + width, other.data.size());
+        size_t levelSize = first < data.size() ? last - first : 0;
+        size_t otherLevelSize = otherFirst < other.data.size() ? otherLast - otherFirst : 0;
+        
+        if (levelSize != otherLevelSize) return false;
+        for (size_t i = 0; i < levelSize; ++i) {
+            if (!(data[first + i] == other.data[otherFirst + i])) return false;
+        }
+        
+        first = firstChildOf(first);
+        otherFirst = firstChildOf(otherFirst);
+        width *= Arity;
+    }
+    return true;
+}
+
+// 2.3 Поиск на вхождение поддерева
+template <typename T, typename Comparator, size_t Arity>
+bool ArrayHeap<T, Comparator, Arity>::containsSubHeap(const ArrayHeap<T, Comparator, Arity>& subheap) const {
+    if (subheap.isEmpty()) return true;
+    if (isEmpty()) return false;
+    
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (data[i] == subheap.data[0] && areIdentical(i, subheap)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 2.4.1 Сохранение в строку по фиксированному обходу (уровневый обход)
+template <typename T, typename Comparator, size_t Arity>
+std::string ArrayHeap<T, Comparator, Arity>::toString() const {
+    if (isEmpty()) return "[]";
+    
+    std::string result = "[";
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (i > 0) result += ',';
+        appendValue(result, data[i]);
+    }
+    result += ']';
+    return result;
+}
+
+// Обход поддерева с корнем index в порядке, заданном форматом
+// Левое поддерево (Л) - первая половина потомков, правое (П) - вторая половина
+template <typename T, typename Comparator, size_t Arity>
+void ArrayHeap<T, Comparator, Arity>::collectByFormat(size_t index, const std::string& format, std::vector<T>& values) const {
+    if (index >= data.size()) return;
+    
+    size_t first = firstChildOf(index);
+    size_t middle = first + Arity / 2;
+    size_t last = first + Arity;
+    
+    auto visitLeft = [&]() {
+        for (size_t child = first; child < middle; ++child) {
+            collectByFormat(child, format, values);
+        }
+    };
+    auto visitRight = [&]() {
+        for (size_t child = middle; child < last; ++child) {
+            collectByFormat(child, format, values);
+        }
+    };
+    
+    if (format == "КЛП") {
+        values.push_back(data[index]);
+        visitLeft();
+        visitRight();
+    } else if (format == "ЛКП") {
+        visitLeft();
+        values.push_back(data[index]);
+        visitRight();
+    } else if (format == "ЛПК") {
+        visitLeft();
+        visitRight();
+        values.push_back(data[index]);
+    } else if (format == "КПЛ") {
+        values.push_back(data[index]);
+        visitRight();
+        visitLeft();
+    } else if (format == "ПКЛ") {
+        visitRight();
+        values.push_back(data[index]);
+        visitLeft();
+    } else if (format == "ПЛК") {
+        visitRight();
+        visitLeft();
+        values.push_back(data[index]);
+    }
+}
+
+// 2.4.2 Сохранение в строку по обходу, задаваемому строкой форматирования
+template <typename T, typename Comparator, size_t Arity>
+std::string ArrayHeap<T, Comparator, Arity>::toStringFormatted(const std::string& format) const {
+    if (isEmpty()) return "[]";
+    
+    std::vector<T> values;
+    if (format == "КЛП" || format == "ЛКП" || format == "ЛПК" ||
+        format == "КПЛ" || format == "ПКЛ" || format == "ПЛК") {
+        values.reserve(data.size());
+        collectByFormat(0, format, values);
+    } else { // По умолчанию - уровневый обход, совпадающий с порядком массива
+        values = data;
+    }
+    
+    // Форматируем результат в строку
+    std::string result = "[";
+    for (size_t i = 0; i < values.size(); ++i) {
+        if (i > 0) result += ',';
+        appendValue(result, values[i]);
+    }
+    result += ']';
+    
+    return result;
+}
+
+// 2.4.3 Сохранение в формате списка пар «узел-родитель»
+template <typename T, typename Comparator, size_t Arity>
+std::string ArrayHeap<T, Comparator, Arity>::toNodeParentPairs() const {
+    if (isEmpty()) return "[]";
+    
+    // Порядок пар совпадает с префиксным обходом, как в BinaryHeap
+    std::vector<T> values;
+    values.reserve(data.size());
+    std::vector<size_t> order;
+    order.reserve(data.size());
+    
+    std::vector<size_t> stack;
+    stack.push_back(0);
+    while (!stack.empty()) {
+        size_t index = stack.back();
+        stack.pop_back();
+        order.push_back(index);
+        
+        // Кладём потомков в обратном порядке, чтобы первым был извлечён самый левый
+        size_t first = firstChildOf(index);
+        for (size_t child = std::min(first + Arity, data.size()); child-- > first; ) {
+            stack.push_back(child);
+        }
+    }
+    
+    std::string result = "[";
+    for (size_t i = 0; i < order.size(); ++i) {
+        size_t index = order[i];
+        // Для корня в качестве родителя используем само значение корня
+        size_t parent = index == 0 ? 0 : parentOf(index);
+        if (i > 0) result += ',';
+        result += '(';
+        appendValue(result, data[index]);
+        result += ':';
+        appendValue(result, data[parent]);
+        result += ')';
+    }
+    result += ']';
+    return result;
+}
+
+// 2.5.1 Чтение из строки по фиксированному обходу
+template <typename T, typename Comparator, size_t Arity>
+ArrayHeap<T, Comparator, Arity> ArrayHeap<T, Comparator, Arity>::fromString(const std::string& str) {
+    ArrayHeap<T, Comparator, Arity> result;
+    
+    // Парсим строку вида "[value1,value2,value3,...]" за один проход
+    std::vector<T> values;
+    parseValueList(str, values);
+    
+    // Строим кучу
+    result.build(values);
+    
+    return result;
+}
+
+// 2.5.2 Чтение из строки по обходу, задаваемому строкой форматирования
+template <typename T, typename Comparator, size_t Arity>
+ArrayHeap<T, Comparator, Arity> ArrayHeap<T, Comparator, Arity>::fromStringFormatted(const std::string& str, const std::string& format) {
+    // Структура кучи однозначно определяется её свойствами, поэтому порядок обхода
+    // в строке не влияет на результат (аналогично BinaryHeap::fromStringFormatted)
+    (void)format;
+    return fromString(str);
+}
+
+// 2.5.3 Чтение из строки в формате списка пар «узел-родитель»
+template <typename T, typename Comparator, size_t Arity>
+ArrayHeap<T, Comparator, Arity> ArrayHeap<T, Comparator, Arity>::fromNodeParentPairs(const std::vector<std::pair<T, T>>& pairs) {
+    ArrayHeap<T, Comparator, Arity> result;
+    
+    if (pairs.empty()) return result;
+    
+    // Находим корень (узел, который является своим собственным родителем); остальные пары - рёбра
+    const T* rootValue = nullptr;
+    std::vector<size_t> edges;
+    edges.reserve(pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (pairs[i].first == pairs[i].second) {
+            if (!rootValue) rootValue = &pairs[i].first;
+        } else {
+            edges.push_back(i);
+        }
+    }
+    
+    if (!rootValue) {
+        throw std::runtime_error("Корень не найден в списке пар");
+    }
+    
+    // Плоский индекс рёбер по значению родителя (как в BinaryHeap::fromNodeParentPairs)
+    ValueIndex byParent(edges.size(), [&](size_t edge) -> const T& { return pairs[edges[edge]].second; });
+    
+    // Раскладываем узлы в массив в порядке обхода в ширину
+    result.data.reserve(pairs.size());
+    result.data.push_back(*rootValue);
+    for (size_t i = 0; i < result.data.size(); ++i) {
+        auto range = byParent.equalRange(result.data[i]);
+        size_t childCount = range.second - range.first;
+        if (childCount > Arity) {
+            throw std::runtime_error(Arity == 2 ? std::string("Ошибка: узел имеет более двух детей")
+                                                : "Ошибка: узел имеет более " + std::to_string(Arity) + " детей");
+        }
+        // Узлов больше, чем пар, бывает только при цикле из повторяющихся значений
+        if (result.data.size() + childCount > pairs.size()) {
+            throw std::runtime_error("Ошибка: список пар содержит цикл");
+        }
+        for (size_t position = range.first; position < range.second; ++position) {
+            result.data.push_back(pairs[edges[byParent.indexAt(position)]].first);
+        }
+    }
+    
+    if (result.data.size() != pairs.size()) {
+        throw std::runtime_error("Ошибка: не все узлы были добавлены в дерево");
+    }
+    
+    // Массив всегда хранит полное дерево, поэтому свойство кучи восстанавливается
+    // для значений в порядке обхода в ширину
+    std::vector<T> values = std::move(result.data);
+    result.build(values);
+    
+    return result;
+}
+
+// Обход кучи с вызовом функции обратного вызова для каждого элемента (уровневый обход)
+template <typename T, typename Comparator, size_t Arity>
+void ArrayHeap<T, Comparator, Arity>::traverse(std::function<void(const T&)> callback) const {
+    if (!callback) return;
+    
+    traverse<std::function<void(const T&)>&>(callback);
+}
+
+template <typename T, typename Comparator, size_t Arity>
+template <typename F>
+void ArrayHeap<T, Comparator, Arity>::traverse(F&& callback) const {
+    for (const auto& value : data) {
+        callback(value);
+    }
+}
+
+// Вывод кучи в консоль (для отладки)
+template <typename T, typename Comparator, size_t Arity>
+void ArrayHeap<T, Comparator, Arity>::printHeap() const {
+    if (isEmpty()) {
+        std::cout << "Куча пуста" << std::endl;
+        return;
+    }
+    
+    std::cout << "Куча (размер: " << data.size() << "):" << std::endl;
+    
+    // Уровень с номером k занимает отрезок из Arity^k подряд идущих элементов
+    size_t first = 0;
+    size_t width = 1;
+    for (int level = 0; first < data.size(); ++level) {
+        std::cout << "Уровень " << level << ": ";
+        size_t last = std::min(first + width, data.size());
+        for (size_t i = first; i < last; ++i) {
+            std::cout << valueToString(data[i]) << " ";
+        }
+        std::cout << std::endl;
+        first = last;
+        width *= Arity;
+    }
+}
+
+#endif // ARRAY_HEAP_H
@@ -0,0 +1,966 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <cmath>
+#include <functional>
+#include <sstream>
+#include <fstream>
+#include <iterator>
+#include <cstdio>
+#include <type_traits>
+#include <map>
+#include <numeric>
+#include <algorithm>
+#include "../include/binary_heap.h"
+#include "../include/array_heap.h"
+#include "../include/binary_search_tree.h"
+#include "../include/mapped_binary_search_tree.h"
+#include "../include/persistent_binary_search_tree.h"
+#include "../include/pool_allocator.h"
+#include "../include/thread_pool.h"
+#include "../include/data_types.h"
+
+// Измерение времени выполнения функции в секундах
+template <typename F>
+double measureSeconds(F&& func) {
+    auto start = std::chrono::high_resolution_clock::now();
+    func();
+    auto end = std::chrono::high_resolution_clock::now();
+    std::chrono::duration<double> elapsed = end - start;
+    return elapsed.count();
+}
+
+// Бенчмарк вставки и извлечения максимума в куче
+// Отношение времени к n*log2(n) должно оставаться примерно постоянным
+template <typename Heap>
+void benchmarkHeapInsertExtract(const std::string& name) {
+    std::cout << "Бенчмарк вставки и извлечения максимума (" << name << ")..." << std::endl;
+    
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(1, 1000000000);
+    
+    std::vector<size_t> sizes = {125000, 250000, 500000, 1000000};
+    for (size_t n : sizes) {
+        std::vector<int> values(n);
+        for (auto& value : values) {
+            value = dist(gen);
+        }
+        
+        Heap heap;
+        double insertTime = measureSeconds([&]() {
+            for (int value : values) {
+                heap.insert(value);
+            }
+        });
+        
+        double extractTime = measureSeconds([&]() {
+            while (!heap.isEmpty()) {
+                heap.extractMax();
+            }
+        });
+        
+        double nlogn = n * std::log2(static_cast<double>(n));
+        std::cout << "n = " << n
+                  << ": insert " << insertTime << " с (" << insertTime / nlogn * 1e9 << " нс/(n log n))"
+                  << ", extractMax " << extractTime << " с (" << extractTime / nlogn * 1e9 << " нс/(n log n))"
+                  << std::endl;
+    }
+}
+
+// Бенчмарк построения кучи: последовательные вставки против построения за O(n)
+template <typename Heap>
+void benchmarkHeapBuild(const std::string& name) {
+    std::cout << "Бенчмарк построения кучи (" << name << ")..." << std::endl;
+    
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int> dist(1, 1000000000);
+    
+    const size_t n = 1000000;
+    std::vector<int> values(n);
+    for (auto& value : values) {
+        value = dist(gen);
+    }
+    
+    double insertTime = measureSeconds([&]() {
+        Heap heap;
+        for (int value : values) {
+            heap.insert(value);
+        }
+    });
+    
+    double buildTime = measureSeconds([&]() {
+        Heap heap;
+        heap.build(values);
+    });
+    
+    std::cout << "n = " << n << ": вставки " << insertTime << " с, build " << buildTime << " с" << std::endl;
+}
+
+// Бенчмарк d-арных куч: вставка и извлечение максимума для разных арностей
+template <typename T, size_t Arity>
+void benchmarkArity(const std::string& typeName, const std::vector<T>& values) {
+    ArrayHeap<T, std::less<T>, Arity> heap;
+    heap.reserve(values.size());
+    
+    double insertTime = measureSeconds([&]() {
+        for (const auto& value : values) {
+            heap.insert(value);
+        }
+    });
+    
+    double extractTime = measureSeconds([&]() {
+        while (!heap.isEmpty()) {
+            heap.extractMax();
+        }
+    });
+    
+    std::cout << "ArrayHeap<" << typeName << ", " << Arity << ">: insert " << insertTime
+              << " с, extractMax " << extractTime << " с" << std::endl;
+}
+
+void benchmarkHeapArities() {
+    std::cout << "Бенчмарк арности кучи (n = 1000000)..." << std::endl;
+    
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> intDist(1, 1000000000);
+    std::uniform_real_distribution<double> realDist(-1000.0, 1000.0);
+    
+    const size_t n = 1000000;
+    std::vector<int> ints(n);
+    std::vector<Complex> complexes(n);
+    for (size_t i = 0; i < n; ++i) {
+        ints[i] = intDist(gen);
+        complexes[i] = Complex(realDist(gen), realDist(gen));
+    }
+    
+    benchmarkArity<int, 2>("int", ints);
+    benchmarkArity<int, 4>("int", ints);
+    benchmarkArity<int, 8>("int", ints);
+    benchmarkArity<Complex, 2>("Complex", complexes);
+    benchmarkArity<Complex, 4>("Complex", complexes);
+    benchmarkArity<Complex, 8>("Complex", complexes);
+}
+
+// Бенчмарк распределителей узлов: вставка, копирование и очистка дерева и кучи
+template <typename Container>
+void benchmarkNodeAllocation(const std::string& name, const std::vector<int>& values) {
+    Container container;
+    double insertTime = measureSeconds([&]() {
+        for (int value : values) {
+            container.insert(value);
+        }
+    });
+    
+    double copyTime = 0.0;
+    double clearTime = 0.0;
+    {
+        Container copy;
+        copyTime = measureSeconds([&]() {
+            copy = container;
+        });
+        clearTime = measureSeconds([&]() {
+            copy.clear();
+        });
+    }
+    
+    std::cout << name << ": insert " << insertTime << " с, копирование " << copyTime
+              << " с, clear " << clearTime << " с" << std::endl;
+}
+
+void benchmarkNodeAllocators() {
+    std::cout << "Бенчмарк распределителей узлов (n = 1000000)..." << std::endl;
+    
+    std::mt19937 gen(13);
+    std::uniform_int_distribution<int> dist(1, 1000000000);
+    
+    std::vector<int> values(1000000);
+    for (auto& value : values) {
+        value = dist(gen);
+    }
+    
+    benchmarkNodeAllocation<BinarySearchTree<int>>("BinarySearchTree<int>, std::allocator", values);
+    benchmarkNodeAllocation<BinarySearchTree<int, Unbalanced, PoolAllocator<int>>>("BinarySearchTree<int>, PoolAllocator", values);
+    benchmarkNodeAllocation<BinaryHeap<int>>("BinaryHeap<int>, std::allocator", values);
+    benchmarkNodeAllocation<BinaryHeap<int, std::less<int>, PoolAllocator<int>>>("BinaryHeap<int>, PoolAllocator", values);
+}
+
+// Бенчмарк однократного обхода дерева: итератор против копирования значений в вектор
+void benchmarkTreeIteration() {
+    std::cout << "Бенчмарк обхода дерева (n = 1000000)..." << std::endl;
+    
+    std::vector<int> sorted(1000000);
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        sorted[i] = static_cast<int>(i);
+    }
+    auto tree = BinarySearchTree<int>::fromSorted(sorted.begin(), sorted.end());
+    
+    long long iteratorSum = 0;
+    double iteratorTime = measureSeconds([&]() {
+        for (int value : tree) {
+            iteratorSum += value;
+        }
+    });
+    
+    long long copySum = 0;
+    double copyTime = measureSeconds([&]() {
+        for (int value : tree.getValuesInOrder()) {
+            copySum += value;
+        }
+    });
+    
+    long long callbackSum = 0;
+    double callbackTime = measureSeconds([&]() {
+        tree.traverse(TraversalType::InOrder, [&callbackSum](const int& value) {
+            callbackSum += value;
+        });
+    });
+    
+    std::cout << "итератор " << iteratorTime << " с, getValuesInOrder " << copyTime
+              << " с, traverse " << callbackTime << " с (суммы совпадают: "
+              << (iteratorSum == copySum && copySum == callbackSum ? "да" : "нет") << ")" << std::endl;
+}
+
+// Бенчмарк reduce: std::function против шаблонной версии и простого цикла по вектору
+// Дерево помещается в кэш, чтобы время определялось вызовами функции, а не промахами памяти
+void benchmarkTreeReduce() {
+    std::cout << "Бенчмарк reduce (n = 10000, 1000 повторов)..." << std::endl;
+    
+    std::vector<int> keys(10000);
+    for (size_t i = 0; i < keys.size(); ++i) {
+        keys[i] = static_cast<int>(i);
+    }
+    auto tree = BinarySearchTree<int>::fromSorted(keys.begin(), keys.end());
+    const int repeats = 1000;
+    
+    std::function<int(const int&, const int&)> sumFunction = [](const int& value, const int& acc) {
+        return acc + (value & 1);
+    };
+    int functionResult = 0;
+    double functionTime = measureSeconds([&]() {
+        for (int r = 0; r < repeats; ++r) {
+            functionResult += tree.reduce(sumFunction, 0);
+        }
+    });
+    
+    int templateResult = 0;
+    double templateTime = measureSeconds([&]() {
+        for (int r = 0; r < repeats; ++r) {
+            templateResult += tree.reduce([](const int& value, const int& acc) { return acc + (value & 1); }, 0);
+        }
+    });
+    
+    auto countOdd = [](const int& value, const int& acc) { return acc + (value & 1); };
+    auto plus = [](const int& a, const int& b) { return a + b; };
+    int blockedResult = 0;
+    double blockedTime = measureSeconds([&]() {
+        for (int r = 0; r < repeats; ++r) {
+            blockedResult += tree.reduce(countOdd, plus, 0);
+        }
+    });
+    
+    int loopResult = 0;
+    double loopTime = measureSeconds([&]() {
+        for (int r = 0; r < repeats; ++r) {
+            int acc = 0;
+            for (int value : keys) {
+                acc += value & 1;
+            }
+            loopResult += acc;
+        }
+    });
+    
+    std::cout << "std::function " << functionTime << " с, шаблон " << templateTime
+              << " с, ассоциативная (блоками) " << blockedTime
+              << " с, цикл по вектору " << loopTime << " с (результаты совпадают: "
+              << (functionResult == templateResult && templateResult == loopResult && blockedResult == loopResult ? "да" : "нет")
+              << ")" << std::endl;
+}
+
+// Бенчмарк ассоциативной свёртки на дереве из 10^7 элементов: последовательно и параллельно
+void benchmarkParallelReduce() {
+    const size_t n = 10000000;
+    std::cout << "Бенчмарк ассоциативной свёртки (n = " << n << ")..." << std::endl;
+    
+    std::vector<long long> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = static_cast<long long>(i);
+    }
+    auto tree = BinarySearchTree<long long>::fromSorted(keys.begin(), keys.end());
+    keys.clear();
+    keys.shrink_to_fit();
+    
+    auto plus = [](const long long& a, const long long& b) { return a + b; };
+    
+    long long foldResult = 0;
+    double foldTime = measureSeconds([&]() {
+        foldResult = tree.reduce(plus, 0LL);
+    });
+    
+    long long sequentialResult = 0;
+    double sequentialTime = measureSeconds([&]() {
+        sequentialResult = tree.reduce(plus, plus, 0LL);
+    });
+    
+    long long parallelResult = 0;
+    double parallelTime = measureSeconds([&]() {
+        parallelResult = tree.reduce(plus, plus, 0LL, ExecutionMode::Parallel);
+    });
+    
+    std::cout << "reduce(func, init) " << foldTime << " с, последовательно " << sequentialTime
+              << " с, параллельно " << parallelTime << " с (результаты совпадают: "
+              << (foldResult == sequentialResult && sequentialResult == parallelResult ? "да" : "нет") << ")" << std::endl;
+}
+
+// Бенчмарк параллельных map и where на дереве из 10^7 элементов
+void benchmarkParallelMapWhere() {
+    const size_t n = 10000000;
+    std::cout << "Бенчмарк параллельных map и where (n = " << n << ", потоков в пуле: "
+              << ThreadPool::shared().getThreadCount() << ")..." << std::endl;
+    
+    std::vector<int> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = static_cast<int>(i);
+    }
+    auto tree = BinarySearchTree<int>::fromSorted(keys.begin(), keys.end());
+    keys.clear();
+    keys.shrink_to_fit();
+    
+    auto predicate = [](const int& value) { return value % 3 == 0; };
+    auto func = [](const int& value) { return static_cast<int>((value * 2654435761u) >> 4); };
+    
+    for (ExecutionMode mode : {ExecutionMode::Sequential, ExecutionMode::Parallel}) {
+        size_t whereSize = 0;
+        double whereTime = measureSeconds([&]() {
+            whereSize = tree.where(predicate, mode).getSize();
+        });
+        
+        size_t mapSize = 0;
+        double mapTime = measureSeconds([&]() {
+            mapSize = tree.map(func, mode).getSize();
+        });
+        
+        std::cout << (mode == ExecutionMode::Sequential ? "последовательно" : "параллельно")
+                  << ": where " << whereTime << " с (" << whereSize << " элементов), map "
+                  << mapTime << " с (" << mapSize << " элементов)" << std::endl;
+    }
+}
+
+// Бенчмарк преобразования чисел в строку и обратно на дампах из 10^6 элементов
+// Сравниваются прежний способ (ostringstream и stoi/stod с исключениями) и to_chars/from_chars
+template <typename T>
+void benchmarkNumberConversion(const std::string& name, const std::vector<T>& values) {
+    std::string streamDump;
+    double streamWriteTime = measureSeconds([&]() {
+        std::stringstream ss;
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i > 0) ss << ",";
+            std::ostringstream item;
+            item << values[i];
+            ss << item.str();
+        }
+        streamDump = ss.str();
+    });
+    
+    std::string charsDump;
+    double charsWriteTime = measureSeconds([&]() {
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i > 0) charsDump += ',';
+            appendValue(charsDump, values[i]);
+        }
+    });
+    
+    // Разбор дампа с некорректными элементами через каждые 100 значений
+    std::vector<std::string> tokens;
+    tokens.reserve(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        tokens.push_back(i % 100 == 0 ? std::string("x") : valueToString(values[i]));
+    }
+    
+    size_t streamParsed = 0;
+    double streamReadTime = measureSeconds([&]() {
+        for (const auto& token : tokens) {
+            try {
+                if constexpr (std::is_integral<T>::value) {
+                    std::stoi(token);
+                } else {
+                    std::stod(token);
+                }
+                ++streamParsed;
+            } catch (const std::exception&) {
+                // Пропускаем некорректные значения
+            }
+        }
+    });
+    
+    size_t charsParsed = 0;
+    double charsReadTime = measureSeconds([&]() {
+        T value{};
+        for (const auto& token : tokens) {
+            if (tryValueFromString(token, value)) {
+                ++charsParsed;
+            }
+        }
+    });
+    
+    std::cout << name << ": запись ostringstream " << streamWriteTime << " с, to_chars " << charsWriteTime
+              << " с (дампы совпадают: " << (streamDump == charsDump ? "да" : "нет") << "); разбор stoi/stod "
+              << streamReadTime << " с, from_chars " << charsReadTime << " с (разобрано " << streamParsed
+              << " / " << charsParsed << ")" << std::endl;
+}
+
+void benchmarkNumberConversions() {
+    const size_t n = 1000000;
+    std::cout << "Бенчмарк преобразования чисел (n = " << n << ")..." << std::endl;
+    
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> intDistribution(-1000000000, 1000000000);
+    std::uniform_real_distribution<double> doubleDistribution(-1e6, 1e6);
+    
+    std::vector<int> ints(n);
+    std::vector<double> doubles(n);
+    for (size_t i = 0; i < n; ++i) {
+        ints[i] = intDistribution(generator);
+        doubles[i] = doubleDistribution(generator);
+    }
+    
+    benchmarkNumberConversion("int", ints);
+    benchmarkNumberConversion("double", doubles);
+    
+    // Сохранение дерева в строку целиком
+    BinarySearchTree<int> tree;
+    for (int value : ints) {
+        tree.insert(value);
+    }
+    std::string dump;
+    double treeTime = measureSeconds([&]() {
+        dump = tree.toString();
+    });
+    std::cout << "BinarySearchTree<int>::toString: " << treeTime << " с (" << dump.size() << " символов)" << std::endl;
+}
+
+// Прежний разбор строки: после каждого элемента начало строки удаляется через erase
+std::vector<int> parseByErase(const std::string& str) {
+    std::vector<int> values;
+    std::string data = str.substr(1, str.size() - 2);
+    size_t pos = 0;
+    while ((pos = data.find(", ")) != std::string::npos) {
+        values.push_back(valueFromString<int>(data.substr(0, pos)));
+        data.erase(0, pos + 2);
+    }
+    if (!data.empty()) {
+        values.push_back(valueFromString<int>(data));
+    }
+    return values;
+}
+
+// Бенчмарк разбора строкового представления дерева и кучи на многомегабайтных входах
+// Прежний разбор квадратичен по длине строки, поэтому измеряется только на небольших входах
+void benchmarkStringParsing() {
+    std::cout << "Бенчмарк разбора строки..." << std::endl;
+    
+    for (size_t n : {20000, 50000, 1000000, 5000000}) {
+        std::vector<int> keys(n);
+        for (size_t i = 0; i < n; ++i) {
+            keys[i] = static_cast<int>(i * 3);
+        }
+        std::string treeDump = BinarySearchTree<int>::fromSorted(keys.begin(), keys.end()).toString();
+        
+        std::cout << "n = " << n << " (" << treeDump.size() / (1024.0 * 1024.0) << " МБ)";
+        if (n <= 50000) {
+            size_t parsed = 0;
+            double eraseTime = measureSeconds([&]() {
+                parsed = parseByErase(treeDump).size();
+            });
+            std::cout << ": разбор через erase " << eraseTime << " с (" << parsed << " элементов)";
+        }
+        
+        size_t treeSize = 0;
+        double treeTime = measureSeconds([&]() {
+            treeSize = BinarySearchTree<int>::fromString(treeDump).getSize();
+        });
+        std::cout << ", BinarySearchTree::fromString " << treeTime << " с (" << treeSize << ")";
+        treeDump.clear();
+        treeDump.shrink_to_fit();
+        
+        BinaryHeap<int> heap;
+        heap.build(keys);
+        std::string heapDump = heap.toString();
+        heap.clear();
+        size_t heapSize = 0;
+        double heapTime = measureSeconds([&]() {
+            heapSize = BinaryHeap<int>::fromString(heapDump).getSize();
+        });
+        std::cout << ", BinaryHeap::fromString " << heapTime << " с (" << heapSize << ")" << std::endl;
+    }
+}
+
+// Бенчмарк сохранения в файл и загрузки из файла: через строку целиком и через поток
+void benchmarkStreamSerialization() {
+    const size_t n = 5000000;
+    std::cout << "Бенчмарк записи в файл и чтения из файла (n = " << n << ")..." << std::endl;
+    
+    std::vector<int> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = static_cast<int>(i * 3);
+    }
+    auto tree = BinarySearchTree<int>::fromSorted(keys.begin(), keys.end());
+    keys.clear();
+    keys.shrink_to_fit();
+    
+    const char* path = "benchmark_tree.txt";
+    
+    size_t textSize = 0;
+    double stringWriteTime = measureSeconds([&]() {
+        std::string text = tree.toString();
+        textSize = text.size();
+        std::ofstream file(path, std::ios::binary);
+        file << text;
+    });
+    
+    size_t stringLoaded = 0;
+    double stringReadTime = measureSeconds([&]() {
+        std::ifstream file(path, std::ios::binary);
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        stringLoaded = BinarySearchTree<int>::fromString(text).getSize();
+    });
+    
+    double streamWriteTime = measureSeconds([&]() {
+        std::ofstream file(path, std::ios::binary);
+        tree.writeTo(file);
+    });
+    
+    size_t streamLoaded = 0;
+    double streamReadTime = measureSeconds([&]() {
+        std::ifstream file(path, std::ios::binary);
+        streamLoaded = BinarySearchTree<int>::readFrom(file).getSize();
+    });
+    
+    std::remove(path);
+    
+    std::cout << "Текст " << textSize / (1024.0 * 1024.0) << " МБ. Через строку: запись " << stringWriteTime
+              << " с, чтение " << stringReadTime << " с (" << stringLoaded << "). Через поток (буфер "
+              << ChunkedWriter::chunkSize / 1024 << " КБ): запись " << streamWriteTime << " с, чтение "
+              << streamReadTime << " с (" << streamLoaded << ")" << std::endl;
+}
+
+// Бенчмарк двоичного снимка в сравнении с текстовым форматом
+void benchmarkBinarySnapshot() {
+    const size_t n = 5000000;
+    std::cout << "Бенчмарк двоичного снимка (n = " << n << ")..." << std::endl;
+    
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<int> distribution(0, 1000000000);
+    BinarySearchTree<int, AVLBalanced> tree;
+    BinaryHeap<int> heap;
+    std::vector<int> values(n);
+    for (size_t i = 0; i < n; ++i) {
+        values[i] = distribution(generator);
+    }
+    heap.build(values);
+    for (int value : values) {
+        tree.insert(value);
+    }
+    values.clear();
+    values.shrink_to_fit();
+    
+    auto compare = [](const std::string& name, auto& container, auto load, auto loadText) {
+        std::stringstream text;
+        double textWriteTime = measureSeconds([&]() { container.writeTo(text); });
+        size_t textSize = text.str().size();
+        double textReadTime = measureSeconds([&]() { loadText(text); });
+        
+        std::stringstream binary;
+        double binaryWriteTime = measureSeconds([&]() { container.saveSnapshot(binary); });
+        size_t binarySize = binary.str().size();
+        size_t loaded = 0;
+        double binaryReadTime = measureSeconds([&]() { loaded = load(binary).getSize(); });
+        
+        std::cout << name << ": текст " << textSize / (1024.0 * 1024.0) << " МБ (запись " << textWriteTime
+                  << " с, чтение " << textReadTime << " с); снимок " << binarySize / (1024.0 * 1024.0)
+                  << " МБ (запись " << binaryWriteTime << " с, чтение " << binaryReadTime << " с, "
+                  << loaded << " элементов)" << std::endl;
+    };
+    
+    compare("BinarySearchTree<int, AVLBalanced>", tree,
+            [](std::istream& in) { return BinarySearchTree<int, AVLBalanced>::loadSnapshot(in); },
+            [](std::istream& in) { return BinarySearchTree<int, AVLBalanced>::readFrom(in); });
+    compare("BinaryHeap<int>", heap,
+            [](std::istream& in) { return BinaryHeap<int>::loadSnapshot(in); },
+            [](std::istream& in) { return BinaryHeap<int>::readFrom(in); });
+}
+
+// Бенчмарк запуска: загрузка эталонного дерева из текста, из снимка и открытие отображения
+void benchmarkMappedTree() {
+    const size_t n = 5000000;
+    const size_t lookups = 100000;
+    std::cout << "Бенчмарк дерева, отображённого в память (n = " << n << ")..." << std::endl;
+    
+    std::vector<int> keys(n);
+    for (size_t i = 0; i < n; ++i) {
+        keys[i] = static_cast<int>(i * 2);
+    }
+    {
+        auto tree = BinarySearchTree<int>::fromSorted(keys.begin(), keys.end());
+        std::ofstream text("benchmark_reference.txt", std::ios::binary);
+        tree.writeTo(text);
+        std::ofstream snapshot("benchmark_reference.snap", std::ios::binary);
+        tree.saveSnapshot(snapshot);
+        MappedBinarySearchTree<int>::write(tree, "benchmark_reference.bin");
+    }
+    
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<int> distribution(0, static_cast<int>(2 * n));
+    std::vector<int> queries(lookups);
+    for (auto& query : queries) {
+        query = distribution(generator);
+    }
+    
+    auto run = [&](const std::string& name, auto open) {
+        size_t found = 0;
+        double openTime = 0.0;
+        double searchTime = 0.0;
+        openTime = measureSeconds([&]() {
+            auto tree = open();
+            searchTime = measureSeconds([&]() {
+                for (int query : queries) {
+                    found += tree.search(query) ? 1 : 0;
+                }
+            });
+        });
+        std::cout << name << ": открытие и " << lookups << " поисков " << openTime << " с (из них поиск "
+                  << searchTime << " с, найдено " << found << ")" << std::endl;
+    };
+    
+    run("Текст (readFrom)", []() {
+        std::ifstream in("benchmark_reference.txt", std::ios::binary);
+        return BinarySearchTree<int>::readFrom(in);
+    });
+    run("Двоичный снимок (loadSnapshot)", []() {
+        std::ifstream in("benchmark_reference.snap", std::ios::binary);
+        return BinarySearchTree<int>::loadSnapshot(in);
+    });
+    
+    size_t mappedFound = 0;
+    double mappedTime = measureSeconds([&]() {
+        MappedBinarySearchTree<int> mapped("benchmark_reference.bin");
+        for (int query : queries) {
+            mappedFound += mapped.search(query) ? 1 : 0;
+        }
+    });
+    std::cout << "Отображение в память: открытие и " << lookups << " поисков " << mappedTime
+              << " с (найдено " << mappedFound << ")" << std::endl;
+    
+    std::remove("benchmark_reference.txt");
+    std::remove("benchmark_reference.snap");
+    std::remove("benchmark_reference.bin");
+}
+
+// Прежний поиск узлов и корня в списке пар: линейный просмотр списка узлов при каждом
+// обращении и вложенный цикл по родителям и потомкам; возвращает количество узлов
+size_t locateNodesByScan(const std::vector<std::pair<int, int>>& pairs) {
+    std::vector<int> nodeList;
+    auto getNode = [&](int value) {
+        for (int known : nodeList) {
+            if (known == value) return;
+        }
+        nodeList.push_back(value);
+    };
+    std::vector<int> children, parents;
+    for (auto& pr : pairs) {
+        getNode(pr.first);
+        getNode(pr.second);
+        children.push_back(pr.first);
+        parents.push_back(pr.second);
+    }
+    for (int pv : parents) {
+        bool found = false;
+        for (int cv : children) {
+            if (cv == pv) { found = true; break; }
+        }
+        if (!found) break;
+    }
+    return nodeList.size();
+}
+
+// Бенчмарк построения дерева из списка пар «узел-родитель» (вырожденная цепочка, пары перемешаны)
+// Прежний поиск узлов квадратичен, поэтому измеряется только на небольших входах
+void benchmarkNodeParentPairs() {
+    std::cout << "Бенчмарк построения дерева из списка пар..." << std::endl;
+    
+    for (int n : {20000, 1000000, 10000000}) {
+        std::vector<std::pair<int, int>> pairs;
+        pairs.reserve(n - 1);
+        for (int i = 1; i < n; ++i) {
+            pairs.emplace_back(i, i - 1);
+        }
+        std::shuffle(pairs.begin(), pairs.end(), std::mt19937(21));
+        
+        std::cout << "n = " << n;
+        if (n <= 20000) {
+            size_t located = 0;
+            double scanTime = measureSeconds([&]() { located = locateNodesByScan(pairs); });
+            std::cout << ": прежний поиск узлов и корня " << scanTime << " с (" << located << " узлов)";
+        }
+        
+        size_t built = 0;
+        double buildTime = measureSeconds([&]() {
+            built = BinarySearchTree<int>::fromNodeParentPairs(pairs).getSize();
+        });
+        std::cout << ", fromNodeParentPairs " << buildTime << " с (" << built << " узлов)" << std::endl;
+    }
+}
+
+// Прежний порядок построения кучи из списка пар: std::map от значения родителя к вектору
+// потомков и обход в ширину; возвращает количество размещённых узлов
+size_t placeByChildrenMap(const std::vector<std::pair<int, int>>& pairs) {
+    std::map<int, std::vector<int>> childrenMap;
+    int rootValue = 0;
+    for (const auto& pair : pairs) {
+        if (pair.first == pair.second) {
+            rootValue = pair.first;
+        } else {
+            childrenMap[pair.second].push_back(pair.first);
+        }
+    }
+    std::vector<int> order = {rootValue};
+    for (size_t i = 0; i < order.size(); ++i) {
+        auto it = childrenMap.find(order[i]);
+        if (it == childrenMap.end()) continue;
+        for (int child : it->second) {
+            order.push_back(child);
+        }
+    }
+    return order.size();
+}
+
+// Прежний разбор строки списка пар: после каждой пары начало строки удаляется через erase
+std::vector<std::pair<int, int>> parsePairsByErase(const std::string& str) {
+    std::vector<std::pair<int, int>> pairs;
+    std::string content = str.substr(1, str.size() - 2);
+    size_t pos = 0;
+    while ((pos = content.find("(")) != std::string::npos) {
+        size_t endPos = content.find(")", pos);
+        if (endPos == std::string::npos) break;
+        std::string pairStr = content.substr(pos + 1, endPos - pos - 1);
+        size_t colonPos = pairStr.find(":");
+        if (colonPos != std::string::npos) {
+            pairs.push_back({valueFromString<int>(pairStr.substr(0, colonPos)),
+                             valueFromString<int>(pairStr.substr(colonPos + 1))});
+        }
+        content.erase(0, endPos + 1);
+    }
+    return pairs;
+}
+
+// Бенчмарк построения кучи из списка пар «узел-родитель»
+// Прежний разбор строки квадратичен по её длине, поэтому измеряется только на небольших входах
+void benchmarkHeapNodeParentPairs() {
+    std::cout << "Бенчмарк построения кучи из списка пар..." << std::endl;
+    
+    for (size_t n : {50000, 1000000}) {
+        std::vector<int> values(n);
+        std::iota(values.begin(), values.end(), 0);
+        std::shuffle(values.begin(), values.end(), std::mt19937(22));
+        BinaryHeap<int> heap;
+        heap.build(values);
+        std::string text = heap.toNodeParentPairs();
+        
+        std::cout << "n = " << n;
+        if (n <= 50000) {
+            size_t parsed = 0;
+            double eraseTime = measureSeconds([&]() { parsed = parsePairsByErase(text).size(); });
+            std::cout << ": разбор через erase " << eraseTime << " с (" << parsed << " пар)";
+        }
+        
+        std::vector<std::pair<int, int>> pairs;
+        double parseTime = measureSeconds([&]() { pairs = parseNodeParentPairList<int>(text); });
+        size_t placed = 0;
+        double mapTime = measureSeconds([&]() { placed = placeByChildrenMap(pairs); });
+        size_t built = 0;
+        double buildTime = measureSeconds([&]() {
+            built = BinaryHeap<int>::fromNodeParentPairs(pairs).getSize();
+        });
+        std::cout << ", разбор за один проход " << parseTime << " с; размещение через std::map " << mapTime
+                  << " с (" << placed << "), fromNodeParentPairs " << buildTime << " с (" << built << ")" << std::endl;
+    }
+}
+
+// Бенчмарк поиска вхождения поддеревьев: множество почти совпадающих фрагментов проверяется
+// на вхождение в большую кучу из повторяющихся значений. Без структурных хешей сравнение
+// фрагмента с каждым узлом доходило бы до отличающегося листа
+void benchmarkSubHeapSearch() {
+    const size_t n = (1 << 20) - 1;
+    const size_t fragmentSize = 1023;
+    const size_t fragmentCount = 200;
+    std::cout << "Бенчмарк поиска вхождения поддеревьев (n = " << n << ", фрагментов " << fragmentCount
+              << " по " << fragmentSize << " узлов)..." << std::endl;
+    
+    BinaryHeap<int> heap;
+    heap.build(std::vector<int>(n, 1));
+    
+    // Фрагменты из единиц, в которых один из листьев заменён нулём; последний фрагмент входит в кучу
+    std::vector<BinaryHeap<int>> fragments(fragmentCount);
+    for (size_t i = 0; i < fragmentCount; ++i) {
+        std::vector<int> fragmentValues(fragmentSize, 1);
+        if (i + 1 < fragmentCount) {
+            fragmentValues[fragmentSize - 1 - i] = 0;
+        }
+        fragments[i].build(fragmentValues);
+    }
+    
+    size_t found = 0;
+    double searchTime = measureSeconds([&]() {
+        for (const auto& fragment : fragments) {
+            found += heap.containsSubHeap(fragment) ? 1 : 0;
+        }
+    });
+    std::cout << "containsSubHeap: " << searchTime << " с (найдено " << found << " из " << fragmentCount
+              << ")" << std::endl;
+}
+
+// Снимки дерева: полная копия BinarySearchTree против снимка PersistentBinarySearchTree за O(1)
+// Каждый раунд сохраняет снимок и вносит в дерево небольшое число изменений
+void benchmarkPersistentSnapshots() {
+    const int n = 1000000;
+    const int rounds = 10;
+    const int updatesPerRound = 1000;
+    std::cout << "Бенчмарк снимков дерева (n = " << n << ", снимков " << rounds << " по " << updatesPerRound
+              << " вставок после каждого)..." << std::endl;
+    
+    std::vector<int> values(n);
+    std::iota(values.begin(), values.end(), 0);
+    
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, 2 * n);
+    std::vector<int> updates(rounds * updatesPerRound);
+    for (int& value : updates) {
+        value = dist(gen);
+    }
+    
+    BinarySearchTree<int, AVLBalanced> tree = BinarySearchTree<int, AVLBalanced>::fromSorted(values.begin(), values.end());
+    std::vector<BinarySearchTree<int, AVLBalanced>> copies;
+    double copyTime = measureSeconds([&]() {
+        for (int round = 0; round < rounds; ++round) {
+            copies.push_back(tree);
+            for (int i = 0; i < updatesPerRound; ++i) {
+                tree.insert(updates[round * updatesPerRound + i]);
+            }
+        }
+    });
+    std::cout << "BinarySearchTree (копия): " << copyTime << " с" << std::endl;
+    copies.clear();
+    
+    PersistentBinarySearchTree<int> persistent = PersistentBinarySearchTree<int>::fromSorted(values.begin(), values.end());
+    std::vector<PersistentBinarySearchTree<int>> snapshots;
+    double snapshotTime = measureSeconds([&]() {
+        for (int round = 0; round < rounds; ++round) {
+            snapshots.push_back(persistent.snapshot());
+            for (int i = 0; i < updatesPerRound; ++i) {
+                persistent.insert(updates[round * updatesPerRound + i]);
+            }
+        }
+    });
+    std::cout << "PersistentBinarySearchTree (снимок): " << snapshotTime << " с (размеры "
+              << snapshots.front().getSize() << " ... " << persistent.getSize() << ")" << std::endl;
+    
+    double searchTime = measureSeconds([&]() {
+        size_t found = 0;
+        for (int value : updates) {
+            found += snapshots.back().search(value) ? 1 : 0;
+        }
+        std::cout << "Поиск в последнем снимке: найдено " << found << " из " << updates.size() << std::endl;
+    });
+    std::cout << "Поиск: " << searchTime << " с" << std::endl;
+}
+
+// Дерево студентов: вставка копированием и перемещением, присваивание копией и перемещением
+// Имена длиннее буфера короткой строки, поэтому каждая копия строки выделяет память
+void benchmarkStudentTreeMoves() {
+    const int n = 300000;
+    std::cout << "Бенчмарк перемещения студентов (n = " << n << ")..." << std::endl;
+    
+    std::vector<Student> students;
+    students.reserve(n);
+    std::mt19937 gen(42);
+    std::vector<int> ids(n);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::shuffle(ids.begin(), ids.end(), gen);
+    for (int id : ids) {
+        students.emplace_back(PersonID{id / 1000, id % 1000}, "Константин " + std::to_string(id),
+                              "Константинович", "Константинопольский", 0, "Группа ИВТ-" + std::to_string(id % 100), 4.0);
+    }
+    std::vector<Student> movable = students;
+    
+    BinarySearchTree<Student, AVLBalanced> copied;
+    double copyInsertTime = measureSeconds([&]() {
+        for (const Student& student : students) {
+            copied.insert(student);
+        }
+    });
+    std::cout << "insert(const Student&): " << copyInsertTime << " с" << std::endl;
+    
+    BinarySearchTree<Student, AVLBalanced> moved;
+    double moveInsertTime = measureSeconds([&]() {
+        for (Student& student : movable) {
+            moved.insert(std::move(student));
+        }
+    });
+    std::cout << "insert(Student&&): " << moveInsertTime << " с" << std::endl;
+    
+    BinarySearchTree<Student, AVLBalanced> emplaced;
+    double emplaceTime = measureSeconds([&]() {
+        for (int id : ids) {
+            emplaced.emplace(PersonID{id / 1000, id % 1000}, "Константин " + std::to_string(id),
+                             "Константинович", "Константинопольский", 0, "Группа ИВТ-" + std::to_string(id % 100), 4.0);
+        }
+    });
+    std::cout << "emplace: " << emplaceTime << " с" << std::endl;
+    
+    // Присваивание результата, как в TreeWrapper: копия против перемещения
+    // (перемещение здесь в основном освобождает прежнее содержимое target)
+    BinarySearchTree<Student, AVLBalanced> target;
+    double copyAssignTime = measureSeconds([&]() {
+        target = copied;
+    });
+    std::cout << "Присваивание копией: " << copyAssignTime << " с" << std::endl;
+    
+    double moveAssignTime = measureSeconds([&]() {
+        target = std::move(moved);
+    });
+    std::cout << "Присваивание перемещением: " << moveAssignTime << " с (размер " << target.getSize() << ")"
+              << std::endl;
+}
+
+int main() {
+    setlocale(LC_ALL, "Russian");
+    setlocale(LC_ALL, "ru_RU.UTF-8");
+    
+    std::cout << "Запуск бенчмарков" << std::endl;
+    
+    benchmarkHeapInsertExtract<BinaryHeap<int>>("BinaryHeap<int>");
+    benchmarkHeapInsertExtract<ArrayHeap<int>>("ArrayHeap<int>");
+    benchmarkHeapBuild<BinaryHeap<int>>("BinaryHeap<int>");
+    benchmarkHeapBuild<ArrayHeap<int>>("ArrayHeap<int>");
+    benchmarkHeapArities();
+    benchmarkNodeAllocators();
+    benchmarkTreeIteration();
+    benchmarkTreeReduce();
+    benchmarkParallelMapWhere();
+    benchmarkParallelReduce();
+    benchmarkNumberConversions();
+    benchmarkStringParsing();
+    benchmarkStreamSerialization();
+    benchmarkBinarySnapshot();
+    benchmarkMappedTree();
+    benchmarkNodeParentPairs();
+    benchmarkHeapNodeParentPairs();
+    benchmarkSubHeapSearch();
+    benchmarkPersistentSnapshots();
+    benchmarkStudentTreeMoves();
+    
+    std::cout << "Бенчмарки завершены!" << std::endl;
+    
+    return 0;
+}
@@ -9,11 +9,19 @@
 #include <queue>
 #include <vector>
 #include <sstream>
-#include <map>
+#include <memory>
+#include <type_traits>
+#include <iterator>
+#include <utility>
 #include "data_types.h" // Включаем определения пользовательских типов
+#include "pool_allocator.h"
+#include "text_io.h"
+#include "binary_snapshot.h"
+#include "value_index.h"
 
 // Шаблонный класс бинарной кучи (max heap по умолчанию)
-template <typename T, typename Comparator = std::less<T>>
+// Allocator задаёт распределитель памяти для узлов (например, PoolAllocator<T>)
+template <typename T, typename Comparator = std::less<T>, typename Allocator = std::allocator<T>>
 class BinaryHeap {
 private:
     // Структура узла кучи
@@ -22,38 +30,62 @@ private:
         Node* left;       // Указатель на левого потомка
         Node* right;      // Указатель на правого потомка
         Node* parent;     // Указатель на родительский узел
+        size_t hash;      // Структурный хеш поддерева (subtreeHash), для поиска вхождения поддерева
         
-        // Конструктор узла
-        Node(const T& value, Node* parent = nullptr) 
-            : data(value), left(nullptr), right(nullptr), parent(parent) {}
+        // Конструктор узла; значение копируется или перемещается в зависимости от аргумента
+        template <typename U>
+        explicit Node(U&& value, Node* parent = nullptr) 
+            : data(std::forward<U>(value)), left(nullptr), right(nullptr), parent(parent),
+              hash(subtreeHash(valueHash(data), 0, 0)) {}
     };
     
+    // Распределитель узлов и его свойства
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+    
     Node* root;           // Корень кучи
     size_t size;          // Размер кучи (количество узлов)
     Comparator comp;      // Компаратор для определения порядка элементов
+    NodeAllocator nodeAllocator; // Распределитель памяти для узлов
     
     // Вспомогательные методы
     
+    // Создание и уничтожение узла через распределитель
+    template <typename U>
+    Node* createNode(U&& value, Node* parent = nullptr);
+    void destroyNode(Node* node);
+    
     // Восстановление свойства кучи при добавлении элемента (просеивание вверх)
     void heapifyUp(Node* node);
     
     // Восстановление свойства кучи при удалении элемента (просеивание вниз)
-    void heapifyDown(Node* node);
+    // Возвращает узел, в котором остановилось просеиваемое значение
+    Node* heapifyDown(Node* node);
+    
+    // Структурные хеши поддеревьев
+    // Просеивание меняет значения только на одном пути, поэтому после вставки и удаления
+    // хеши пересчитываются от самого нижнего изменённого узла до корня за O(log n)
+    static size_t hashOf(Node* node);                      // 0 для пустого поддерева
+    static void updateHash(Node* node);                    // по потомкам узла
+    static void updateHashesToRoot(Node* node);            // на пути от узла до корня
+    static void updateHashes(const std::vector<Node*>& levelOrder); // всех узлов, от потомков к родителям
     
     // Поиск узла по значению
     Node* findNode(Node* node, const T& value) const;
     
+    // Поиск узла по его номеру в уровневом порядке (нумерация с 1) за O(log n)
+    Node* findNodeByIndex(size_t index) const;
+    
     // Поиск последнего узла в куче
     Node* findLastNode() const;
     
     // Удаление всех узлов кучи
-    void destroyHeap(Node* node);
+    // При releaseMemory == false узлы только разрушаются, а память остаётся распределителю
+    void destroyHeap(Node* node, bool releaseMemory = true);
     
-    // Получение глубины кучи
-    int getDepth(Node* node = nullptr) const;
-    
-    // Клонирование кучи
-    Node* cloneHeap(Node* node, Node* parent = nullptr) const;
+    // Клонирование кучи; размер кучи увеличивается на число созданных узлов
+    // Глубина рекурсии равна высоте кучи, т.е. O(log n)
+    Node* cloneHeap(Node* node, Node* parent = nullptr);
     
     // Проверка, является ли данная куча поддеревом другой кучи
     bool isSubHeap(Node* heap, Node* subheap) const;
@@ -61,8 +93,12 @@ private:
     // Сравнение двух куч на идентичность
     bool areIdentical(Node* node1, Node* node2) const;
     
-    // Добавление узла в конец кучи
-    void addLast(const T& value);
+    // Добавление узла в конец кучи (возвращает добавленный узел)
+    template <typename U>
+    Node* addLast(U&& value);
+    
+    // Удаление заданного узла: на его место переносится значение последнего узла
+    void removeNode(Node* node);
     
     // Обмен значениями между двумя узлами
     void swapValues(Node* a, Node* b);
@@ -70,17 +106,31 @@ private:
     // Поиск узла по заданному пути
     Node* findNodeByPath(const std::string& path) const;
     
+    // Запись в строку или ChunkedWriter в форматах toString, toStringFormatted и toNodeParentPairs
+    template <typename Sink>
+    void writeLevelOrder(Sink& sink) const;
+    template <typename Sink>
+    void writeFormatted(Sink& sink, const std::string& format) const;
+    template <typename Sink>
+    void writeNodeParentPairs(Sink& sink) const;
+    
 public:
     // Конструкторы и деструкторы
     BinaryHeap();
+    explicit BinaryHeap(const Allocator& allocator);
     BinaryHeap(const BinaryHeap& other);
+    BinaryHeap(BinaryHeap&& other) noexcept;
     ~BinaryHeap();
     
     // Присваивание
     BinaryHeap& operator=(const BinaryHeap& other);
+    BinaryHeap& operator=(BinaryHeap&& other);
     
     // Базовые операции
     void insert(const T& value);       // Вставка элемента
+    void insert(T&& value);            // Вставка элемента перемещением
+    template <typename... Args>
+    void emplace(Args&&... args);      // Вставка элемента, построенного из аргументов конструктора T
     bool search(const T& value) const; // Поиск элемента
     bool remove(const T& value);       // Удаление элемента
     T extractMax();                    // Извлечение максимального элемента (для max-heap)
@@ -89,12 +139,19 @@ public:
     bool isEmpty() const;              // Проверка на пустоту
     size_t getSize() const;            // Получение размера кучи
     void clear();                      // Очистка кучи
+    Allocator getAllocator() const;    // Получение распределителя памяти
+    
+    // Построение кучи из набора значений за O(n) (просеивание снизу вверх, метод Флойда)
+    // Текущее содержимое кучи заменяется
+    void build(const std::vector<T>& values);
+    template <typename InputIt>
+    void build(InputIt first, InputIt last);
     
     // 2.2 Извлечение поддерева (по заданному элементу)
-    BinaryHeap<T, Comparator> extractSubHeap(const T& value);
+    BinaryHeap<T, Comparator, Allocator> extractSubHeap(const T& value);
     
     // 2.3 Поиск на вхождение поддерева
-    bool containsSubHeap(const BinaryHeap<T, Comparator>& subheap) const;
+    bool containsSubHeap(const BinaryHeap<T, Comparator, Allocator>& subheap) const;
     
     // 2.4 Сохранение в строку
     // 2.4.1 по фиксированному обходу
@@ -106,21 +163,39 @@ public:
     // 2.4.3 в формате списка пар «узел-родитель»
     std::string toNodeParentPairs() const;
     
+    // 2.4.4 Запись в поток (буферизованная, без построения строки целиком)
+    void writeTo(std::ostream& out) const;                            // в формате toString
+    void writeTo(std::ostream& out, const std::string& format) const; // в формате toStringFormatted
+    void writeNodeParentPairsTo(std::ostream& out) const;              // в формате toNodeParentPairs
+    
     // 2.5 Чтение из строки
     // 2.5.1 по фиксированному обходу
-    static BinaryHeap<T, Comparator> fromString(const std::string& str);
+    static BinaryHeap<T, Comparator, Allocator> fromString(const std::string& str);
     
     // 2.5.2 по обходу, задаваемому строкой форматирования
-    static BinaryHeap<T, Comparator> fromStringFormatted(const std::string& str, const std::string& format);
+    static BinaryHeap<T, Comparator, Allocator> fromStringFormatted(const std::string& str, const std::string& format);
     
     // 2.5.3 в формате списка пар «узел-родитель»
-    static BinaryHeap<T, Comparator> fromNodeParentPairs(const std::vector<std::pair<T, T>>& pairs);
+    static BinaryHeap<T, Comparator, Allocator> fromNodeParentPairs(const std::vector<std::pair<T, T>>& pairs);
+    
+    // 2.5.4 Чтение из потока до его конца (буферизованное, без чтения текста целиком)
+    static BinaryHeap<T, Comparator, Allocator> readFrom(std::istream& in);                            // формат toString
+    static BinaryHeap<T, Comparator, Allocator> readFrom(std::istream& in, const std::string& format); // формат toStringFormatted
+    static BinaryHeap<T, Comparator, Allocator> readNodeParentPairsFrom(std::istream& in);             // формат toNodeParentPairs
+    
+    // 2.5.7 Двоичный снимок (для тривиально копируемых T и Complex, см. binary_snapshot.h)
+    // Загрузка восстанавливает структуру кучи за O(n) без сравнений элементов
+    void saveSnapshot(std::ostream& out) const;
+    static BinaryHeap<T, Comparator, Allocator> loadSnapshot(std::istream& in);
     
     // Получение вершины кучи
     T top() const;
     
     // Обход кучи с вызовом функции обратного вызова для каждого элемента
+    // Шаблонная версия принимает любой вызываемый объект и встраивается компилятором
     void traverse(std::function<void(const T&)> callback) const;
+    template <typename F>
+    void traverse(F&& callback) const;
     
     // Вывод кучи в консоль (для отладки)
     void printHeap() const;
@@ -129,176 +204,304 @@ public:
 // Реализация методов класса BinaryHeap
 
 // Конструктор по умолчанию
-template <typename T, typename Comparator>
-BinaryHeap<T, Comparator>::BinaryHeap() : root(nullptr), size(0), comp() {}
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator>::BinaryHeap() : root(nullptr), size(0), comp(), nodeAllocator() {}
+
+// Конструктор с заданным распределителем памяти
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator>::BinaryHeap(const Allocator& allocator)
+    : root(nullptr), size(0), comp(), nodeAllocator(allocator) {}
 
 // Конструктор копирования
-template <typename T, typename Comparator>
-BinaryHeap<T, Comparator>::BinaryHeap(const BinaryHeap& other) : root(nullptr), size(0), comp(other.comp) {
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator>::BinaryHeap(const BinaryHeap& other)
+    : root(nullptr), size(0), comp(other.comp),
+      nodeAllocator(NodeTraits::select_on_container_copy_construction(other.nodeAllocator)) {
     if (other.root) {
         root = cloneHeap(other.root);
-        size = other.size;
     }
 }
 
+// Конструктор перемещения: узлы забираются за O(1)
+// Распределитель копируется, а не перемещается, чтобы исходная куча оставалась пригодной
+// для дальнейших вставок (копии PoolAllocator разделяют один пул)
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator>::BinaryHeap(BinaryHeap&& other) noexcept
+    : root(other.root), size(other.size), comp(other.comp), nodeAllocator(other.nodeAllocator) {
+    other.root = nullptr;
+    other.size = 0;
+}
+
 // Деструктор
-template <typename T, typename Comparator>
-BinaryHeap<T, Comparator>::~BinaryHeap() {
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator>::~BinaryHeap() {
     clear();
 }
 
 // Оператор присваивания
-template <typename T, typename Comparator>
-BinaryHeap<T, Comparator>& BinaryHeap<T, Comparator>::operator=(const BinaryHeap& other) {
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator>& BinaryHeap<T, Comparator, Allocator>::operator=(const BinaryHeap& other) {
     if (this != &other) {
         clear();
+        if constexpr (NodeTraits::propagate_on_container_copy_assignment::value) {
+            nodeAllocator = other.nodeAllocator;
+        }
         if (other.root) {
             root = cloneHeap(other.root);
-            size = other.size;
             comp = other.comp;
         }
     }
     return *this;
 }
 
+// Перемещающее присваивание
+// Узлы забираются, если распределитель переходит вместе с ними или распределители равны;
+// иначе узлы принадлежат чужому распределителю и куча копируется
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator>& BinaryHeap<T, Comparator, Allocator>::operator=(BinaryHeap&& other) {
+    if (this != &other) {
+        if constexpr (!NodeTraits::propagate_on_container_move_assignment::value) {
+            if (!(nodeAllocator == other.nodeAllocator)) {
+                return *this = static_cast<const BinaryHeap&>(other);
+            }
+        }
+        clear();
+        if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+            nodeAllocator = other.nodeAllocator;
+        }
+        root = other.root;
+        size = other.size;
+        comp = other.comp;
+        other.root = nullptr;
+        other.size = 0;
+    }
+    return *this;
+}
+
 // Проверка, пуста ли куча
-template <typename T, typename Comparator>
-bool BinaryHeap<T, Comparator>::isEmpty() const {
+template <typename T, typename Comparator, typename Allocator>
+bool BinaryHeap<T, Comparator, Allocator>::isEmpty() const {
     return root == nullptr;
 }
 
 // Получение размера кучи
-template <typename T, typename Comparator>
-size_t BinaryHeap<T, Comparator>::getSize() const {
+template <typename T, typename Comparator, typename Allocator>
+size_t BinaryHeap<T, Comparator, Allocator>::getSize() const {
     return size;
 }
 
 // Очистка кучи
-template <typename T, typename Comparator>
-void BinaryHeap<T, Comparator>::clear() {
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::clear() {
+    // Распределитель с пулом освобождает всю память разом, если пул принадлежит только этой куче;
+    // узлы обходятся лишь тогда, когда у данных есть нетривиальный деструктор
+    if constexpr (SupportsBulkRelease<NodeAllocator>::value) {
+        if (root && nodeAllocator.liveCount() == size) {
+            if constexpr (!std::is_trivially_destructible<Node>::value) {
+                destroyHeap(root, false);
+            }
+            nodeAllocator.release(size);
+            root = nullptr;
+            size = 0;
+            return;
+        }
+    }
+    
     destroyHeap(root);
     root = nullptr;
     size = 0;
 }
 
+// Получение распределителя памяти
+template <typename T, typename Comparator, typename Allocator>
+Allocator BinaryHeap<T, Comparator, Allocator>::getAllocator() const {
+    return Allocator(nodeAllocator);
+}
+
+// Создание узла: выделение памяти и конструирование через распределитель
+template <typename T, typename Comparator, typename Allocator>
+template <typename U>
+typename BinaryHeap<T, Comparator, Allocator>::Node* BinaryHeap<T, Comparator, Allocator>::createNode(U&& value, Node* parent) {
+    Node* node = NodeTraits::allocate(nodeAllocator, 1);
+    try {
+        NodeTraits::construct(nodeAllocator, node, std::forward<U>(value), parent);
+    } catch (...) {
+        NodeTraits::deallocate(nodeAllocator, node, 1);
+        throw;
+    }
+    return node;
+}
+
+// Уничтожение узла и возврат памяти распределителю
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::destroyNode(Node* node) {
+    NodeTraits::destroy(nodeAllocator, node);
+    NodeTraits::deallocate(nodeAllocator, node, 1);
+}
+
+// Построение кучи из вектора значений за O(n)
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::build(const std::vector<T>& values) {
+    build(values.begin(), values.end());
+}
+
+// Построение кучи из диапазона значений за O(n)
+template <typename T, typename Comparator, typename Allocator>
+template <typename InputIt>
+void BinaryHeap<T, Comparator, Allocator>::build(InputIt first, InputIt last) {
+    clear();
+    
+    // Раскладываем значения по узлам полного дерева в уровневом порядке:
+    // родитель узла с номером i (нумерация с 0) имеет номер (i - 1) / 2
+    // Каждый узел сразу подвешивается к родителю, поэтому при исключении
+    // все уже созданные узлы удаляются вместе с деревом top
+    std::vector<Node*> nodes;
+    Node* top = nullptr;
+    try {
+        for (; first != last; ++first) {
+            size_t index = nodes.size();
+            if (index == 0) {
+                top = createNode(*first);
+                nodes.push_back(top);
+                continue;
+            }
+            
+            Node* parent = nodes[(index - 1) / 2];
+            Node* node = createNode(*first, parent);
+            if (index % 2 == 1) {
+                parent->left = node;
+            } else {
+                parent->right = node;
+            }
+            nodes.push_back(node);
+        }
+    } catch (...) {
+        destroyHeap(top, true);
+        throw;
+    }
+    
+    if (nodes.empty()) return;
+    
+    root = top;
+    size = nodes.size();
+    
+    // Просеиваем вниз все внутренние узлы, начиная с последнего
+    for (size_t i = nodes.size() / 2; i-- > 0; ) {
+        heapifyDown(nodes[i]);
+    }
+    
+    // Хеши вычисляются один раз по готовой куче, а не после каждого просеивания
+    updateHashes(nodes);
+}
+
 // Рекурсивное удаление всех узлов кучи
-template <typename T, typename Comparator>
-void BinaryHeap<T, Comparator>::destroyHeap(Node* node) {
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::destroyHeap(Node* node, bool releaseMemory) {
     if (node) {
-        destroyHeap(node->left);
-        destroyHeap(node->right);
-        delete node;
+        destroyHeap(node->left, releaseMemory);
+        destroyHeap(node->right, releaseMemory);
+        if (releaseMemory) {
+            destroyNode(node);
+        } else {
+            NodeTraits::destroy(nodeAllocator, node);
+        }
     }
 }
 
 // Клонирование кучи
-template <typename T, typename Comparator>
-typename BinaryHeap<T, Comparator>::Node* BinaryHeap<T, Comparator>::cloneHeap(Node* node, Node* parent) const {
+template <typename T, typename Comparator, typename Allocator>
+typename BinaryHeap<T, Comparator, Allocator>::Node* BinaryHeap<T, Comparator, Allocator>::cloneHeap(Node* node, Node* parent) {
     if (!node) return nullptr;
     
-    Node* newNode = new Node(node->data, parent);
+    Node* newNode = createNode(node->data, parent);
+    newNode->hash = node->hash;
+    size++;
     newNode->left = cloneHeap(node->left, newNode);
     newNode->right = cloneHeap(node->right, newNode);
     
     return newNode;
 }
 
-// Поиск последнего узла в куче (используется для удаления)
-template <typename T, typename Comparator>
-typename BinaryHeap<T, Comparator>::Node* BinaryHeap<T, Comparator>::findLastNode() const {
-    if (!root) return nullptr;
-    
-    // Определяем глубину кучи
-    int depth = getDepth();
-    
-    // Используем битовую маску для поиска последнего узла
-    int mask = 1 << (depth - 1);
+// Поиск узла по его номеру в уровневом порядке (нумерация с 1)
+// Биты номера после старшего задают путь от корня: 0 - влево, 1 - вправо
+template <typename T, typename Comparator, typename Allocator>
+typename BinaryHeap<T, Comparator, Allocator>::Node* BinaryHeap<T, Comparator, Allocator>::findNodeByIndex(size_t index) const {
+    if (!root || index == 0) return nullptr;
+    
+    // Находим старший бит номера - он всегда соответствует корню
+    size_t mask = 1;
+    while (mask <= index / 2) {
+        mask <<= 1;
+    }
+    mask >>= 1;
     
     Node* current = root;
-    mask >>= 1;  // Пропускаем старший бит, так как он всегда указывает на корень
-    
-    // Проходим по биты числа size, чтобы найти путь к последнему узлу
     while (mask > 0 && current) {
-        if (size & mask) {
-            current = current->right;
-        } else {
-            current = current->left;
-        }
+        current = (index & mask) ? current->right : current->left;
         mask >>= 1;
     }
     
     return current;
 }
 
-// Получение глубины кучи или поддерева
-template <typename T, typename Comparator>
-int BinaryHeap<T, Comparator>::getDepth(Node* node) const {
-    if (!node && !root) return 0;
-    if (!node) node = root;
-    
-    int leftDepth = node->left ? getDepth(node->left) : 0;
-    int rightDepth = node->right ? getDepth(node->right) : 0;
-    
-    return 1 + std::max(leftDepth, rightDepth);
+// Поиск последнего узла в куче (используется для удаления)
+template <typename T, typename Comparator, typename Allocator>
+typename BinaryHeap<T, Comparator, Allocator>::Node* BinaryHeap<T, Comparator, Allocator>::findLastNode() const {
+    return findNodeByIndex(size);
 }
 
 // Вставка элемента в кучу
-template <typename T, typename Comparator>
-void BinaryHeap<T, Comparator>::insert(const T& value) {
-    addLast(value);
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::insert(const T& value) {
+    Node* lastNode = addLast(value);
     
-    // Восстанавливаем свойство кучи
-    if (size > 1) {
-        Node* lastNode = findLastNode();
-        heapifyUp(lastNode);
-    }
+    // Восстанавливаем свойство кучи; значения изменились только на пути от нового узла к корню
+    heapifyUp(lastNode);
+    updateHashesToRoot(lastNode);
+}
+
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::insert(T&& value) {
+    Node* lastNode = addLast(std::move(value));
+    heapifyUp(lastNode);
+    updateHashesToRoot(lastNode);
+}
+
+// Вставка элемента, построенного из аргументов конструктора T
+template <typename T, typename Comparator, typename Allocator>
+template <typename... Args>
+void BinaryHeap<T, Comparator, Allocator>::emplace(Args&&... args) {
+    insert(T(std::forward<Args>(args)...));
 }
 
 // Добавление узла в последнюю позицию кучи
-template <typename T, typename Comparator>
-void BinaryHeap<T, Comparator>::addLast(const T& value) {
+template <typename T, typename Comparator, typename Allocator>
+template <typename U>
+typename BinaryHeap<T, Comparator, Allocator>::Node* BinaryHeap<T, Comparator, Allocator>::addLast(U&& value) {
     if (!root) {
-        root = new Node(value);
+        root = createNode(std::forward<U>(value));
         size = 1;
-        return;
+        return root;
     }
     
-    // Увеличиваем размер и определяем путь к новому узлу
-    size++;
-    int path = size;
-    std::stack<bool> directions;
+    // Родитель нового узла имеет номер (size + 1) / 2, чётность номера задаёт сторону
+    size_t index = size + 1;
+    Node* parent = findNodeByIndex(index / 2);
+    Node* node = createNode(std::forward<U>(value), parent);
     
-    while (path > 1) {
-        directions.push(path % 2 == 0); // true для левого потомка, false для правого
-        path /= 2;
+    if (index % 2 == 0) {
+        parent->left = node;
+    } else {
+        parent->right = node;
     }
     
-    // Следуем по пути к позиции нового узла
-    Node* current = root;
-    Node* parent = nullptr;
-    
-    while (!directions.empty()) {
-        parent = current;
-        if (directions.top()) { // Идем влево
-            if (!current->left) {
-                current->left = new Node(value, current);
-                return;
-            }
-            current = current->left;
-        } else { // Идем вправо
-            if (!current->right) {
-                current->right = new Node(value, current);
-                return;
-            }
-            current = current->right;
-        }
-        directions.pop();
-    }
+    size++;
+    return node;
 }
 
 // Восстановление свойства кучи при добавлении элемента (просеивание вверх)
-template <typename T, typename Comparator>
-void BinaryHeap<T, Comparator>::heapifyUp(Node* node) {
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::heapifyUp(Node* node) {
     while (node->parent && comp(node->parent->data, node->data)) {
         swapValues(node, node->parent);
         node = node->parent;
@@ -306,8 +509,8 @@ void BinaryHeap<T, Comparator>::heapifyUp(Node* node) {
 }
 
 // Восстановление свойства кучи при удалении элемента (просеивание вниз)
-template <typename T, typename Comparator>
-void BinaryHeap<T, Comparator>::heapifyDown(Node* node) {
+template <typename T, typename Comparator, typename Allocator>
+typename BinaryHeap<T, Comparator, Allocator>::Node* BinaryHeap<T, Comparator, Allocator>::heapifyDown(Node* node) {
     while (true) {
         Node* largest = node;
         
@@ -322,7 +525,7 @@ void BinaryHeap<T, Comparator>::heapifyDown(Node* node) {
         }
         
         // Если текущий узел уже наибольший, завершаем
-        if (largest == node) break;
+        if (largest == node) return node;
         
         // Иначе меняем местами и продолжаем вниз
         swapValues(node, largest);
@@ -330,23 +533,52 @@ void BinaryHeap<T, Comparator>::heapifyDown(Node* node) {
     }
 }
 
+// Структурный хеш поддерева (0 для пустого)
+template <typename T, typename Comparator, typename Allocator>
+size_t BinaryHeap<T, Comparator, Allocator>::hashOf(Node* node) {
+    return node ? node->hash : 0;
+}
+
+// Пересчёт структурного хеша узла по его значению и хешам потомков
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::updateHash(Node* node) {
+    node->hash = subtreeHash(valueHash(node->data), hashOf(node->left), hashOf(node->right));
+}
+
+// Пересчёт структурных хешей на пути от узла до корня
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::updateHashesToRoot(Node* node) {
+    for (; node; node = node->parent) {
+        updateHash(node);
+    }
+}
+
+// Пересчёт структурных хешей всех узлов за O(n): в обратном уровневом порядке
+// потомки обрабатываются раньше родителей
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::updateHashes(const std::vector<Node*>& levelOrder) {
+    for (size_t i = levelOrder.size(); i-- > 0; ) {
+        updateHash(levelOrder[i]);
+    }
+}
+
 // Обмен значениями между двумя узлами
-template <typename T, typename Comparator>
-void BinaryHeap<T, Comparator>::swapValues(Node* a, Node* b) {
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::swapValues(Node* a, Node* b) {
     if (a && b) {
         std::swap(a->data, b->data);
     }
 }
 
 // Поиск элемента в куче
-template <typename T, typename Comparator>
-bool BinaryHeap<T, Comparator>::search(const T& value) const {
+template <typename T, typename Comparator, typename Allocator>
+bool BinaryHeap<T, Comparator, Allocator>::search(const T& value) const {
     return findNode(root, value) != nullptr;
 }
 
 // Рекурсивный поиск узла по значению
-template <typename T, typename Comparator>
-typename BinaryHeap<T, Comparator>::Node* BinaryHeap<T, Comparator>::findNode(Node* node, const T& value) const {
+template <typename T, typename Comparator, typename Allocator>
+typename BinaryHeap<T, Comparator, Allocator>::Node* BinaryHeap<T, Comparator, Allocator>::findNode(Node* node, const T& value) const {
     if (!node) return nullptr;
     
     if (node->data == value) return node;
@@ -359,17 +591,27 @@ typename BinaryHeap<T, Comparator>::Node* BinaryHeap<T, Comparator>::findNode(No
 }
 
 // Удаление элемента из кучи
-template <typename T, typename Comparator>
-bool BinaryHeap<T, Comparator>::remove(const T& value) {
+template <typename T, typename Comparator, typename Allocator>
+bool BinaryHeap<T, Comparator, Allocator>::remove(const T& value) {
     // Находим узел для удаления
     Node* nodeToRemove = findNode(root, value);
     if (!nodeToRemove) return false;
     
+    removeNode(nodeToRemove);
+    return true;
+}
+
+// Удаление заданного узла
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::removeNode(Node* nodeToRemove) {
     // Находим последний узел
     Node* lastNode = findLastNode();
     
-    // Заменяем значение удаляемого узла значением последнего узла
-    nodeToRemove->data = lastNode->data;
+    // Заменяем значение удаляемого узла значением последнего узла (последний узел будет удалён)
+    if (nodeToRemove != lastNode) {
+        nodeToRemove->data = std::move(lastNode->data);
+    }
+    Node* lastParent = lastNode->parent;
     
     // Удаляем последний узел
     if (lastNode->parent) {
@@ -383,33 +625,37 @@ bool BinaryHeap<T, Comparator>::remove(const T& value) {
         root = nullptr;
     }
     
-    delete lastNode;
+    destroyNode(lastNode);
     size--;
     
-    // Восстанавливаем свойство кучи
+    // Хеши изменились на пути от родителя удалённого узла к корню
+    updateHashesToRoot(lastParent);
+    
+    // Восстанавливаем свойство кучи; значения изменились только на пути от узла,
+    // где остановилось просеивание вниз, к корню (он включает и путь просеивания вверх)
     if (nodeToRemove != lastNode && size > 0) {
-        heapifyDown(nodeToRemove);
+        Node* settled = heapifyDown(nodeToRemove);
         heapifyUp(nodeToRemove);
+        updateHashesToRoot(settled);
     }
-    
-    return true;
 }
 
 // Извлечение максимального элемента (для max-heap)
-template <typename T, typename Comparator>
-T BinaryHeap<T, Comparator>::extractMax() {
+template <typename T, typename Comparator, typename Allocator>
+T BinaryHeap<T, Comparator, Allocator>::extractMax() {
     if (isEmpty()) {
         throw std::runtime_error("Куча пуста");
     }
     
-    T result = root->data;
-    remove(root->data);
+    // Значение вершины перемещается в результат, после чего корень удаляется без поиска
+    T result = std::move(root->data);
+    removeNode(root);
     return result;
 }
 
 // Получение вершины кучи
-template <typename T, typename Comparator>
-T BinaryHeap<T, Comparator>::top() const {
+template <typename T, typename Comparator, typename Allocator>
+T BinaryHeap<T, Comparator, Allocator>::top() const {
     if (isEmpty()) {
         throw std::runtime_error("Куча пуста");
     }
@@ -418,35 +664,23 @@ T BinaryHeap<T, Comparator>::top() const {
 }
 
 // 2.2 Извлечение поддерева (по заданному элементу)
-template <typename T, typename Comparator>
-BinaryHeap<T, Comparator> BinaryHeap<T, Comparator>::extractSubHeap(const T& value) {
-    BinaryHeap<T, Comparator> result;
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator> BinaryHeap<T, Comparator, Allocator>::extractSubHeap(const T& value) {
+    BinaryHeap<T, Comparator, Allocator> result;
     
     // Находим узел с заданным значением
     Node* node = findNode(root, value);
     if (!node) return result;
     
-    // Создаем новую кучу из поддерева
-    result.root = cloneHeap(node);
-    
-    // Пересчитываем размер поддерева
-    std::function<void(Node*)> countNodes = [&](Node* n) {
-        if (n) {
-            result.size++;
-            countNodes(n->left);
-            countNodes(n->right);
-        }
-    };
-    
-    result.size = 0;
-    countNodes(result.root);
+    // Создаем новую кучу из поддерева; узлы подсчитываются при копировании
+    result.root = result.cloneHeap(node);
     
     return result;
 }
 
 // 2.3 Поиск на вхождение поддерева
-template <typename T, typename Comparator>
-bool BinaryHeap<T, Comparator>::containsSubHeap(const BinaryHeap<T, Comparator>& subheap) const {
+template <typename T, typename Comparator, typename Allocator>
+bool BinaryHeap<T, Comparator, Allocator>::containsSubHeap(const BinaryHeap<T, Comparator, Allocator>& subheap) const {
     if (subheap.isEmpty()) return true;
     if (isEmpty()) return false;
     
@@ -454,8 +688,8 @@ bool BinaryHeap<T, Comparator>::containsSubHeap(const BinaryHeap<T, Comparator>&
 }
 
 // Проверка, является ли данная куча поддеревом другой кучи
-template <typename T, typename Comparator>
-bool BinaryHeap<T, Comparator>::isSubHeap(Node* heap, Node* subheap) const {
+template <typename T, typename Comparator, typename Allocator>
+bool BinaryHeap<T, Comparator, Allocator>::isSubHeap(Node* heap, Node* subheap) const {
     if (!subheap) return true;
     if (!heap) return false;
     
@@ -465,26 +699,27 @@ bool BinaryHeap<T, Comparator>::isSubHeap(Node* heap, Node* subheap) const {
 }
 
 // Сравнение двух куч на идентичность
-template <typename T, typename Comparator>
-bool BinaryHeap<T, Comparator>::areIdentical(Node* node1, Node* node2) const {
+template <typename T, typename Comparator, typename Allocator>
+bool BinaryHeap<T, Comparator, Allocator>::areIdentical(Node* node1, Node* node2) const {
     if (!node1 && !node2) return true;
     if (!node1 || !node2) return false;
     
-    return (node1->data == node2->data) &&
+    // Поддеревья с разными структурными хешами заведомо различны
+    return node1->hash == node2->hash &&
+           (node1->data == node2->data) &&
            areIdentical(node1->left, node2->left) &&
            areIdentical(node1->right, node2->right);
 }
 
-// 2.4.1 Сохранение в строку по фиксированному обходу (уровневый обход)
-template <typename T, typename Comparator>
-std::string BinaryHeap<T, Comparator>::toString() const {
-    if (isEmpty()) return "[]";
-    
-    std::stringstream ss;
-    ss << "[";
+// Запись значений в уровневом порядке в виде "[a,b,c]"
+// sink - std::string или ChunkedWriter
+template <typename T, typename Comparator, typename Allocator>
+template <typename Sink>
+void BinaryHeap<T, Comparator, Allocator>::writeLevelOrder(Sink& sink) const {
+    sink += '[';
     
     std::queue<Node*> q;
-    q.push(root);
+    if (root) q.push(root);
     
     bool isFirst = true;
     
@@ -493,307 +728,385 @@ std::string BinaryHeap<T, Comparator>::toString() const {
         q.pop();
         
         if (!isFirst) {
-            ss << ",";
+            sink += ',';
         }
         isFirst = false;
         
-        ss << valueToString(current->data);
+        appendValue(sink, current->data);
         
         if (current->left) q.push(current->left);
         if (current->right) q.push(current->right);
     }
     
-    ss << "]";
-    return ss.str();
+    sink += ']';
 }
 
-// 2.4.2 Сохранение в строку по обходу, задаваемому строкой форматирования
-template <typename T, typename Comparator>
-std::string BinaryHeap<T, Comparator>::toStringFormatted(const std::string& format) const {
-    if (isEmpty()) return "[]";
+// Запись значений в порядке обхода, заданном строкой форматирования
+// Значения записываются по мере обхода, без промежуточного вектора
+template <typename T, typename Comparator, typename Allocator>
+template <typename Sink>
+void BinaryHeap<T, Comparator, Allocator>::writeFormatted(Sink& sink, const std::string& format) const {
+    sink += '[';
     
-    std::vector<T> values;
+    bool isFirst = true;
+    auto emit = [&sink, &isFirst](const T& value) {
+        if (!isFirst) {
+            sink += ',';
+        }
+        isFirst = false;
+        appendValue(sink, value);
+    };
     
-    // Разные обходы дерева в зависимости от формата
-    if (format == "КЛП") { // Корень, левое поддерево, правое поддерево (префиксный обход)
-        std::function<void(Node*)> preOrder = [&](Node* node) {
-            if (!node) return;
-            values.push_back(node->data);
-            preOrder(node->left);
-            preOrder(node->right);
-        };
-        preOrder(root);
-    }
-    else if (format == "ЛКП") { // Левое поддерево, корень, правое поддерево (инфиксный обход)
-        std::function<void(Node*)> inOrder = [&](Node* node) {
-            if (!node) return;
-            inOrder(node->left);
-            values.push_back(node->data);
-            inOrder(node->right);
-        };
-        inOrder(root);
-    }
-    else if (format == "ЛПК") { // Левое поддерево, правое поддерево, корень (постфиксный обход)
-        std::function<void(Node*)> postOrder = [&](Node* node) {
-            if (!node) return;
-            postOrder(node->left);
-            postOrder(node->right);
-            values.push_back(node->data);
-        };
-        postOrder(root);
-    }
-    else if (format == "КПЛ") { // Корень, правое поддерево, левое поддерево
-        std::function<void(Node*)> kplOrder = [&](Node* node) {
-            if (!node) return;
-            values.push_back(node->data);
-            kplOrder(node->right);
-            kplOrder(node->left);
-        };
-        kplOrder(root);
-    }
-    else if (format == "ПКЛ") { // Правое поддерево, корень, левое поддерево
-        std::function<void(Node*)> pklOrder = [&](Node* node) {
-            if (!node) return;
-            pklOrder(node->right);
-            values.push_back(node->data);
-            pklOrder(node->left);
-        };
-        pklOrder(root);
-    }
-    else if (format == "ПЛК") { // Правое поддерево, левое поддерево, корень
-        std::function<void(Node*)> plkOrder = [&](Node* node) {
-            if (!node) return;
-            plkOrder(node->right);
-            plkOrder(node->left);
-            values.push_back(node->data);
-        };
-        plkOrder(root);
-    }
-    else { // По умолчанию - обход в ширину (уровневый обход)
-        std::queue<Node*> nodeQueue;
-        nodeQueue.push(root);
-        
-        while (!nodeQueue.empty()) {
-            Node* current = nodeQueue.front();
-            nodeQueue.pop();
-            
-            values.push_back(current->data);
+    if (root) {
+        // Разные обходы дерева в зависимости от формата
+        if (format == "КЛП") { // Корень, левое поддерево, правое поддерево (префиксный обход)
+            std::function<void(Node*)> preOrder = [&](Node* node) {
+                if (!node) return;
+                emit(node->data);
+                preOrder(node->left);
+                preOrder(node->right);
+            };
+            preOrder(root);
+        }
+        else if (format == "ЛКП") { // Левое поддерево, корень, правое поддерево (инфиксный обход)
+            std::function<void(Node*)> inOrder = [&](Node* node) {
+                if (!node) return;
+                inOrder(node->left);
+                emit(node->data);
+                inOrder(node->right);
+            };
+            inOrder(root);
+        }
+        else if (format == "ЛПК") { // Левое поддерево, правое поддерево, корень (постфиксный обход)
+            std::function<void(Node*)> postOrder = [&](Node* node) {
+                if (!node) return;
+                postOrder(node->left);
+                postOrder(node->right);
+                emit(node->data);
+            };
+            postOrder(root);
+        }
+        else if (format == "КПЛ") { // Корень, правое поддерево, левое поддерево
+            std::function<void(Node*)> kplOrder = [&](Node* node) {
+                if (!node) return;
+                emit(node->data);
+                kplOrder(node->right);
+                kplOrder(node->left);
+            };
+            kplOrder(root);
+        }
+        else if (format == "ПКЛ") { // Правое поддерево, корень, левое поддерево
+            std::function<void(Node*)> pklOrder = [&](Node* node) {
+                if (!node) return;
+                pklOrder(node->right);
+                emit(node->data);
+                pklOrder(node->left);
+            };
+            pklOrder(root);
+        }
+        else if (format == "ПЛК") { // Правое поддерево, левое поддерево, корень
+            std::function<void(Node*)> plkOrder = [&](Node* node) {
+                if (!node) return;
+                plkOrder(node->right);
+                plkOrder(node->left);
+                emit(node->data);
+            };
+            plkOrder(root);
+        }
+        else { // По умолчанию - обход в ширину (уровневый обход)
+            std::queue<Node*> nodeQueue;
+            nodeQueue.push(root);
             
-            if (current->left) nodeQueue.push(current->left);
-            if (current->right) nodeQueue.push(current->right);
+            while (!nodeQueue.empty()) {
+                Node* current = nodeQueue.front();
+                nodeQueue.pop();
+                
+                emit(current->data);
+                
+                if (current->left) nodeQueue.push(current->left);
+                if (current->right) nodeQueue.push(current->right);
+            }
         }
+        
     }
     
-    // Форматируем результат в строку
-    std::stringstream ss;
-    ss << "[";
-    for (size_t i = 0; i < values.size(); ++i) {
-        if (i > 0) ss << ",";
-        ss << valueToString(values[i]);
-    }
-    ss << "]";
-    
-    return ss.str();
+    sink += ']';
 }
 
-// 2.4.3 Сохранение в формате списка пар «узел-родитель»
-template <typename T, typename Comparator>
-std::string BinaryHeap<T, Comparator>::toNodeParentPairs() const {
-    if (isEmpty()) return "[]";
+// Запись списка пар «узел-родитель» в префиксном порядке
+template <typename T, typename Comparator, typename Allocator>
+template <typename Sink>
+void BinaryHeap<T, Comparator, Allocator>::writeNodeParentPairs(Sink& sink) const {
+    sink += '[';
     
-    std::stringstream ss;
-    ss << "[";
-    
-    std::vector<std::pair<T, T>> pairs;
+    bool isFirst = true;
     
-    // Функция для сбора пар узел-родитель
-    std::function<void(Node*)> collectPairs = [&](Node* node) {
+    // Функция для записи пар узел-родитель
+    std::function<void(Node*)> writePairs = [&](Node* node) {
         if (!node) return;
         
-        if (node->parent) {
-            pairs.push_back({node->data, node->parent->data});
-        } else {
-            // Для корня используем специальное значение
-            // В данном случае используем само значение корня, т.к. корень не имеет родителя
-            pairs.push_back({node->data, node->data});
+        if (!isFirst) {
+            sink += ',';
         }
+        isFirst = false;
+        
+        sink += '(';
+        appendValue(sink, node->data);
+        sink += ':';
+        // Для корня в качестве родителя используем само значение корня, т.к. корень не имеет родителя
+        appendValue(sink, node->parent ? node->parent->data : node->data);
+        sink += ')';
         
-        collectPairs(node->left);
-        collectPairs(node->right);
+        writePairs(node->left);
+        writePairs(node->right);
     };
     
-    collectPairs(root);
+    writePairs(root);
     
-    for (size_t i = 0; i < pairs.size(); ++i) {
-        if (i > 0) ss << ",";
-        ss << "(" << valueToString(pairs[i].first) << ":" << valueToString(pairs[i].second) << ")";
-    }
-    
-    ss << "]";
-    return ss.str();
+    sink += ']';
+}
+
+// 2.4.1 Сохранение в строку по фиксированному обходу (уровневый обход)
+template <typename T, typename Comparator, typename Allocator>
+std::string BinaryHeap<T, Comparator, Allocator>::toString() const {
+    std::string result;
+    writeLevelOrder(result);
+    return result;
+}
+
+// 2.4.2 Сохранение в строку по обходу, задаваемому строкой форматирования
+template <typename T, typename Comparator, typename Allocator>
+std::string BinaryHeap<T, Comparator, Allocator>::toStringFormatted(const std::string& format) const {
+    std::string result;
+    writeFormatted(result, format);
+    return result;
+}
+
+// 2.4.3 Сохранение в формате списка пар «узел-родитель»
+template <typename T, typename Comparator, typename Allocator>
+std::string BinaryHeap<T, Comparator, Allocator>::toNodeParentPairs() const {
+    std::string result;
+    writeNodeParentPairs(result);
+    return result;
+}
+
+// 2.4.4 Запись в поток в формате toString
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::writeTo(std::ostream& out) const {
+    ChunkedWriter writer(out);
+    writeLevelOrder(writer);
+    writer.flush();
+}
+
+// 2.4.5 Запись в поток в формате toStringFormatted
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::writeTo(std::ostream& out, const std::string& format) const {
+    ChunkedWriter writer(out);
+    writeFormatted(writer, format);
+    writer.flush();
+}
+
+// 2.4.6 Запись в поток в формате toNodeParentPairs
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::writeNodeParentPairsTo(std::ostream& out) const {
+    ChunkedWriter writer(out);
+    writeNodeParentPairs(writer);
+    writer.flush();
 }
 
 // 2.5.1 Чтение из строки по фиксированному обходу
-template <typename T, typename Comparator>
-BinaryHeap<T, Comparator> BinaryHeap<T, Comparator>::fromString(const std::string& str) {
-    BinaryHeap<T, Comparator> result;
-    
-    // Парсим строку вида "[value1,value2,value3,...]"
-    std::string content = str;
-    if (content.size() >= 2) {
-        content = content.substr(1, content.size() - 2); // Удаляем [ и ]
-    } else {
-        return result; // Пустая куча
-    }
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator> BinaryHeap<T, Comparator, Allocator>::fromString(const std::string& str) {
+    BinaryHeap<T, Comparator, Allocator> result;
     
-    // Разбиваем на значения
+    // Парсим строку вида "[value1,value2,value3,...]" за один проход
     std::vector<T> values;
-    size_t pos = 0;
-    std::string token;
-    while ((pos = content.find(",")) != std::string::npos) {
-        token = content.substr(0, pos);
-        values.push_back(valueFromString<T>(token));
-        content.erase(0, pos + 1);
-    }
-    if (!content.empty()) {
-        values.push_back(valueFromString<T>(content));
-    }
+    parseValueList(str, values);
     
     // Строим кучу
-    for (const auto& value : values) {
-        result.insert(value);
-    }
+    result.build(values);
     
     return result;
 }
 
 // 2.5.2 Чтение из строки по обходу, задаваемому строкой форматирования
-template <typename T, typename Comparator>
-BinaryHeap<T, Comparator> BinaryHeap<T, Comparator>::fromStringFormatted(const std::string& str, const std::string& format) {
-    BinaryHeap<T, Comparator> result;
-    
-    // Парсим строку вида "[value1,value2,value3,...]"
-    std::string content = str;
-    if (content.size() >= 2) {
-        content = content.substr(1, content.size() - 2); // Удаляем [ и ]
-    } else {
-        return result; // Пустая куча
-    }
-    
-    // Если строка пустая после удаления скобок, возвращаем пустую кучу
-    if (content.empty()) {
-        return result;
-    }
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator> BinaryHeap<T, Comparator, Allocator>::fromStringFormatted(const std::string& str, const std::string& format) {
+    BinaryHeap<T, Comparator, Allocator> result;
     
-    // Разбиваем на значения
+    // Парсим строку вида "[value1,value2,value3,...]" за один проход
     std::vector<T> values;
-    size_t pos = 0;
-    std::string token;
-    
-    // Обрабатываем строку с запятыми
-    while ((pos = content.find(",")) != std::string::npos) {
-        token = content.substr(0, pos);
-        values.push_back(valueFromString<T>(token));
-        content.erase(0, pos + 1);
-    }
-    
-    // Добавляем последнее значение, если оно есть
-    if (!content.empty()) {
-        values.push_back(valueFromString<T>(content));
-    }
+    parseValueList(str, values);
     
     // Построение дерева по правилам бинарной кучи
     // Мы не можем точно восстановить структуру дерева только по списку значений
     // без дополнительной информации, но мы можем создать корректную кучу
     
-    // Для всех форматов обхода мы будем создавать кучу, вставляя элементы 
-    // в соответствии с правилами бинарной кучи, т.к. эта структура однозначно 
-    // определена свойствами кучи, независимо от порядка обхода
-    for (const auto& value : values) {
-        result.insert(value);
-    }
+    // Для всех форматов обхода мы будем создавать кучу по правилам бинарной кучи,
+    // т.к. эта структура однозначно определена свойствами кучи, независимо от порядка обхода
+    result.build(values);
     
     return result;
 }
 
 // 2.5.3 Чтение из строки в формате списка пар «узел-родитель»
-template <typename T, typename Comparator>
-BinaryHeap<T, Comparator> BinaryHeap<T, Comparator>::fromNodeParentPairs(const std::vector<std::pair<T, T>>& pairs) {
-    BinaryHeap<T, Comparator> result;
+// Корень задаётся парой, в которой узел совпадает с родителем. Потомки берутся из плоского
+// индекса рёбер по значению родителя (ValueIndex: потомки одного родителя - соседние места
+// в порядке следования пар), а значения собираются одним проходом в ширину - за ожидаемое O(n).
+// Вставка и удаление рассчитывают на полное дерево со свойством кучи, а список пар может задавать
+// любое бинарное дерево, поэтому куча строится из значений в уровневом порядке через build
+// (как в ArrayHeap). Корректную кучу build не меняет, и её форма сохраняется
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator> BinaryHeap<T, Comparator, Allocator>::fromNodeParentPairs(const std::vector<std::pair<T, T>>& pairs) {
+    BinaryHeap<T, Comparator, Allocator> result;
     
     if (pairs.empty()) return result;
     
     // Находим корень (узел, который является своим собственным родителем)
-    T rootValue;
-    bool rootFound = false;
-    
-    for (const auto& pair : pairs) {
-        if (pair.first == pair.second) {
-            rootValue = pair.first;
-            rootFound = true;
-            break;
+    // Остальные пары - рёбра; повторная пара вида (x:x) в рёбра не входит, и проверка
+    // количества узлов в конце сообщит об ошибке
+    size_t rootIndex = pairs.size();
+    std::vector<size_t> edges;
+    edges.reserve(pairs.size());
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (pairs[i].first == pairs[i].second) {
+            if (rootIndex == pairs.size()) rootIndex = i;
+        } else {
+            edges.push_back(i);
         }
     }
     
-    if (!rootFound) {
+    if (rootIndex == pairs.size()) {
         throw std::runtime_error("Корень не найден в списке пар");
     }
     
-    // Создаем структуру с узлами и их родителями
-    std::map<T, std::vector<T>> childrenMap;
-    
-    // Заполняем карту: ключ - родитель, значение - список детей
-    for (const auto& pair : pairs) {
-        if (pair.first != pair.second) { // Игнорируем корень
-            childrenMap[pair.second].push_back(pair.first);
-        }
-    }
-    
-    // Строим дерево, начиная с корня
-    result.root = new typename BinaryHeap<T, Comparator>::Node(rootValue);
-    result.size = 1;
+    ValueIndex byParent(edges.size(), [&](size_t edge) -> const T& { return pairs[edges[edge]].second; });
     
-    // Очередь для обхода в ширину при построении дерева
-    std::queue<std::pair<typename BinaryHeap<T, Comparator>::Node*, T>> nodeQueue;
-    nodeQueue.push({result.root, rootValue});
+    // Обходим дерево в ширину: узлы, найденные раньше, раньше получают потомков
+    std::vector<size_t> order; // Номера пар в уровневом порядке
+    order.reserve(pairs.size());
+    order.push_back(rootIndex);
     
-    while (!nodeQueue.empty()) {
-        auto [parentNode, parentValue] = nodeQueue.front();
-        nodeQueue.pop();
-        
-        // Если у этого узла есть дети
-        if (childrenMap.find(parentValue) != childrenMap.end()) {
-            for (const T& childValue : childrenMap[parentValue]) {
-                // Проверяем, нет ли уже двух детей
-                if (!parentNode->left) {
-                    parentNode->left = new typename BinaryHeap<T, Comparator>::Node(childValue, parentNode);
-                    result.size++;
-                    nodeQueue.push({parentNode->left, childValue});
-                } else if (!parentNode->right) {
-                    parentNode->right = new typename BinaryHeap<T, Comparator>::Node(childValue, parentNode);
-                    result.size++;
-                    nodeQueue.push({parentNode->right, childValue});
-                } else {
-                    // Если узел уже имеет двух детей, это не бинарное дерево
-                    throw std::runtime_error("Ошибка: узел имеет более двух детей");
-                }
-            }
+    for (size_t i = 0; i < order.size(); ++i) {
+        auto range = byParent.equalRange(pairs[order[i]].first);
+        if (range.second - range.first > 2) {
+            // Если узел имеет больше двух детей, это не бинарное дерево
+            throw std::runtime_error("Ошибка: узел имеет более двух детей");
+        }
+        // Узлов больше, чем пар, бывает только при цикле из повторяющихся значений
+        if (order.size() + (range.second - range.first) > pairs.size()) {
+            throw std::runtime_error("Ошибка: список пар содержит цикл");
+        }
+        for (size_t position = range.first; position < range.second; ++position) {
+            order.push_back(edges[byParent.indexAt(position)]);
         }
     }
     
     // Проверяем, все ли узлы были добавлены
-    if (result.size != pairs.size()) {
+    if (order.size() != pairs.size()) {
         // Количество узлов не совпадает, возможно некоторые не были добавлены
         // или формат пар некорректен
         throw std::runtime_error("Ошибка: не все узлы были добавлены в дерево");
     }
     
+    std::vector<T> values;
+    values.reserve(order.size());
+    for (size_t index : order) {
+        values.push_back(pairs[index].first);
+    }
+    result.build(std::make_move_iterator(values.begin()), std::make_move_iterator(values.end()));
+    return result;
+}
+
+// 2.5.4 Чтение из потока в формате toString
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator> BinaryHeap<T, Comparator, Allocator>::readFrom(std::istream& in) {
+    BinaryHeap<T, Comparator, Allocator> result;
+    
+    std::vector<T> values;
+    readValueList(in, ",", [&values](std::string_view token) {
+        values.push_back(valueFromTokenOrThrow<T>(token));
+    });
+    result.build(values);
+    
+    return result;
+}
+
+// 2.5.5 Чтение из потока в формате toStringFormatted
+// Структура кучи однозначно определяется её свойствами, поэтому формат на результат не влияет
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator> BinaryHeap<T, Comparator, Allocator>::readFrom(std::istream& in, const std::string& format) {
+    (void)format;
+    return readFrom(in);
+}
+
+// 2.5.6 Чтение из потока в формате toNodeParentPairs
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator> BinaryHeap<T, Comparator, Allocator>::readNodeParentPairsFrom(std::istream& in) {
+    std::vector<std::pair<T, T>> pairs;
+    readValueList(in, ",", [&pairs](std::string_view token) {
+        pairs.push_back(nodeParentPairFromToken<T>(token));
+    });
+    return fromNodeParentPairs(pairs);
+}
+
+// 2.5.7 Сохранение двоичного снимка (элементы в уровневом порядке)
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::saveSnapshot(std::ostream& out) const {
+    SnapshotWriter<T> writer(out);
+    writer.writeHeader(SnapshotKind::BinaryHeap, size);
+    
+    std::queue<Node*> q;
+    if (root) q.push(root);
+    while (!q.empty()) {
+        Node* current = q.front();
+        q.pop();
+        
+        writer.writeElement(current->data);
+        
+        if (current->left) q.push(current->left);
+        if (current->right) q.push(current->right);
+    }
+    
+    writer.flush();
+}
+
+// 2.5.8 Загрузка двоичного снимка
+// Куча - полное двоичное дерево, поэтому уровневый порядок однозначно задаёт её структуру;
+// узлы связываются за O(n) без сравнения элементов
+template <typename T, typename Comparator, typename Allocator>
+BinaryHeap<T, Comparator, Allocator> BinaryHeap<T, Comparator, Allocator>::loadSnapshot(std::istream& in) {
+    BinaryHeap<T, Comparator, Allocator> result;
+    SnapshotReader<T> reader(in);
+    uint64_t count = reader.readHeader(SnapshotKind::BinaryHeap);
+    
+    // Очередь узлов, у которых ещё нет обоих потомков
+    std::queue<Node*> parents;
+    std::vector<Node*> order; // Узлы в уровневом порядке (для пересчёта хешей)
+    for (uint64_t i = 0; i < count; ++i) {
+        Node* parent = i == 0 ? nullptr : parents.front();
+        Node* node = result.createNode(reader.readElement(), parent);
+        
+        if (parent == nullptr) {
+            result.root = node;
+        } else if (parent->left == nullptr) {
+            parent->left = node;
+        } else {
+            parent->right = node;
+            parents.pop();
+        }
+        result.size++;
+        parents.push(node);
+        order.push_back(node);
+    }
+    
+    result.updateHashes(order);
     return result;
 }
 
 // Поиск узла по заданному пути
-template <typename T, typename Comparator>
-typename BinaryHeap<T, Comparator>::Node* BinaryHeap<T, Comparator>::findNodeByPath(const std::string& path) const {
+template <typename T, typename Comparator, typename Allocator>
+typename BinaryHeap<T, Comparator, Allocator>::Node* BinaryHeap<T, Comparator, Allocator>::findNodeByPath(const std::string& path) const {
     if (!root || path.empty()) return nullptr;
     
     Node* current = root;
@@ -814,27 +1127,36 @@ typename BinaryHeap<T, Comparator>::Node* BinaryHeap<T, Comparator>::findNodeByP
 }
 
 // Обход кучи с вызовом функции обратного вызова для каждого элемента (уровневый обход)
-template <typename T, typename Comparator>
-void BinaryHeap<T, Comparator>::traverse(std::function<void(const T&)> callback) const {
-    if (!root || !callback) return;
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::traverse(std::function<void(const T&)> callback) const {
+    if (!callback) return;
     
-    std::queue<Node*> q;
-    q.push(root);
-    
-    while (!q.empty()) {
-        Node* current = q.front();
-        q.pop();
+    traverse<std::function<void(const T&)>&>(callback);
+}
+
+template <typename T, typename Comparator, typename Allocator>
+template <typename F>
+void BinaryHeap<T, Comparator, Allocator>::traverse(F&& callback) const {
+    if (!root) return;
+    
+    // Очередь уровневого обхода - вектор с заранее известным размером
+    std::vector<Node*> queue;
+    queue.reserve(size);
+    queue.push_back(root);
+    
+    for (size_t head = 0; head < queue.size(); ++head) {
+        Node* current = queue[head];
         
         callback(current->data);
         
-        if (current->left) q.push(current->left);
-        if (current->right) q.push(current->right);
+        if (current->left) queue.push_back(current->left);
+        if (current->right) queue.push_back(current->right);
     }
 }
 
 // Вывод кучи в консоль (для отладки)
-template <typename T, typename Comparator>
-void BinaryHeap<T, Comparator>::printHeap() const {
+template <typename T, typename Comparator, typename Allocator>
+void BinaryHeap<T, Comparator, Allocator>::printHeap() const {
     if (isEmpty()) {
         std::cout << "Куча пуста" << std::endl;
         return;
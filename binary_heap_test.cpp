@@ -5,7 +5,13 @@
 #include <utility>
 #include <chrono>
 #include <random>
+#include <algorithm>
+#include <sstream>
+#include <numeric>
 #include "../include/binary_heap.h"
+#include "../include/array_heap.h"
+#include "../include/indexed_heap.h"
+#include "../include/pool_allocator.h"
 #include "../include/data_types.h"
 
 // Тест базовых операций для int
@@ -215,6 +221,321 @@ void testFromNodeParentPairs1() {
     std::cout << "Тест чтения из строки в формате списка пар «узел-родитель» пройден!" << std::endl;
 }
 
+// Тест порядка извлечения после большого числа вставок
+void testHeapExtractOrder() {
+    std::cout << "Запуск теста порядка извлечения элементов из кучи..." << std::endl;
+    
+    BinaryHeap<int> heap;
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<int> dist(-1000, 1000);
+    
+    const size_t count = 1000;
+    for (size_t i = 0; i < count; ++i) {
+        heap.insert(dist(gen));
+        assert(heap.getSize() == i + 1);
+    }
+    
+    // Элементы должны извлекаться в невозрастающем порядке
+    int previous = heap.extractMax();
+    while (!heap.isEmpty()) {
+        int current = heap.extractMax();
+        assert(current <= previous);
+        previous = current;
+    }
+    assert(heap.getSize() == 0);
+    
+    std::cout << "Тест порядка извлечения элементов из кучи пройден!" << std::endl;
+}
+
+// Тест кучи на непрерывном массиве
+void testArrayHeap() {
+    std::cout << "Запуск теста кучи на непрерывном массиве..." << std::endl;
+    
+    ArrayHeap<int> heap;
+    assert(heap.isEmpty() == true);
+    
+    heap.insert(10);
+    heap.insert(20);
+    heap.insert(5);
+    heap.insert(15);
+    heap.insert(25);
+    heap.insert(30);
+    
+    assert(heap.getSize() == 6);
+    assert(heap.top() == 30);
+    assert(heap.search(15) == true);
+    assert(heap.search(40) == false);
+    
+    // Строковые представления совпадают с BinaryHeap для той же последовательности вставок
+    BinaryHeap<int> nodeHeap;
+    for (int value : {10, 20, 5, 15, 25, 30}) {
+        nodeHeap.insert(value);
+    }
+    assert(heap.toString() == nodeHeap.toString());
+    assert(heap.toStringFormatted("КЛП") == nodeHeap.toStringFormatted("КЛП"));
+    assert(heap.toStringFormatted("ЛКП") == nodeHeap.toStringFormatted("ЛКП"));
+    assert(heap.toStringFormatted("ПЛК") == nodeHeap.toStringFormatted("ПЛК"));
+    assert(heap.toNodeParentPairs() == nodeHeap.toNodeParentPairs());
+    
+    // Поддерево и поиск поддерева
+    ArrayHeap<int> subheap = heap.extractSubHeap(20);
+    assert(subheap.getSize() == 3);
+    assert(heap.containsSubHeap(subheap) == true);
+    
+    ArrayHeap<int> notSubheap;
+    notSubheap.insert(30);
+    notSubheap.insert(5);
+    assert(heap.containsSubHeap(notSubheap) == false);
+    
+    // Удаление и извлечение максимума
+    assert(heap.remove(5) == true);
+    assert(heap.remove(5) == false);
+    assert(heap.extractMax() == 30);
+    assert(heap.extractMax() == 25);
+    assert(heap.getSize() == 3);
+    
+    // Чтение из строки и из списка пар
+    ArrayHeap<int> parsed = ArrayHeap<int>::fromString("[20,10,5]");
+    assert(parsed.getSize() == 3);
+    assert(parsed.top() == 20);
+    
+    std::vector<std::pair<int, int>> pairs = {{20, 20}, {10, 20}, {15, 10}};
+    ArrayHeap<int> fromPairs = ArrayHeap<int>::fromNodeParentPairs(pairs);
+    assert(fromPairs.getSize() == 3);
+    assert(fromPairs.search(15) == true);
+    
+    std::cout << "Тест кучи на непрерывном массиве пройден!" << std::endl;
+}
+
+// Тест построения кучи из набора значений
+void testHeapBuild() {
+    std::cout << "Запуск теста построения кучи из набора значений..." << std::endl;
+    
+    std::vector<int> values = {1, 2, 3, 4, 5, 6, 7};
+    
+    BinaryHeap<int> heap;
+    heap.insert(100); // Содержимое заменяется при построении
+    heap.build(values);
+    assert(heap.getSize() == 7);
+    assert(heap.toString() == "[7,5,6,4,2,1,3]");
+    
+    // Размер извлечённого поддерева и копии считается при копировании узлов
+    assert(heap.extractSubHeap(5).getSize() == 3);
+    assert(heap.extractSubHeap(3).getSize() == 1);
+    BinaryHeap<int> copy(heap);
+    assert(copy.getSize() == 7);
+    BinaryHeap<int> assigned;
+    assigned.insert(1);
+    assigned = heap;
+    assert(assigned.getSize() == 7);
+    copy = heap.extractSubHeap(6);
+    assert(copy.getSize() == 3 && copy.toString() == "[6,1,3]");
+    
+    ArrayHeap<int> arrayHeap;
+    arrayHeap.build(values.begin(), values.end());
+    assert(arrayHeap.toString() == heap.toString());
+    
+    // Проверяем порядок извлечения
+    for (int expected = 7; expected >= 1; --expected) {
+        assert(heap.extractMax() == expected);
+        assert(arrayHeap.extractMax() == expected);
+    }
+    
+    // Построение из пустого набора
+    heap.build(std::vector<int>());
+    assert(heap.isEmpty() == true);
+    
+    std::cout << "Тест построения кучи из набора значений пройден!" << std::endl;
+}
+
+// Значение, копирование которого по требованию выбрасывает исключение
+struct FragileValue {
+    static bool failCopy;
+    static int copiesBeforeFailure; // Число успешных копирований до исключения, -1 - без ограничения
+    
+    int key;
+    
+    explicit FragileValue(int key) : key(key) {}
+    FragileValue(const FragileValue& other) : key(other.key) {
+        if (failCopy || copiesBeforeFailure == 0) throw std::runtime_error("Копирование запрещено");
+        if (copiesBeforeFailure > 0) copiesBeforeFailure--;
+    }
+    FragileValue(FragileValue&&) = default;
+    FragileValue& operator=(const FragileValue&) = default;
+    FragileValue& operator=(FragileValue&&) = default;
+    
+    bool operator==(const FragileValue& other) const { return key == other.key; }
+    bool operator<(const FragileValue& other) const { return key < other.key; }
+};
+
+bool FragileValue::failCopy = false;
+int FragileValue::copiesBeforeFailure = -1;
+
+struct FragileValueHash {
+    size_t operator()(const FragileValue& value) const { return std::hash<int>()(value.key); }
+};
+
+// Хеш-функция, при которой все значения попадают в одну группу
+struct ConstantHash {
+    size_t operator()(int) const { return 7; }
+};
+
+// Тест индексированной кучи
+void testIndexedHeap() {
+    std::cout << "Запуск теста индексированной кучи..." << std::endl;
+    
+    IndexedHeap<int> heap;
+    assert(heap.insert(10) == true);
+    assert(heap.insert(20) == true);
+    assert(heap.insert(5) == true);
+    assert(heap.insert(15) == true);
+    assert(heap.insert(10) == false); // Повторная вставка игнорируется
+    
+    assert(heap.getSize() == 4);
+    assert(heap.top() == 20);
+    assert(heap.contains(15) == true);
+    assert(heap.search(30) == false);
+    
+    // Удаление произвольного элемента
+    assert(heap.remove(10) == true);
+    assert(heap.remove(10) == false);
+    assert(heap.search(10) == false);
+    assert(heap.getSize() == 3);
+    
+    // Увеличение и уменьшение приоритета
+    assert(heap.updatePriority(5, 25) == true);
+    assert(heap.top() == 25);
+    assert(heap.search(5) == false);
+    assert(heap.updatePriority(25, 1) == true);
+    assert(heap.top() == 20);
+    assert(heap.updatePriority(100, 50) == false);
+    assert(heap.updatePriority(1, 15) == false); // 15 уже есть в куче
+    
+    // Извлечение в порядке убывания
+    assert(heap.extractMax() == 20);
+    assert(heap.extractMax() == 15);
+    assert(heap.extractMax() == 1);
+    assert(heap.isEmpty() == true);
+    
+    // Случайная последовательность операций сверяется с BinaryHeap
+    std::mt19937 gen(2024);
+    std::uniform_int_distribution<int> dist(0, 200);
+    BinaryHeap<int> reference;
+    for (int i = 0; i < 2000; ++i) {
+        int value = dist(gen);
+        if (i % 3 == 2) {
+            assert(heap.remove(value) == reference.remove(value));
+        } else if (!reference.search(value)) {
+            heap.insert(value);
+            reference.insert(value);
+        }
+        assert(heap.getSize() == reference.getSize());
+        if (!heap.isEmpty()) {
+            assert(heap.top() == reference.top());
+        }
+    }
+    
+    // Построение за O(n) пропускает повторы
+    heap.build({3, 1, 3, 2});
+    assert(heap.getSize() == 3);
+    assert(heap.top() == 3);
+    
+    // Значения с одинаковым хешем различаются сравнением
+    IndexedHeap<int, std::less<int>, ConstantHash> colliding;
+    for (int value = 0; value < 50; ++value) {
+        colliding.insert(value);
+    }
+    assert(colliding.remove(25) && !colliding.search(25) && colliding.search(26));
+    assert(colliding.updatePriority(10, 100) && colliding.top() == 100);
+    assert(!colliding.search(10) && colliding.getSize() == 49);
+    
+    // Исключение при вставке не оставляет в куче позиции без элемента,
+    // в том числе при повторном использовании освобождённого дескриптора
+    IndexedHeap<FragileValue, std::less<FragileValue>, FragileValueHash> fragile;
+    for (int key = 0; key < 10; ++key) {
+        fragile.insert(FragileValue(key));
+    }
+    auto insertFails = [&fragile](int key) {
+        FragileValue::failCopy = true;
+        bool thrown = false;
+        try {
+            fragile.insert(FragileValue(key));
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        FragileValue::failCopy = false;
+        return thrown && !fragile.search(FragileValue(key));
+    };
+    assert(fragile.remove(FragileValue(3)));
+    assert(insertFails(42)); // Освобождённый дескриптор
+    assert(fragile.getSize() == 9);
+    assert(fragile.insert(FragileValue(3)));
+    assert(insertFails(43)); // Новый дескриптор
+    assert(fragile.getSize() == 10);
+    assert(fragile.insert(FragileValue(42)) && fragile.getSize() == 11);
+    int previous = 100;
+    while (!fragile.isEmpty()) {
+        int key = fragile.extractMax().key;
+        assert(key < previous);
+        previous = key;
+    }
+    
+    std::cout << "Тест индексированной кучи пройден!" << std::endl;
+}
+
+// Тест d-арной кучи на непрерывном массиве
+void testArrayHeapArity() {
+    std::cout << "Запуск теста d-арной кучи..." << std::endl;
+    
+    ArrayHeap<int, std::less<int>, 4> heap;
+    for (int value = 1; value <= 9; ++value) {
+        heap.insert(value);
+    }
+    assert(heap.getSize() == 9);
+    assert(heap.top() == 9);
+    
+    // У корня четыре потомка, поддерево второго уровня содержит свой блок потомков
+    assert(heap.toNodeParentPairs().find(":9)") != std::string::npos);
+    ArrayHeap<int, std::less<int>, 4> subheap = heap.extractSubHeap(heap.top());
+    assert(subheap.getSize() == 9);
+    assert(heap.containsSubHeap(subheap) == true);
+    
+    // Построение за O(n) и извлечение в порядке убывания для разных арностей
+    std::mt19937 gen(99);
+    std::uniform_int_distribution<int> dist(-500, 500);
+    std::vector<int> values(300);
+    for (auto& value : values) {
+        value = dist(gen);
+    }
+    std::vector<int> sorted = values;
+    std::sort(sorted.rbegin(), sorted.rend());
+    
+    ArrayHeap<int, std::less<int>, 3> ternary;
+    ArrayHeap<int, std::less<int>, 8> octal;
+    ternary.build(values);
+    for (int value : values) {
+        octal.insert(value);
+    }
+    assert(octal.remove(values[10]) == true);
+    octal.insert(values[10]);
+    for (int expected : sorted) {
+        assert(ternary.extractMax() == expected);
+        assert(octal.extractMax() == expected);
+    }
+    
+    // Узел с лишними потомками отвергается
+    std::vector<std::pair<int, int>> pairs = {{10, 10}, {1, 10}, {2, 10}, {3, 10}, {4, 10}, {5, 10}};
+    bool thrown = false;
+    try {
+        ArrayHeap<int, std::less<int>, 4>::fromNodeParentPairs(pairs);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown == true);
+    
+    std::cout << "Тест d-арной кучи пройден!" << std::endl;
+}
+
 // // Тест производительности
 // void testPerformance() {
 //     std::cout << "Запуск теста производительности..." << std::endl;
@@ -267,6 +588,463 @@ void testFromNodeParentPairs1() {
 //     std::cout << "Тест производительности завершен!" << std::endl;
 // }
 
+// Тест кучи с распределителем узлов из пула
+void testPoolAllocatedHeap() {
+    std::cout << "Запуск теста кучи с пулом узлов..." << std::endl;
+    
+    using PoolHeap = BinaryHeap<int, std::less<int>, PoolAllocator<int>>;
+    
+    PoolHeap heap;
+    std::vector<int> values;
+    for (int i = 0; i < 1000; i++) {
+        values.push_back((i * 37) % 1000);
+    }
+    heap.build(values);
+    assert(heap.getAllocator().liveCount() == 1000);
+    
+    // Копия получает собственный пул
+    PoolHeap copy(heap);
+    assert(copy.getAllocator() != heap.getAllocator());
+    
+    // Извлечённые узлы возвращаются в пул
+    for (int expected = 999; expected >= 500; expected--) {
+        assert(heap.extractMax() == expected);
+    }
+    assert(heap.getAllocator().liveCount() == 500);
+    
+    // Поддерево копируется в пул новой кучи
+    PoolHeap sub = copy.extractSubHeap(copy.top());
+    assert(sub.getSize() == copy.getSize());
+    assert(copy.getAllocator().liveCount() == 1000);
+    
+    // Очистка освобождает пул целиком
+    heap.clear();
+    assert(heap.isEmpty() == true);
+    assert(heap.getAllocator().liveCount() == 0);
+    heap.insert(5);
+    assert(heap.top() == 5);
+    assert(copy.extractMax() == 999);
+    
+    // Исключение при копировании значения посреди построения не оставляет узлов в пуле
+    using FragileHeap = BinaryHeap<FragileValue, std::less<FragileValue>, PoolAllocator<FragileValue>>;
+    std::vector<FragileValue> fragileValues;
+    for (int i = 0; i < 100; i++) {
+        fragileValues.push_back(FragileValue(i));
+    }
+    FragileHeap fragile;
+    FragileValue::copiesBeforeFailure = 40;
+    bool thrown = false;
+    try {
+        fragile.build(fragileValues);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    FragileValue::copiesBeforeFailure = -1;
+    assert(thrown);
+    assert(fragile.isEmpty() == true);
+    assert(fragile.getAllocator().liveCount() == 0);
+    fragile.build(fragileValues);
+    assert(fragile.getSize() == 100 && fragile.top().key == 99);
+    assert(fragile.getAllocator().liveCount() == 100);
+    
+    std::cout << "Тест кучи с пулом узлов пройден!" << std::endl;
+}
+
+// Тест однопроходного разбора строкового представления кучи
+void testStreamingParse() {
+    std::cout << "Запуск теста однопроходного разбора строки..." << std::endl;
+    
+    BinaryHeap<int> heap;
+    for (int i = 0; i < 50000; i++) {
+        heap.insert((i * 7919) % 50000);
+    }
+    BinaryHeap<int> parsed = BinaryHeap<int>::fromString(heap.toString());
+    assert(parsed.getSize() == heap.getSize());
+    assert(parsed.extractMax() == 49999);
+    
+    ArrayHeap<int> arrayParsed = ArrayHeap<int>::fromString(heap.toString());
+    assert(arrayParsed.getSize() == heap.getSize());
+    
+    assert(BinaryHeap<int>::fromString("[]").getSize() == 0);
+    assert(BinaryHeap<int>::fromString("[ 3 , 1 ,2]").extractMax() == 3);
+    
+    // Некорректный элемент приводит к исключению, как и раньше
+    bool thrown = false;
+    try {
+        BinaryHeap<int>::fromString("[1,x,2]");
+    } catch (const std::exception&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    std::cout << "Тест однопроходного разбора строки пройден!" << std::endl;
+}
+
+// Тест записи кучи в поток и чтения из потока
+void testStreamSerialization() {
+    std::cout << "Запуск теста записи в поток и чтения из потока..." << std::endl;
+    
+    BinaryHeap<int> heap;
+    for (int i = 0; i < 40000; i++) {
+        heap.insert((i * 7919) % 40000);
+    }
+    
+    // Уровневый обход
+    std::stringstream stream;
+    heap.writeTo(stream);
+    assert(stream.str() == heap.toString());
+    BinaryHeap<int> restored = BinaryHeap<int>::readFrom(stream);
+    assert(restored.getSize() == heap.getSize());
+    assert(restored.toString() == heap.toString());
+    
+    // Обход, заданный форматом
+    for (const char* format : {"КЛП", "ЛКП", "ЛПК", "КПЛ", "ПКЛ", "ПЛК", "уровни"}) {
+        std::stringstream formatted;
+        heap.writeTo(formatted, format);
+        assert(formatted.str() == heap.toStringFormatted(format));
+        BinaryHeap<int> loaded = BinaryHeap<int>::readFrom(formatted, format);
+        assert(loaded.getSize() == heap.getSize());
+        assert(loaded.top() == 39999);
+    }
+    
+    // Пары «узел-родитель»
+    std::stringstream pairs;
+    heap.writeNodeParentPairsTo(pairs);
+    assert(pairs.str() == heap.toNodeParentPairs());
+    BinaryHeap<int> fromPairs = BinaryHeap<int>::readNodeParentPairsFrom(pairs);
+    assert(fromPairs.getSize() == heap.getSize());
+    assert(fromPairs.toString() == heap.toString());
+    
+    // Пустая куча
+    BinaryHeap<int> empty;
+    std::stringstream emptyStream;
+    empty.writeTo(emptyStream);
+    assert(emptyStream.str() == "[]");
+    assert(BinaryHeap<int>::readFrom(emptyStream).isEmpty());
+    
+    // Некорректный элемент приводит к исключению, как в fromString
+    std::stringstream broken("[1,(2:1]");
+    bool thrown = false;
+    try {
+        BinaryHeap<int>::readNodeParentPairsFrom(broken);
+    } catch (const std::exception&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    std::cout << "Тест записи в поток и чтения из потока пройден!" << std::endl;
+}
+
+// Тест двоичного снимка кучи
+void testBinarySnapshot() {
+    std::cout << "Запуск теста двоичного снимка кучи..." << std::endl;
+    
+    BinaryHeap<int> heap;
+    for (int i = 0; i < 20000; i++) {
+        heap.insert((i * 7919) % 20000);
+    }
+    
+    std::stringstream stream;
+    heap.saveSnapshot(stream);
+    BinaryHeap<int> loaded = BinaryHeap<int>::loadSnapshot(stream);
+    assert(loaded.getSize() == heap.getSize());
+    assert(loaded.toString() == heap.toString());
+    assert(loaded.toNodeParentPairs() == heap.toNodeParentPairs());
+    
+    // Загруженная куча остаётся рабочей: вставка и извлечение в прежнем порядке
+    loaded.insert(50000);
+    assert(loaded.extractMax() == 50000);
+    for (int expected = 19999; expected >= 19990; expected--) {
+        assert(loaded.extractMax() == expected);
+    }
+    
+    // Complex и пустая куча в одном потоке
+    BinaryHeap<Complex> complexHeap;
+    for (int i = 0; i < 50; i++) {
+        complexHeap.insert(Complex(i, -i));
+    }
+    BinaryHeap<int> empty;
+    std::stringstream several;
+    complexHeap.saveSnapshot(several);
+    empty.saveSnapshot(several);
+    assert(BinaryHeap<Complex>::loadSnapshot(several).toString() == complexHeap.toString());
+    assert(BinaryHeap<int>::loadSnapshot(several).isEmpty());
+    
+    // Снимок структуры не читается как другой тип того же размера
+    BinaryHeap<PersonID> people;
+    for (int i = 0; i < 30; i++) {
+        people.insert(PersonID{i % 3, i});
+    }
+    std::stringstream peopleStream;
+    people.saveSnapshot(peopleStream);
+    std::string peopleSnapshot = peopleStream.str();
+    std::stringstream peopleCopy(peopleSnapshot);
+    BinaryHeap<PersonID> loadedPeople = BinaryHeap<PersonID>::loadSnapshot(peopleCopy);
+    assert(loadedPeople.getSize() == 30);
+    assert(loadedPeople.extractMax() == (PersonID{2, 29}));
+    static_assert(sizeof(PersonID) == sizeof(long long), "Размеры должны совпадать");
+    std::stringstream peopleAsNumbers(peopleSnapshot);
+    bool rejected = false;
+    try {
+        BinaryHeap<long long>::loadSnapshot(peopleAsNumbers);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
+    
+    // Снимок дерева не читается как снимок кучи
+    std::stringstream treeStream;
+    SnapshotWriter<int> writer(treeStream);
+    writer.writeHeader(SnapshotKind::BinarySearchTree, 0);
+    writer.flush();
+    bool thrown = false;
+    try {
+        BinaryHeap<int>::loadSnapshot(treeStream);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    std::cout << "Тест двоичного снимка кучи пройден!" << std::endl;
+}
+
+// Проверка, что список пар отвергается с исключением
+template <typename Heap>
+bool rejectsNodeParentPairs(const std::vector<std::pair<int, int>>& pairs) {
+    try {
+        Heap::fromNodeParentPairs(pairs);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+// Тест построения кучи из списка пар по плоскому индексу потомков
+void testNodeParentPairsIndex() {
+    std::cout << "Запуск теста построения кучи из списка пар по индексу потомков..." << std::endl;
+    
+    // Разбор строки toNodeParentPairs за один проход и сохранение порядка потомков
+    std::vector<std::pair<int, int>> parsed = parseNodeParentPairList<int>("[(9:9), (4:9),(7:9),(1:4), (3:4),(5:7)]");
+    std::vector<std::pair<int, int>> expectedPairs = {{9, 9}, {4, 9}, {7, 9}, {1, 4}, {3, 4}, {5, 7}};
+    assert(parsed == expectedPairs);
+    assert(parseNodeParentPairList<int>("[]").empty());
+    
+    BinaryHeap<int> heap = BinaryHeap<int>::fromNodeParentPairs(parsed);
+    assert(heap.getSize() == 6);
+    assert(heap.toString() == "[9,4,7,1,3,5]");
+    
+    // Пары в произвольном порядке и распределитель узлов из пула
+    std::vector<std::pair<int, int>> shuffled = {{5, 7}, {3, 4}, {7, 9}, {9, 9}, {1, 4}, {4, 9}};
+    BinaryHeap<int, std::less<int>, PoolAllocator<int>> pooled =
+        BinaryHeap<int, std::less<int>, PoolAllocator<int>>::fromNodeParentPairs(shuffled);
+    assert(pooled.toString() == "[9,7,4,5,3,1]");
+    assert(ArrayHeap<int>::fromNodeParentPairs(shuffled).toString() == "[9,7,4,5,3,1]");
+    
+    // Более двух детей, нет корня, недостижимые узлы, цикл из повторяющихся значений
+    assert(rejectsNodeParentPairs<BinaryHeap<int>>({{9, 9}, {4, 9}, {7, 9}, {8, 9}}));
+    assert(rejectsNodeParentPairs<BinaryHeap<int>>({{4, 9}, {7, 9}}));
+    assert(rejectsNodeParentPairs<BinaryHeap<int>>({{9, 9}, {4, 9}, {2, 3}}));
+    assert(rejectsNodeParentPairs<BinaryHeap<int>>({{9, 9}, {4, 9}, {9, 4}}));
+    assert(rejectsNodeParentPairs<ArrayHeap<int>>({{9, 9}, {4, 9}, {9, 4}}));
+    assert(rejectsNodeParentPairs<ArrayHeap<int>>({{9, 9}, {4, 9}, {7, 9}, {8, 9}}));
+    
+    // Круговой перевод большой кучи через список пар
+    std::vector<int> values(1000000);
+    std::iota(values.begin(), values.end(), 0);
+    std::shuffle(values.begin(), values.end(), std::mt19937(22));
+    BinaryHeap<int> large;
+    large.build(values);
+    std::string pairsText = large.toNodeParentPairs();
+    BinaryHeap<int> restored = BinaryHeap<int>::fromNodeParentPairs(parseNodeParentPairList<int>(pairsText));
+    assert(restored.getSize() == values.size());
+    assert(restored.toString() == large.toString());
+    assert(restored.extractMax() == 999999);
+    
+    std::cout << "Тест построения кучи из списка пар по индексу потомков пройден!" << std::endl;
+}
+
+// Проверка структурных хешей: куча, загруженная из снимка (хеши в ней вычислены заново),
+// и её поддеревья должны находиться в куче, хеши которой поддерживались при изменениях
+template <typename Heap>
+void checkSubHeapHashes(const Heap& heap) {
+    std::stringstream snapshot;
+    heap.saveSnapshot(snapshot);
+    Heap fresh = Heap::loadSnapshot(snapshot);
+    assert(heap.containsSubHeap(fresh));
+    
+    std::vector<int> values;
+    parseValueList(fresh.toString(), values);
+    for (size_t i = 0; i < values.size(); i += 5) {
+        assert(heap.containsSubHeap(fresh.extractSubHeap(values[i])));
+    }
+}
+
+// Тест структурных хешей для поиска вхождения поддерева в кучу
+void testSubHeapHashes() {
+    std::cout << "Запуск теста структурных хешей поддеревьев кучи..." << std::endl;
+    
+    // Много повторяющихся значений: без хешей каждая проверка доходила бы до листьев
+    BinaryHeap<int> heap;
+    std::mt19937 generator(23);
+    std::uniform_int_distribution<int> distribution(0, 3);
+    for (int step = 1; step <= 2000; ++step) {
+        if (step % 4 == 0) {
+            heap.extractMax();
+        } else if (step % 7 == 0) {
+            heap.remove(distribution(generator));
+        } else {
+            heap.insert(distribution(generator));
+        }
+        if (step % 250 == 0) {
+            checkSubHeapHashes(heap);
+        }
+    }
+    
+    std::vector<int> values(500);
+    for (auto& value : values) {
+        value = distribution(generator);
+    }
+    heap.build(values);
+    checkSubHeapHashes(heap);
+    
+    // Та же форма и те же значения, кроме последнего листа
+    std::iota(values.begin(), values.end(), 0);
+    std::shuffle(values.begin(), values.end(), generator);
+    BinaryHeap<int> distinct;
+    distinct.build(values);
+    std::vector<std::pair<int, int>> pairs = parseNodeParentPairList<int>(distinct.toNodeParentPairs());
+    assert(distinct.containsSubHeap(BinaryHeap<int>::fromNodeParentPairs(pairs)));
+    pairs.back().first = -1;
+    assert(!distinct.containsSubHeap(BinaryHeap<int>::fromNodeParentPairs(pairs)));
+    
+    std::cout << "Тест структурных хешей поддеревьев кучи пройден!" << std::endl;
+}
+
+// Значение, считающее свои копирования: перемещение не должно их добавлять
+struct CopyCounted {
+    static int copies;
+    
+    int key;
+    std::string payload;
+    
+    CopyCounted(int key, std::string payload) : key(key), payload(std::move(payload)) {}
+    CopyCounted(const CopyCounted& other) : key(other.key), payload(other.payload) { ++copies; }
+    CopyCounted(CopyCounted&&) = default;
+    CopyCounted& operator=(const CopyCounted& other) {
+        key = other.key;
+        payload = other.payload;
+        ++copies;
+        return *this;
+    }
+    CopyCounted& operator=(CopyCounted&&) = default;
+    
+    bool operator==(const CopyCounted& other) const { return key == other.key; }
+    bool operator<(const CopyCounted& other) const { return key < other.key; }
+};
+
+int CopyCounted::copies = 0;
+
+// Тест перемещения куч и вставки перемещением
+void testHeapMoveSemantics() {
+    std::cout << "Запуск теста перемещения куч..." << std::endl;
+    
+    // Вставка, emplace, удаление и извлечение вершины не копируют значения
+    BinaryHeap<CopyCounted> heap;
+    CopyCounted::copies = 0;
+    for (int i = 0; i < 500; ++i) {
+        int key = (i * 7919) % 500;
+        if (i % 2 == 0) {
+            CopyCounted value(key, "value " + std::to_string(key));
+            heap.insert(std::move(value));
+        } else {
+            heap.emplace(key, "value " + std::to_string(key));
+        }
+    }
+    for (int i = 0; i < 500; i += 5) {
+        assert(heap.remove(CopyCounted(i, "")));
+    }
+    CopyCounted top = heap.extractMax();
+    assert(top.key == 499 && top.payload == "value 499");
+    assert(heap.extractMax().key == 498);
+    assert(CopyCounted::copies == 0);
+    assert(heap.getSize() == 398);
+    
+    // Перемещение забирает узлы, исходная куча остаётся пустой и пригодной
+    BinaryHeap<CopyCounted> moved(std::move(heap));
+    assert(moved.getSize() == 398 && heap.isEmpty());
+    heap.emplace(1000, "reused");
+    assert(heap.getSize() == 1);
+    heap = std::move(moved);
+    assert(CopyCounted::copies == 0);
+    assert(heap.getSize() == 398 && moved.isEmpty());
+    int previous = 1000;
+    while (!heap.isEmpty()) {
+        int key = heap.extractMax().key;
+        assert(key <= previous);
+        previous = key;
+    }
+    assert(CopyCounted::copies == 0);
+    
+    // Кучи с пулом: копии распределителя разделяют пул, обе кучи остаются рабочими
+    using PoolHeap = BinaryHeap<std::string, std::less<std::string>, PoolAllocator<std::string>>;
+    PoolHeap pooled;
+    for (int i = 0; i < 100; ++i) {
+        pooled.insert(std::to_string(i));
+    }
+    PoolHeap pooledMoved(std::move(pooled));
+    pooled.insert("after move");
+    pooledMoved.insert("another");
+    assert(pooled.getSize() == 1 && pooledMoved.getSize() == 101);
+    pooled = std::move(pooledMoved);
+    assert(pooled.getSize() == 101 && pooledMoved.isEmpty());
+    assert(pooled.top() == "another");
+    
+    // Результат extractSubHeap присваивается перемещением
+    BinaryHeap<int> numbers;
+    numbers.build(std::vector<int>{9, 8, 7, 6, 5, 4, 3});
+    BinaryHeap<int> subheap;
+    subheap = numbers.extractSubHeap(8);
+    assert(subheap.getSize() == 3 && subheap.top() == 8);
+    
+    std::cout << "Тест перемещения куч пройден!" << std::endl;
+}
+
+// Тест загрузки из списка пар дерева, не являющегося полной кучей
+// Раньше такая куча загружалась как есть, и последующие вставка и извлечение вершины
+// обращались к отсутствующему узлу
+void testNodeParentPairsNonHeapShape() {
+    std::cout << "Запуск теста загрузки из списка пар дерева, не являющегося кучей..." << std::endl;
+    
+    // Неполное дерево: у 10 только правый потомок
+    BinaryHeap<int> heap = BinaryHeap<int>::fromNodeParentPairs({{20, 20}, {10, 20}, {15, 10}});
+    assert(heap.getSize() == 3);
+    assert(heap.toString() == ArrayHeap<int>::fromNodeParentPairs({{20, 20}, {10, 20}, {15, 10}}).toString());
+    heap.insert(1);
+    heap.insert(2);
+    assert(heap.extractMax() == 20);
+    assert(heap.extractMax() == 15);
+    assert(heap.extractMax() == 10);
+    assert(heap.extractMax() == 2);
+    assert(heap.extractMax() == 1);
+    assert(heap.isEmpty());
+    
+    // Нарушено свойство кучи: потомок больше родителя
+    BinaryHeap<int> unordered = BinaryHeap<int>::fromNodeParentPairs({{10, 10}, {20, 10}, {30, 10}});
+    assert(unordered.top() == 30);
+    assert(unordered.extractMax() == 30 && unordered.extractMax() == 20 && unordered.extractMax() == 10);
+    
+    // Корректная куча загружается без изменения формы
+    std::vector<std::pair<int, int>> valid = {{9, 9}, {7, 9}, {4, 9}, {5, 7}, {1, 7}, {3, 4}};
+    BinaryHeap<int> restored = BinaryHeap<int>::fromNodeParentPairs(valid);
+    assert(restored.toString() == "[9,7,4,5,1,3]");
+    std::vector<std::pair<int, int>> written = parseNodeParentPairList<int>(restored.toNodeParentPairs());
+    std::sort(written.begin(), written.end());
+    std::sort(valid.begin(), valid.end());
+    assert(written == valid);
+    
+    std::cout << "Тест загрузки из списка пар дерева, не являющегося кучей, пройден!" << std::endl;
+}
+
 int main() {
     // Устанавливаем русскую локаль для вывода
     setlocale(LC_ALL, "Russian");
@@ -282,6 +1060,19 @@ int main() {
     testStringConversion1();
     testFormattedStringConversions();
     testFromNodeParentPairs1();
+    testHeapExtractOrder();
+    testArrayHeap();
+    testHeapBuild();
+    testIndexedHeap();
+    testArrayHeapArity();
+    testPoolAllocatedHeap();
+    testStreamingParse();
+    testStreamSerialization();
+    testBinarySnapshot();
+    testNodeParentPairsIndex();
+    testSubHeapHashes();
+    testHeapMoveSemantics();
+    testNodeParentPairsNonHeapShape();
     
     std::cout << "Все тесты успешно пройдены!" << std::endl;
     
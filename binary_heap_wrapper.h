@@ -49,7 +49,7 @@ public:
     void insert(const std::string& valueStr) override {
         try {
             T value = parseValue(valueStr);
-            heap.insert(value);
+            heap.insert(std::move(value));
         } catch (const std::exception& e) {
             std::cerr << "Ошибка при вставке: " << e.what() << std::endl;
         }
@@ -105,7 +105,7 @@ public:
             auto subheap = heap.extractSubHeap(value);
             
             auto result = std::make_shared<HeapWrapper<T>>();
-            result->heap = subheap;
+            result->heap = std::move(subheap);
             return result;
         } catch (const std::exception& e) {
             std::cerr << "Ошибка при извлечении поддерева: " << e.what() << std::endl;
@@ -179,36 +179,8 @@ public:
         try {
             auto result = std::make_shared<HeapWrapper<T>>();
             
-            // Парсим строку вида "[(node1:parent1),(node2:parent2),...]"
-            std::string content = pairsStr;
-            if (content.size() >= 2) {
-                content = content.substr(1, content.size() - 2); // Удаляем [ и ]
-            } else {
-                return result; // Пустая куча
-            }
-            
-            std::vector<std::pair<T, T>> pairs;
-            size_t pos = 0;
-            
-            while ((pos = content.find("(")) != std::string::npos) {
-                size_t endPos = content.find(")", pos);
-                if (endPos == std::string::npos) break;
-                
-                std::string pairStr = content.substr(pos + 1, endPos - pos - 1);
-                size_t colonPos = pairStr.find(":");
-                
-                if (colonPos != std::string::npos) {
-                    std::string nodeStr = pairStr.substr(0, colonPos);
-                    std::string parentStr = pairStr.substr(colonPos + 1);
-                    
-                    T node = parseValue(nodeStr);
-                    T parent = parseValue(parentStr);
-                    
-                    pairs.push_back({node, parent});
-                }
-                
-                content.erase(0, endPos + 1);
-            }
+            // Строка вида "[(node1:parent1),(node2:parent2),...]" разбирается за один проход
+            std::vector<std::pair<T, T>> pairs = parseNodeParentPairList<T>(pairsStr);
             
             result->heap = BinaryHeap<T>::fromNodeParentPairs(pairs);
             return result;
@@ -236,18 +208,20 @@ void HeapWrapper<int>::fillWithRandomValues(int count, const std::string& minStr
             std::swap(min, max);
         }
         
-        // Очищаем кучу перед заполнением
-        heap.clear();
-        
         // Генерируем случайные числа
         std::random_device rd;
         std::mt19937 gen(rd());
         std::uniform_int_distribution<int> dist(min, max);
         
+        std::vector<int> values;
+        values.reserve(count > 0 ? count : 0);
         for (int i = 0; i < count; ++i) {
-            heap.insert(dist(gen));
+            values.push_back(dist(gen));
         }
         
+        // Строим кучу заново за линейное время (содержимое заменяется)
+        heap.build(values);
+        
         std::cout << "Куча заполнена " << count << " случайными значениями в диапазоне [" 
                   << min << ", " << max << "]" << std::endl;
     } catch (const std::exception& e) {
@@ -11,7 +11,18 @@
 #include <sstream>
 #include <map>
 #include <algorithm>
+#include <type_traits>
+#include <memory>
+#include <iterator>
+#include <utility>
+#include <cstddef>
+#include <cstdlib>
 #include "data_types.h" // Включаем определения пользовательских типов
+#include "pool_allocator.h"
+#include "thread_pool.h"
+#include "text_io.h"
+#include "binary_snapshot.h"
+#include "value_index.h"
 
 
 
@@ -25,34 +36,61 @@ enum class TraversalType {
     ReversePostOrder  // ПЛК - правое поддерево, левое поддерево, корень
 };
 
+// Политики балансировки бинарного дерева поиска
+struct Unbalanced {};  // Без автоматической балансировки (дерево может выродиться в список)
+struct AVLBalanced {}; // АВЛ-дерево: высота O(log n) поддерживается при каждой вставке и удалении
+
 // Шаблонный класс бинарного дерева поиска
-template <typename T>
+// Allocator задаёт распределитель памяти для узлов (например, PoolAllocator<T>)
+template <typename T, typename Balancing = Unbalanced, typename Allocator = std::allocator<T>>
 class BinarySearchTree {
 private:
+    // Включена ли автоматическая балансировка
+    static constexpr bool autoBalance = std::is_same<Balancing, AVLBalanced>::value;
+    
     // Структура узла дерева
     struct Node {
         T data;           // Данные узла
         Node* left;       // Указатель на левое поддерево
         Node* right;      // Указатель на правое поддерево
         Node* parent;     // Указатель на родительский узел (нужен для некоторых операций)
+        int height;       // Высота поддерева с корнем в данном узле (у листа 1)
+        size_t count;     // Количество узлов в поддереве с корнем в данном узле (у листа 1)
+        size_t hash;      // Структурный хеш поддерева (subtreeHash), для поиска вхождения поддерева
         
-        // Конструктор узла
-        Node(const T& value, Node* parent = nullptr) 
-            : data(value), left(nullptr), right(nullptr), parent(parent) {}
+        // Конструктор узла; значение копируется или перемещается в зависимости от аргумента
+        template <typename U>
+        explicit Node(U&& value, Node* parent = nullptr) 
+            : data(std::forward<U>(value)), left(nullptr), right(nullptr), parent(parent), height(1), count(1),
+              hash(subtreeHash(valueHash(data), 0, 0)) {}
     };
     
+    // Распределитель узлов и его свойства
+    using NodeAllocator = typename std::allocator_traits<Allocator>::template rebind_alloc<Node>;
+    using NodeTraits = std::allocator_traits<NodeAllocator>;
+    
     Node* root;  // Корень дерева
     size_t size; // Размер дерева (количество узлов)
+    NodeAllocator nodeAllocator; // Распределитель памяти для узлов
 
     // Вспомогательные методы
-    // Рекурсивная вставка узла
-    Node* insertNode(Node* node, const T& value, Node* parent);
+    // Создание и уничтожение узла через распределитель
+    template <typename U>
+    Node* createNode(U&& value, Node* parent = nullptr);
+    void destroyNode(Node* node);
+    
+    // Итеративная вставка узла (nullptr, если значение уже есть в дереве)
+    template <typename U>
+    Node* insertNode(U&& value);
     
-    // Рекурсивный поиск узла
+    // Итеративный поиск узла
     Node* findNode(Node* node, const T& value) const;
     
-    // Удаление узла
-    Node* removeNode(Node* node, const T& value);
+    // Удаление заданного узла из дерева
+    void removeNode(Node* node);
+    
+    // Подъём от узла к корню с пересчётом полей и восстановлением баланса
+    void retrace(Node* node);
     
     // Нахождение минимального узла в поддереве
     Node* findMin(Node* node) const;
@@ -60,47 +98,260 @@ private:
     // Нахождение максимального узла в поддереве
     Node* findMax(Node* node) const;
     
-    // Рекурсивное удаление дерева
-    void destroyTree(Node* node);
+    // Итеративное удаление дерева
+    // При releaseMemory == false узлы только разрушаются, а память остаётся распределителю
+    void destroyTree(Node* node, bool releaseMemory = true);
     
-    // Клонирование дерева
-    Node* cloneTree(Node* node, Node* parent = nullptr) const;
+    // Итеративное клонирование дерева
+    Node* cloneTree(Node* node, Node* parent = nullptr);
     
     // Метод для обхода дерева по заданному типу
-    void traverseByType(Node* node, TraversalType type, std::function<void(const T&)> callback) const;
+    // Обход выполняется по указателям на родителя, без рекурсии и стека
+    template <typename F>
+    void traverseByType(Node* node, TraversalType type, F& callback) const;
+    
+    // Быстрый обход в порядке возрастания с явным стеком глубиной в высоту дерева
+    template <typename F>
+    void forEachInOrder(F& callback) const;
+    
+    // Минимальный размер участка дерева, обрабатываемого одной задачей в параллельном режиме
+    static constexpr size_t minParallelChunk = 4096;
+    
+    // Количество участков для параллельной обработки (1 - обрабатывать последовательно)
+    size_t parallelChunkCount() const;
+    
+    // Параллельная обработка дерева участками упорядоченного обхода
+    // body(index, first, count) получает номер участка, его первый узел и количество узлов;
+    // участки с большими номерами содержат большие элементы
+    template <typename F>
+    void forEachChunkParallel(size_t chunks, F& body) const;
+    
+    // Построение дерева из отсортированного вектора, возможно с повторами (повторы пропускаются)
+    void buildFromSortedValues(std::vector<T>& values);
+    
+    // Тип обхода, задаваемый строкой форматирования toStringFormatted
+    static TraversalType traversalFromFormat(const std::string& format);
+    
+    // Запись значений в порядке обхода в строку или ChunkedWriter
+    template <typename Sink>
+    void writeList(Sink& sink, TraversalType type) const;
+    
+    // Построение дерева из последовательности текстовых элементов
+    template <typename ForEachToken>
+    void loadTokens(ForEachToken&& forEachToken);
+    
+    // Количество значений, собираемых из дерева в блок перед свёрткой
+    static constexpr size_t reduceBlockSize = 256;
+    
+    // Свёртка блока подряд идущих значений четырьмя независимыми цепочками накопления
+    // (по четверти блока каждая), которые затем объединяются по порядку
+    template <typename F, typename Combiner>
+    static T reduceBlock(const T* values, size_t count, F& func, Combiner& combiner, const T& identity);
     
     // Проверка, является ли данный узел поддеревом другого дерева
     bool isSubtree(Node* tree, Node* subtree) const;
     
     // Сравнение двух деревьев на идентичность
     bool areIdentical(Node* node1, Node* node2) const;
+    
+    // Высота поддерева (0 для пустого)
+    static int heightOf(Node* node);
+    
+    // Количество узлов в поддереве (0 для пустого)
+    static size_t countOf(Node* node);
+    
+    // Структурный хеш поддерева (0 для пустого)
+    static size_t hashOf(Node* node);
+    
+    // Пересчёт служебных полей узла по его потомкам
+    static void updateNode(Node* node);
+    
+    // Копирование служебных полей узла (при клонировании дерева)
+    static void copyNodeFields(Node* target, const Node* source);
+    
+    // Количество элементов, меньших value (или не больших value при inclusive == true)
+    size_t countBelow(const T& value, bool inclusive) const;
+    
+    // Узел k-го по возрастанию элемента (нумерация с 0, k < size)
+    Node* selectNode(size_t k) const;
+    
+    // Пересчёт служебных полей всех узлов поддерева (после построения структуры вручную)
+    static void updateSubtree(Node* node);
+    
+    // Повороты поддерева влево и вправо с сохранением указателей на родителя
+    // Возвращают новый корень поддерева
+    Node* rotateLeft(Node* node);
+    Node* rotateRight(Node* node);
+    
+    // Восстановление баланса узла (для АВЛ-политики) и пересчёт его полей
+    // Возвращает новый корень поддерева
+    Node* rebalanceNode(Node* node);
+    
+    // Выпрямление поддерева в упорядоченный список по указателям right (правыми поворотами)
+    // Возвращает голову списка; выполняется за O(n) без дополнительной памяти
+    static Node* treeToVine(Node* node);
+    
+    // Построение идеально сбалансированного дерева из первых count узлов списка
+    // Голова списка сдвигается на следующий неиспользованный узел
+    static Node* vineToTree(Node*& head, size_t count);
+    
+    // Следующий и предыдущий узлы в порядке возрастания (по указателям на родителя)
+    static Node* successorOf(Node* node);
+    static Node* predecessorOf(Node* node);
+    
+    // Первый узел со значением не меньше value (strict == false) или больше value (strict == true)
+    Node* boundNode(const T& value, bool strict) const;
+    
+    // Построение сбалансированного дерева из строго возрастающей последовательности за O(n)
+    // Значения, не удовлетворяющие predicate, пропускаются; текущее содержимое заменяется
+    template <typename InputIt, typename Predicate>
+    void buildFromSorted(InputIt first, InputIt last, Predicate predicate);
 
 public:
+    // Двунаправленный итератор по элементам дерева в порядке возрастания
+    // Переход к соседнему элементу выполняется по указателям на родителя за O(1) в среднем
+    // и без выделения памяти, поэтому обход k элементов с любой позиции стоит O(h + k).
+    // Элементы доступны только для чтения: изменение значения нарушило бы порядок дерева.
+    // Вставка и удаление делают итераторы недействительными.
+    class const_iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+        
+        const_iterator() : node(nullptr), tree(nullptr) {}
+        
+        reference operator*() const { return node->data; }
+        pointer operator->() const { return &node->data; }
+        
+        const_iterator& operator++() {
+            node = successorOf(node);
+            return *this;
+        }
+        
+        const_iterator operator++(int) {
+            const_iterator previous = *this;
+            node = successorOf(node);
+            return previous;
+        }
+        
+        // Шаг назад от end() переходит к наибольшему элементу
+        const_iterator& operator--() {
+            node = node != nullptr ? predecessorOf(node) : tree->findMax(tree->root);
+            return *this;
+        }
+        
+        const_iterator operator--(int) {
+            const_iterator next = *this;
+            --*this;
+            return next;
+        }
+        
+        bool operator==(const const_iterator& other) const { return node == other.node; }
+        bool operator!=(const const_iterator& other) const { return node != other.node; }
+        
+    private:
+        friend class BinarySearchTree;
+        
+        const_iterator(Node* node, const BinarySearchTree* tree) : node(node), tree(tree) {}
+        
+        Node* node;                   // Текущий узел (nullptr для позиции за последним элементом)
+        const BinarySearchTree* tree; // Дерево (нужно для шага назад от end())
+    };
+    
+    using iterator = const_iterator;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using reverse_iterator = const_reverse_iterator;
+    
+    // Диапазон элементов дерева, пригодный для цикла for по диапазону
+    class Range {
+    public:
+        Range(const_iterator first, const_iterator last) : first(first), last(last) {}
+        
+        const_iterator begin() const { return first; }
+        const_iterator end() const { return last; }
+        bool empty() const { return first == last; }
+        
+    private:
+        const_iterator first;
+        const_iterator last;
+    };
+    
     // Конструкторы и деструкторы
     BinarySearchTree();
+    explicit BinarySearchTree(const Allocator& allocator);
     BinarySearchTree(const BinarySearchTree& other);
+    BinarySearchTree(BinarySearchTree&& other) noexcept;
     ~BinarySearchTree();
     
     // Присваивание
     BinarySearchTree& operator=(const BinarySearchTree& other);
+    BinarySearchTree& operator=(BinarySearchTree&& other);
     
     // Базовые операции
     void insert(const T& value);       // Вставка элемента
+    void insert(T&& value);            // Вставка элемента перемещением
+    template <typename... Args>
+    void emplace(Args&&... args);      // Вставка элемента, построенного из аргументов конструктора T
     bool search(const T& value) const; // Поиск элемента
     bool remove(const T& value);       // Удаление элемента
     
     // Дополнительные операции
     bool isEmpty() const;              // Проверка на пустоту
     size_t getSize() const;            // Получение размера дерева
+    int getHeight() const;             // Получение высоты дерева
     void clear();                      // Очистка дерева
+    Allocator getAllocator() const;    // Получение распределителя памяти
+    
+    // Порядковые статистики за O(h) (O(log n) для сбалансированного дерева)
+    const T& select(size_t k) const;   // k-й по возрастанию элемент (нумерация с 0)
+    size_t rank(const T& value) const; // Количество элементов, меньших value
+    size_t countInRange(const T& lo, const T& hi) const; // Количество элементов в [lo, hi]
+    
+    // Упорядоченный обход и запросы диапазонов без копирования элементов
+    const_iterator begin() const;                    // Наименьший элемент
+    const_iterator end() const;                      // Позиция за наибольшим элементом
+    const_iterator cbegin() const;
+    const_iterator cend() const;
+    const_reverse_iterator rbegin() const;           // Обход в порядке убывания
+    const_reverse_iterator rend() const;
+    const_iterator lowerBound(const T& value) const; // Первый элемент, не меньший value, за O(h)
+    const_iterator upperBound(const T& value) const; // Первый элемент, больший value, за O(h)
+    Range range(const T& lo, const T& hi) const;     // Элементы из [lo, hi] в порядке возрастания
+    
+    // Построение сбалансированного дерева из строго возрастающей последовательности за O(n)
+    template <typename InputIt>
+    static BinarySearchTree<T, Balancing, Allocator> fromSorted(InputIt first, InputIt last);
     
     // 1.1 Балансировка дерева
     void balance();
     
     // 1.2 map, reduce, where
-    BinarySearchTree<T> map(std::function<T(const T&)> func) const;
+    // Шаблонные версии принимают любой вызываемый объект и встраиваются компилятором;
+    // версии с std::function оставлены для вызовов через стёртый тип (обёртки меню).
+    // Результаты map и where собираются из отсортированных участков за линейное время.
+    // В режиме ExecutionMode::Parallel дерево делится на участки упорядоченного обхода,
+    // которые обрабатываются на общем пуле потоков; func и predicate должны допускать
+    // одновременный вызов из нескольких потоков.
+    BinarySearchTree<T, Balancing, Allocator> map(std::function<T(const T&)> func) const;
     T reduce(std::function<T(const T&, const T&)> func, const T& initialValue) const;
-    BinarySearchTree<T> where(std::function<bool(const T&)> predicate) const;
+    BinarySearchTree<T, Balancing, Allocator> where(std::function<bool(const T&)> predicate) const;
+    template <typename F>
+    BinarySearchTree<T, Balancing, Allocator> map(F func, ExecutionMode mode = ExecutionMode::Sequential) const;
+    template <typename F>
+    T reduce(F func, const T& initialValue) const;
+    
+    // Ассоциативная свёртка: func(value, acc) добавляет значение к частичному результату,
+    // combiner(left, right) объединяет частичные результаты соседних участков,
+    // identity - нейтральный элемент. combiner должен быть ассоциативным и согласованным с func:
+    // func(value, acc) == combiner(acc, func(value, identity)). Порядок элементов сохраняется,
+    // поэтому коммутативность не требуется. Результат не включает начального значения.
+    template <typename F, typename Combiner>
+    T reduce(F func, Combiner combiner, const T& identity, ExecutionMode mode = ExecutionMode::Sequential) const;
+    template <typename F>
+    BinarySearchTree<T, Balancing, Allocator> where(F predicate, ExecutionMode mode = ExecutionMode::Sequential) const;
     
     // 1.3 Прошивка дерева (получение значений в порядке обхода)
     // 1.3.1 по фиксированному обходу (InOrder)
@@ -116,24 +367,39 @@ public:
     // 1.4.2 по обходу, задаваемому строкой форматирования
     std::string toStringFormatted(const std::string& format) const;
     
+    // 1.4.3 Запись в поток (буферизованная, без построения строки целиком)
+    void writeTo(std::ostream& out) const;                            // в формате toString
+    void writeTo(std::ostream& out, const std::string& format) const; // в формате toStringFormatted
+    
     // 1.5 Чтение из строки
     // 1.5.1 по фиксированному обходу
-    static BinarySearchTree<T> fromString(const std::string& str);
+    static BinarySearchTree<T, Balancing, Allocator> fromString(const std::string& str);
     
     // 1.5.2 по обходу, задаваемому строкой форматирования
-    static BinarySearchTree<T> fromStringFormatted(const std::string& str, const std::string& format);
+    static BinarySearchTree<T, Balancing, Allocator> fromStringFormatted(const std::string& str, const std::string& format);
     
     // 1.5.3 в формате списка пар «узел-родитель»
-    static BinarySearchTree<T> fromNodeParentPairs(const std::vector<std::pair<T, T>>& pairs);
+    static BinarySearchTree<T, Balancing, Allocator> fromNodeParentPairs(const std::vector<std::pair<T, T>>& pairs);
+    
+    // 1.5.4 Чтение из потока до его конца (буферизованное, без чтения текста целиком)
+    static BinarySearchTree<T, Balancing, Allocator> readFrom(std::istream& in);                            // формат toString
+    static BinarySearchTree<T, Balancing, Allocator> readFrom(std::istream& in, const std::string& format); // формат fromStringFormatted
+    
+    // 1.5.6 Двоичный снимок (для тривиально копируемых T и Complex, см. binary_snapshot.h)
+    // Загрузка восстанавливает структуру дерева за O(n) без сравнений элементов
+    void saveSnapshot(std::ostream& out) const;
+    static BinarySearchTree<T, Balancing, Allocator> loadSnapshot(std::istream& in);
     
     // 1.6 Извлечение поддерева (по заданному корню)
-    BinarySearchTree<T> extractSubtree(const T& value);
+    BinarySearchTree<T, Balancing, Allocator> extractSubtree(const T& value);
     
     // 1.7 Поиск на вхождение поддерева
-    bool containsSubtree(const BinarySearchTree<T>& subtree) const;
+    bool containsSubtree(const BinarySearchTree<T, Balancing, Allocator>& subtree) const;
     
     // Обход дерева с вызовом функции обратного вызова для каждого элемента
     void traverse(TraversalType type, std::function<void(const T&)> callback) const;
+    template <typename F>
+    void traverse(TraversalType type, F&& callback) const;
     
     // Вывод дерева в консоль (для отладки)
     void printTree() const;
@@ -141,26 +407,44 @@ public:
 
 // Реализация конструкторов и деструкторов
 
-template <typename T>
-BinarySearchTree<T>::BinarySearchTree() : root(nullptr), size(0) {}
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator>::BinarySearchTree() : root(nullptr), size(0), nodeAllocator() {}
+
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator>::BinarySearchTree(const Allocator& allocator)
+    : root(nullptr), size(0), nodeAllocator(allocator) {}
 
-template <typename T>
-BinarySearchTree<T>::BinarySearchTree(const BinarySearchTree& other) : root(nullptr), size(0) {
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator>::BinarySearchTree(const BinarySearchTree& other)
+    : root(nullptr), size(0), nodeAllocator(NodeTraits::select_on_container_copy_construction(other.nodeAllocator)) {
     if (other.root != nullptr) {
         root = cloneTree(other.root);
         size = other.size;
     }
 }
 
-template <typename T>
-BinarySearchTree<T>::~BinarySearchTree() {
+// Перемещение забирает узлы за O(1)
+// Распределитель копируется, а не перемещается, чтобы исходное дерево оставалось пригодным
+// для дальнейших вставок (копии PoolAllocator разделяют один пул)
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator>::BinarySearchTree(BinarySearchTree&& other) noexcept
+    : root(other.root), size(other.size), nodeAllocator(other.nodeAllocator) {
+    other.root = nullptr;
+    other.size = 0;
+}
+
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator>::~BinarySearchTree() {
     clear();
 }
 
-template <typename T>
-BinarySearchTree<T>& BinarySearchTree<T>::operator=(const BinarySearchTree& other) {
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator>& BinarySearchTree<T, Balancing, Allocator>::operator=(const BinarySearchTree& other) {
     if (this != &other) {
         clear();
+        if constexpr (NodeTraits::propagate_on_container_copy_assignment::value) {
+            nodeAllocator = other.nodeAllocator;
+        }
         if (other.root != nullptr) {
             root = cloneTree(other.root);
             size = other.size;
@@ -169,63 +453,146 @@ BinarySearchTree<T>& BinarySearchTree<T>::operator=(const BinarySearchTree& othe
     return *this;
 }
 
+// Узлы забираются, если распределитель переходит вместе с ними или распределители равны;
+// иначе узлы принадлежат чужому распределителю и дерево копируется
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator>& BinarySearchTree<T, Balancing, Allocator>::operator=(BinarySearchTree&& other) {
+    if (this != &other) {
+        if constexpr (!NodeTraits::propagate_on_container_move_assignment::value) {
+            if (!(nodeAllocator == other.nodeAllocator)) {
+                return *this = static_cast<const BinarySearchTree&>(other);
+            }
+        }
+        clear();
+        if constexpr (NodeTraits::propagate_on_container_move_assignment::value) {
+            nodeAllocator = other.nodeAllocator;
+        }
+        root = other.root;
+        size = other.size;
+        other.root = nullptr;
+        other.size = 0;
+    }
+    return *this;
+}
+
 // Реализация вспомогательных методов
 
-template <typename T>
-typename BinarySearchTree<T>::Node* BinarySearchTree<T>::cloneTree(Node* node, Node* parent) const {
+// Создание узла: выделение памяти и конструирование через распределитель
+template <typename T, typename Balancing, typename Allocator>
+template <typename U>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::createNode(U&& value, Node* parent) {
+    Node* node = NodeTraits::allocate(nodeAllocator, 1);
+    try {
+        NodeTraits::construct(nodeAllocator, node, std::forward<U>(value), parent);
+    } catch (...) {
+        NodeTraits::deallocate(nodeAllocator, node, 1);
+        throw;
+    }
+    return node;
+}
+
+// Уничтожение узла и возврат памяти распределителю
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::destroyNode(Node* node) {
+    NodeTraits::destroy(nodeAllocator, node);
+    NodeTraits::deallocate(nodeAllocator, node, 1);
+}
+
+// Клонирование обходом в прямом порядке по указателям на родителя, без рекурсии
+// Незаполненный указатель на потомка в копии означает, что этот потомок ещё не скопирован
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::cloneTree(Node* node, Node* parent) {
     if (node == nullptr) {
         return nullptr;
     }
     
-    Node* newNode = new Node(node->data, parent);
-    newNode->left = cloneTree(node->left, newNode);
-    newNode->right = cloneTree(node->right, newNode);
+    Node* copyRoot = createNode(node->data, parent);
+    copyNodeFields(copyRoot, node);
+    
+    Node* source = node;
+    Node* copy = copyRoot;
+    while (true) {
+        if (source->left != nullptr && copy->left == nullptr) {
+            copy->left = createNode(source->left->data, copy);
+            copyNodeFields(copy->left, source->left);
+            source = source->left;
+            copy = copy->left;
+        } else if (source->right != nullptr && copy->right == nullptr) {
+            copy->right = createNode(source->right->data, copy);
+            copyNodeFields(copy->right, source->right);
+            source = source->right;
+            copy = copy->right;
+        } else {
+            // Оба поддерева скопированы - возвращаемся к родителю
+            if (source == node) {
+                break;
+            }
+            source = source->parent;
+            copy = copy->parent;
+        }
+    }
     
-    return newNode;
+    return copyRoot;
 }
 
-template <typename T>
-void BinarySearchTree<T>::destroyTree(Node* node) {
-    if (node == nullptr) {
-        return;
+// Удаление дерева без рекурсии и дополнительной памяти:
+// левые поддеревья поднимаются правыми поворотами, узлы без левого потомка удаляются
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::destroyTree(Node* node, bool releaseMemory) {
+    while (node != nullptr) {
+        if (node->left != nullptr) {
+            Node* pivot = node->left;
+            node->left = pivot->right;
+            pivot->right = node;
+            node = pivot;
+        } else {
+            Node* next = node->right;
+            if (releaseMemory) {
+                destroyNode(node);
+            } else {
+                NodeTraits::destroy(nodeAllocator, node);
+            }
+            node = next;
+        }
     }
-    
-    destroyTree(node->left);
-    destroyTree(node->right);
-    delete node;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node* BinarySearchTree<T>::insertNode(Node* node, const T& value, Node* parent) {
-    if (node == nullptr) {
-        size++;
-        return new Node(value, parent);
-    }
-    
-    if (value < node->data) {
-        node->left = insertNode(node->left, value, node);
-    } else if (value > node->data) {
-        node->right = insertNode(node->right, value, node);
+// Вставка: спуск по дереву циклом, затем подъём к корню с пересчётом полей
+// Значение перемещается в узел только после спуска, когда сравнения с ним закончены
+template <typename T, typename Balancing, typename Allocator>
+template <typename U>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::insertNode(U&& value) {
+    Node* parent = nullptr;
+    Node** link = &root;
+    while (*link != nullptr) {
+        parent = *link;
+        if (value < parent->data) {
+            link = &parent->left;
+        } else if (value > parent->data) {
+            link = &parent->right;
+        } else {
+            return nullptr; // Повторяющиеся значения не вставляются
+        }
     }
     
+    Node* node = createNode(std::forward<U>(value), parent);
+    *link = node;
+    size++;
+    retrace(parent);
     return node;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node* BinarySearchTree<T>::findNode(Node* node, const T& value) const {
-    if (node == nullptr || node->data == value) {
-        return node;
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::findNode(Node* node, const T& value) const {
+    while (node != nullptr && !(node->data == value)) {
+        node = value < node->data ? node->left : node->right;
     }
     
-    if (value < node->data) {
-        return findNode(node->left, value);
-    } else {
-        return findNode(node->right, value);
-    }
+    return node;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node* BinarySearchTree<T>::findMin(Node* node) const {
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::findMin(Node* node) const {
     if (node == nullptr) {
         return nullptr;
     }
@@ -237,8 +604,8 @@ typename BinarySearchTree<T>::Node* BinarySearchTree<T>::findMin(Node* node) con
     return node;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node* BinarySearchTree<T>::findMax(Node* node) const {
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::findMax(Node* node) const {
     if (node == nullptr) {
         return nullptr;
     }
@@ -250,53 +617,180 @@ typename BinarySearchTree<T>::Node* BinarySearchTree<T>::findMax(Node* node) con
     return node;
 }
 
-template <typename T>
-typename BinarySearchTree<T>::Node* BinarySearchTree<T>::removeNode(Node* node, const T& value) {
-    if (node == nullptr) {
-        return nullptr;
+// Удаление заданного узла
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::removeNode(Node* node) {
+    // Случай 3: Узел имеет двух потомков
+    if (node->left != nullptr && node->right != nullptr) {
+        // Находим узел-преемник (наименьший узел в правом поддереве),
+        // копируем его данные в текущий узел и удаляем преемник вместо него
+        Node* successor = findMin(node->right);
+        node->data = std::move(successor->data);
+        node = successor;
+    }
+    
+    // Случаи 1 и 2: у узла не более одного потомка, он занимает место узла
+    Node* child = node->left != nullptr ? node->left : node->right;
+    Node* parent = node->parent;
+    
+    if (child != nullptr) {
+        child->parent = parent;
     }
     
-    if (value < node->data) {
-        node->left = removeNode(node->left, value);
-    } else if (value > node->data) {
-        node->right = removeNode(node->right, value);
+    if (parent == nullptr) {
+        root = child;
+    } else if (parent->left == node) {
+        parent->left = child;
     } else {
-        // Нашли узел для удаления
-        
-        // Случай 1: Узел является листом (не имеет потомков)
-        if (node->left == nullptr && node->right == nullptr) {
-            delete node;
-            size--;
-            return nullptr;
-        }
-        // Случай 2: Узел имеет только одного потомка
-        else if (node->left == nullptr) {
-            Node* temp = node->right;
-            if (temp != nullptr) {
-                temp->parent = node->parent;
+        parent->right = child;
+    }
+    
+    destroyNode(node);
+    size--;
+    retrace(parent);
+}
+
+// Подъём от узла к корню: пересчёт полей, повороты (для АВЛ-политики)
+// и перепривязка нового корня поддерева к родителю
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::retrace(Node* node) {
+    while (node != nullptr) {
+        Node* parent = node->parent;
+        bool isLeftChild = parent != nullptr && parent->left == node;
+        
+        Node* subtreeRoot = rebalanceNode(node);
+        if (parent == nullptr) {
+            root = subtreeRoot;
+        } else if (isLeftChild) {
+            parent->left = subtreeRoot;
+        } else {
+            parent->right = subtreeRoot;
+        }
+        
+        node = parent;
+    }
+}
+
+// Высота поддерева (0 для пустого)
+template <typename T, typename Balancing, typename Allocator>
+int BinarySearchTree<T, Balancing, Allocator>::heightOf(Node* node) {
+    return node ? node->height : 0;
+}
+
+// Количество узлов в поддереве (0 для пустого)
+template <typename T, typename Balancing, typename Allocator>
+size_t BinarySearchTree<T, Balancing, Allocator>::countOf(Node* node) {
+    return node ? node->count : 0;
+}
+
+// Структурный хеш поддерева (0 для пустого)
+template <typename T, typename Balancing, typename Allocator>
+size_t BinarySearchTree<T, Balancing, Allocator>::hashOf(Node* node) {
+    return node ? node->hash : 0;
+}
+
+// Пересчёт служебных полей узла по его потомкам
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::updateNode(Node* node) {
+    node->height = 1 + std::max(heightOf(node->left), heightOf(node->right));
+    node->count = 1 + countOf(node->left) + countOf(node->right);
+    node->hash = subtreeHash(valueHash(node->data), hashOf(node->left), hashOf(node->right));
+}
+
+// Копирование служебных полей узла
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::copyNodeFields(Node* target, const Node* source) {
+    target->height = source->height;
+    target->count = source->count;
+    target->hash = source->hash;
+}
+
+// Пересчёт служебных полей всех узлов поддерева в обратном порядке (потомки раньше родителя)
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::updateSubtree(Node* node) {
+    if (node == nullptr) {
+        return;
+    }
+    
+    std::stack<std::pair<Node*, bool>> stack;
+    stack.push(std::make_pair(node, false));
+    while (!stack.empty()) {
+        Node* current = stack.top().first;
+        bool childrenDone = stack.top().second;
+        stack.pop();
+        
+        if (childrenDone) {
+            updateNode(current);
+            continue;
+        }
+        
+        stack.push(std::make_pair(current, true));
+        if (current->right) stack.push(std::make_pair(current->right, false));
+        if (current->left) stack.push(std::make_pair(current->left, false));
+    }
+}
+
+// Поворот влево: правый потомок становится корнем поддерева
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::rotateLeft(Node* node) {
+    Node* pivot = node->right;
+    
+    node->right = pivot->left;
+    if (pivot->left != nullptr) {
+        pivot->left->parent = node;
+    }
+    
+    pivot->parent = node->parent;
+    pivot->left = node;
+    node->parent = pivot;
+    
+    updateNode(node);
+    updateNode(pivot);
+    return pivot;
+}
+
+// Поворот вправо: левый потомок становится корнем поддерева
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::rotateRight(Node* node) {
+    Node* pivot = node->left;
+    
+    node->left = pivot->right;
+    if (pivot->right != nullptr) {
+        pivot->right->parent = node;
+    }
+    
+    pivot->parent = node->parent;
+    pivot->right = node;
+    node->parent = pivot;
+    
+    updateNode(node);
+    updateNode(pivot);
+    return pivot;
+}
+
+// Восстановление баланса узла
+// Ссылку на новый корень поддерева из родителя обновляет вызывающий код
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::rebalanceNode(Node* node) {
+    updateNode(node);
+    
+    if constexpr (autoBalance) {
+        int balanceFactor = heightOf(node->left) - heightOf(node->right);
+        
+        if (balanceFactor > 1) {
+            // Левое поддерево выше: при перекосе внука вправо нужен двойной поворот
+            if (heightOf(node->left->left) < heightOf(node->left->right)) {
+                node->left = rotateLeft(node->left);
             }
-            delete node;
-            size--;
-            return temp;
-        } else if (node->right == nullptr) {
-            Node* temp = node->left;
-            if (temp != nullptr) {
-                temp->parent = node->parent;
+            return rotateRight(node);
+        }
+        
+        if (balanceFactor < -1) {
+            // Правое поддерево выше: при перекосе внука влево нужен двойной поворот
+            if (heightOf(node->right->right) < heightOf(node->right->left)) {
+                node->right = rotateRight(node->right);
             }
-            delete node;
-            size--;
-            return temp;
-        }
-        // Случай 3: Узел имеет двух потомков
-        else {
-            // Находим узел-преемник (наименьший узел в правом поддереве)
-            Node* successor = findMin(node->right);
-            
-            // Копируем данные преемника в текущий узел
-            node->data = successor->data;
-            
-            // Удаляем преемник
-            node->right = removeNode(node->right, successor->data);
+            return rotateLeft(node);
         }
     }
     
@@ -305,197 +799,700 @@ typename BinarySearchTree<T>::Node* BinarySearchTree<T>::removeNode(Node* node,
 
 // Реализация базовых операций
 
-template <typename T>
-void BinarySearchTree<T>::insert(const T& value) {
-    root = insertNode(root, value, nullptr);
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::insert(const T& value) {
+    insertNode(value);
+}
+
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::insert(T&& value) {
+    insertNode(std::move(value));
 }
 
-template <typename T>
-bool BinarySearchTree<T>::search(const T& value) const {
+// Для поиска места вставки значение нужно заранее, поэтому оно строится до спуска и затем перемещается в узел
+template <typename T, typename Balancing, typename Allocator>
+template <typename... Args>
+void BinarySearchTree<T, Balancing, Allocator>::emplace(Args&&... args) {
+    insertNode(T(std::forward<Args>(args)...));
+}
+
+template <typename T, typename Balancing, typename Allocator>
+bool BinarySearchTree<T, Balancing, Allocator>::search(const T& value) const {
     return findNode(root, value) != nullptr;
 }
 
-template <typename T>
-bool BinarySearchTree<T>::remove(const T& value) {
-    size_t oldSize = size;
-    root = removeNode(root, value);
-    return size < oldSize;
+template <typename T, typename Balancing, typename Allocator>
+bool BinarySearchTree<T, Balancing, Allocator>::remove(const T& value) {
+    Node* node = findNode(root, value);
+    if (node == nullptr) {
+        return false;
+    }
+    
+    removeNode(node);
+    return true;
 }
 
-template <typename T>
-bool BinarySearchTree<T>::isEmpty() const {
+template <typename T, typename Balancing, typename Allocator>
+bool BinarySearchTree<T, Balancing, Allocator>::isEmpty() const {
     return root == nullptr;
 }
 
-template <typename T>
-size_t BinarySearchTree<T>::getSize() const {
+template <typename T, typename Balancing, typename Allocator>
+size_t BinarySearchTree<T, Balancing, Allocator>::getSize() const {
     return size;
 }
 
-template <typename T>
-void BinarySearchTree<T>::clear() {
+template <typename T, typename Balancing, typename Allocator>
+int BinarySearchTree<T, Balancing, Allocator>::getHeight() const {
+    return heightOf(root);
+}
+
+template <typename T, typename Balancing, typename Allocator>
+Allocator BinarySearchTree<T, Balancing, Allocator>::getAllocator() const {
+    return Allocator(nodeAllocator);
+}
+
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::clear() {
+    // Распределитель с пулом освобождает всю память разом, если пул принадлежит только этому дереву;
+    // узлы обходятся лишь тогда, когда у данных есть нетривиальный деструктор
+    if constexpr (SupportsBulkRelease<NodeAllocator>::value) {
+        if (root != nullptr && nodeAllocator.liveCount() == size) {
+            if constexpr (!std::is_trivially_destructible<Node>::value) {
+                destroyTree(root, false);
+            }
+            nodeAllocator.release(size);
+            root = nullptr;
+            size = 0;
+            return;
+        }
+    }
+    
     destroyTree(root);
     root = nullptr;
     size = 0;
 }
 
+// k-й по возрастанию элемент
+template <typename T, typename Balancing, typename Allocator>
+const T& BinarySearchTree<T, Balancing, Allocator>::select(size_t k) const {
+    if (k >= size) {
+        throw std::runtime_error("Номер элемента выходит за пределы дерева");
+    }
+    
+    return selectNode(k)->data;
+}
+
+// Узел k-го по возрастанию элемента: спуск по дереву с учётом размеров левых поддеревьев
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::selectNode(size_t k) const {
+    Node* node = root;
+    while (true) {
+        size_t leftCount = countOf(node->left);
+        if (k < leftCount) {
+            node = node->left;
+        } else if (k == leftCount) {
+            return node;
+        } else {
+            k -= leftCount + 1;
+            node = node->right;
+        }
+    }
+}
+
+// Количество элементов, меньших value (или не больших value при inclusive == true)
+template <typename T, typename Balancing, typename Allocator>
+size_t BinarySearchTree<T, Balancing, Allocator>::countBelow(const T& value, bool inclusive) const {
+    size_t result = 0;
+    Node* node = root;
+    while (node != nullptr) {
+        bool below = inclusive ? !(value < node->data) : node->data < value;
+        if (below) {
+            // Узел и всё его левое поддерево лежат ниже границы
+            result += countOf(node->left) + 1;
+            node = node->right;
+        } else {
+            node = node->left;
+        }
+    }
+    return result;
+}
+
+template <typename T, typename Balancing, typename Allocator>
+size_t BinarySearchTree<T, Balancing, Allocator>::rank(const T& value) const {
+    return countBelow(value, false);
+}
+
+template <typename T, typename Balancing, typename Allocator>
+size_t BinarySearchTree<T, Balancing, Allocator>::countInRange(const T& lo, const T& hi) const {
+    if (hi < lo) {
+        return 0;
+    }
+    return countBelow(hi, true) - countBelow(lo, false);
+}
+
 // Реализация метода обхода дерева
-template <typename T>
-void BinarySearchTree<T>::traverseByType(Node* node, TraversalType type, std::function<void(const T&)> callback) const {
+// Обход без рекурсии и стека: направление следующего шага определяется тем,
+// откуда пришли в текущий узел - от родителя, из первого или из второго поддерева.
+// Обратные обходы отличаются только порядком поддеревьев (сначала правое).
+template <typename T, typename Balancing, typename Allocator>
+template <typename F>
+void BinarySearchTree<T, Balancing, Allocator>::traverseByType(Node* node, TraversalType type, F& callback) const {
     if (node == nullptr) {
         return;
     }
     
-    switch (type) {
-        case TraversalType::PreOrder: // КЛП
-            callback(node->data);
-            traverseByType(node->left, type, callback);
-            traverseByType(node->right, type, callback);
-            break;
-            
-        case TraversalType::InOrder: // ЛКП
-            traverseByType(node->left, type, callback);
-            callback(node->data);
-            traverseByType(node->right, type, callback);
-            break;
-            
-        case TraversalType::PostOrder: // ЛПК
-            traverseByType(node->left, type, callback);
-            traverseByType(node->right, type, callback);
-            callback(node->data);
-            break;
-            
-        case TraversalType::ReversePreOrder: // КПЛ
-            callback(node->data);
-            traverseByType(node->right, type, callback);
-            traverseByType(node->left, type, callback);
-            break;
-            
-        case TraversalType::ReverseInOrder: // ПКЛ
-            traverseByType(node->right, type, callback);
-            callback(node->data);
-            traverseByType(node->left, type, callback);
-            break;
-            
-        case TraversalType::ReversePostOrder: // ПЛК
-            traverseByType(node->right, type, callback);
-            traverseByType(node->left, type, callback);
-            callback(node->data);
-            break;
+    bool reversed = type == TraversalType::ReversePreOrder
+        || type == TraversalType::ReverseInOrder
+        || type == TraversalType::ReversePostOrder;
+    bool preOrder = type == TraversalType::PreOrder || type == TraversalType::ReversePreOrder;
+    bool inOrder = type == TraversalType::InOrder || type == TraversalType::ReverseInOrder;
+    bool postOrder = type == TraversalType::PostOrder || type == TraversalType::ReversePostOrder;
+    
+    Node* stop = node->parent;
+    Node* previous = stop;
+    Node* current = node;
+    while (current != stop) {
+        Node* first = reversed ? current->right : current->left;
+        Node* second = reversed ? current->left : current->right;
+        Node* next = current->parent;
+        
+        if (previous == current->parent) {
+            // Пришли сверху: корень, затем первое поддерево
+            if (preOrder) callback(current->data);
+            if (first != nullptr) {
+                next = first;
+            } else {
+                if (inOrder) callback(current->data);
+                if (second != nullptr) {
+                    next = second;
+                } else if (postOrder) {
+                    callback(current->data);
+                }
+            }
+        } else if (previous == first) {
+            // Первое поддерево пройдено: корень, затем второе поддерево
+            if (inOrder) callback(current->data);
+            if (second != nullptr) {
+                next = second;
+            } else if (postOrder) {
+                callback(current->data);
+            }
+        } else {
+            // Оба поддерева пройдены
+            if (postOrder) callback(current->data);
+        }
+        
+        previous = current;
+        current = next;
     }
 }
 
-template <typename T>
-void BinarySearchTree<T>::traverse(TraversalType type, std::function<void(const T&)> callback) const {
+// Обход в порядке возрастания с явным стеком: каждый узел кладётся в стек и снимается
+// ровно один раз, без подъёмов по цепочке предков. Размер стека известен заранее - это высота дерева.
+template <typename T, typename Balancing, typename Allocator>
+template <typename F>
+void BinarySearchTree<T, Balancing, Allocator>::forEachInOrder(F& callback) const {
+    std::vector<Node*> stack;
+    stack.reserve(heightOf(root));
+    
+    Node* current = root;
+    while (current != nullptr || !stack.empty()) {
+        while (current != nullptr) {
+            stack.push_back(current);
+            current = current->left;
+        }
+        
+        current = stack.back();
+        stack.pop_back();
+        callback(current->data);
+        current = current->right;
+    }
+}
+
+// Количество участков: по несколько на поток, чтобы сгладить неравномерную нагрузку,
+// но не меньше minParallelChunk элементов в участке
+template <typename T, typename Balancing, typename Allocator>
+size_t BinarySearchTree<T, Balancing, Allocator>::parallelChunkCount() const {
+    size_t byThreads = (ThreadPool::shared().getThreadCount() + 1) * 4;
+    size_t bySize = size / minParallelChunk;
+    return std::max<size_t>(1, std::min(byThreads, bySize));
+}
+
+// Участки - равные по числу элементов отрезки упорядоченного обхода. Первый узел участка
+// находится по размерам поддеревьев за O(h), дальше узлы перебираются по указателям на родителя,
+// поэтому разбиение не зависит от формы дерева
+template <typename T, typename Balancing, typename Allocator>
+template <typename F>
+void BinarySearchTree<T, Balancing, Allocator>::forEachChunkParallel(size_t chunks, F& body) const {
+    size_t chunkSize = (size + chunks - 1) / chunks;
+    ThreadPool::shared().parallelFor(chunks, [this, chunkSize, &body](size_t index) {
+        size_t first = index * chunkSize;
+        if (first >= size) {
+            return;
+        }
+        body(index, selectNode(first), std::min(chunkSize, size - first));
+    });
+}
+
+// Повторы определяются так же, как при вставке: по эквивалентности относительно operator<
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::buildFromSortedValues(std::vector<T>& values) {
+    auto last = std::unique(values.begin(), values.end(), [](const T& a, const T& b) {
+        return !(a < b) && !(b < a);
+    });
+    buildFromSorted(values.begin(), last, [](const T&) { return true; });
+}
+
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::traverse(TraversalType type, std::function<void(const T&)> callback) const {
     traverseByType(root, type, callback);
 }
 
+template <typename T, typename Balancing, typename Allocator>
+template <typename F>
+void BinarySearchTree<T, Balancing, Allocator>::traverse(TraversalType type, F&& callback) const {
+    traverseByType(root, type, callback);
+}
+
+// Выпрямление поддерева в упорядоченный список
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::treeToVine(Node* node) {
+    Node* head = nullptr;
+    Node* tail = nullptr;
+    Node* rest = node;
+    
+    while (rest != nullptr) {
+        if (rest->left != nullptr) {
+            // Правый поворот: левый потомок поднимается на место текущего узла
+            Node* pivot = rest->left;
+            rest->left = pivot->right;
+            pivot->right = rest;
+            rest = pivot;
+        } else {
+            // У узла нет левого поддерева - он следующий по порядку
+            if (tail == nullptr) {
+                head = rest;
+            } else {
+                tail->right = rest;
+            }
+            tail = rest;
+            rest = rest->right;
+        }
+    }
+    
+    return head;
+}
+
+// Построение идеально сбалансированного дерева из упорядоченного списка
+// Глубина рекурсии равна высоте результата, т.е. O(log n)
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::vineToTree(Node*& head, size_t count) {
+    if (count == 0) {
+        return nullptr;
+    }
+    
+    // Средний элемент становится корнем, как и при прежней балансировке
+    size_t leftCount = (count - 1) / 2;
+    Node* left = vineToTree(head, leftCount);
+    
+    Node* node = head;
+    head = head->right;
+    
+    node->parent = nullptr;
+    node->left = left;
+    if (left != nullptr) {
+        left->parent = node;
+    }
+    
+    node->right = vineToTree(head, count - 1 - leftCount);
+    if (node->right != nullptr) {
+        node->right->parent = node;
+    }
+    
+    updateNode(node);
+    return node;
+}
+
 // 1.1 Балансировка дерева
-template <typename T>
-void BinarySearchTree<T>::balance() {
-    // Собираем все элементы дерева в отсортированный массив
-    std::vector<T> elements;
-    traverse(TraversalType::InOrder, [&elements](const T& value) {
-        elements.push_back(value);
-    });
+// Узлы не пересоздаются: дерево выпрямляется в список и заново связывается за O(n)
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::balance() {
+    Node* head = treeToVine(root);
+    root = vineToTree(head, size);
+}
+
+// Следующий узел в порядке возрастания: наименьший в правом поддереве
+// или ближайший предок, для которого узел лежит в левом поддереве
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::successorOf(Node* node) {
+    if (node->right != nullptr) {
+        node = node->right;
+        while (node->left != nullptr) {
+            node = node->left;
+        }
+        return node;
+    }
     
-    // Очищаем текущее дерево
-    clear();
+    Node* parent = node->parent;
+    while (parent != nullptr && parent->right == node) {
+        node = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+// Предыдущий узел в порядке возрастания: наибольший в левом поддереве
+// или ближайший предок, для которого узел лежит в правом поддереве
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::predecessorOf(Node* node) {
+    if (node->left != nullptr) {
+        node = node->left;
+        while (node->right != nullptr) {
+            node = node->right;
+        }
+        return node;
+    }
     
-    // Вспомогательная функция для построения сбалансированного дерева
-    std::function<void(int, int)> buildBalanced = [&](int start, int end) {
-        if (start > end) {
-            return;
+    Node* parent = node->parent;
+    while (parent != nullptr && parent->left == node) {
+        node = parent;
+        parent = parent->parent;
+    }
+    return parent;
+}
+
+// Первый узел со значением не меньше value (или больше value при strict == true)
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Node* BinarySearchTree<T, Balancing, Allocator>::boundNode(const T& value, bool strict) const {
+    Node* result = nullptr;
+    Node* node = root;
+    while (node != nullptr) {
+        bool fits = strict ? value < node->data : !(node->data < value);
+        if (fits) {
+            // Узел подходит; ищем меньший подходящий в левом поддереве
+            result = node;
+            node = node->left;
+        } else {
+            node = node->right;
         }
-        
-        // Выбираем средний элемент как корень
-        int mid = (start + end) / 2;
-        insert(elements[mid]);
-        
-        // Рекурсивно строим левое и правое поддерево
-        buildBalanced(start, mid - 1);
-        buildBalanced(mid + 1, end);
-    };
+    }
+    return result;
+}
+
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::const_iterator BinarySearchTree<T, Balancing, Allocator>::begin() const {
+    return const_iterator(findMin(root), this);
+}
+
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::const_iterator BinarySearchTree<T, Balancing, Allocator>::end() const {
+    return const_iterator(nullptr, this);
+}
+
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::const_iterator BinarySearchTree<T, Balancing, Allocator>::cbegin() const {
+    return begin();
+}
+
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::const_iterator BinarySearchTree<T, Balancing, Allocator>::cend() const {
+    return end();
+}
+
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::const_reverse_iterator BinarySearchTree<T, Balancing, Allocator>::rbegin() const {
+    return const_reverse_iterator(end());
+}
+
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::const_reverse_iterator BinarySearchTree<T, Balancing, Allocator>::rend() const {
+    return const_reverse_iterator(begin());
+}
+
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::const_iterator BinarySearchTree<T, Balancing, Allocator>::lowerBound(const T& value) const {
+    return const_iterator(boundNode(value, false), this);
+}
+
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::const_iterator BinarySearchTree<T, Balancing, Allocator>::upperBound(const T& value) const {
+    return const_iterator(boundNode(value, true), this);
+}
+
+// Элементы из [lo, hi]: границы находятся за O(h), элементы перебираются лениво
+template <typename T, typename Balancing, typename Allocator>
+typename BinarySearchTree<T, Balancing, Allocator>::Range BinarySearchTree<T, Balancing, Allocator>::range(const T& lo, const T& hi) const {
+    if (hi < lo) {
+        return Range(end(), end());
+    }
+    return Range(lowerBound(lo), upperBound(hi));
+}
+
+// Узлы создаются в порядке возрастания и связываются в список по указателям right,
+// который затем превращается в сбалансированное дерево
+template <typename T, typename Balancing, typename Allocator>
+template <typename InputIt, typename Predicate>
+void BinarySearchTree<T, Balancing, Allocator>::buildFromSorted(InputIt first, InputIt last, Predicate predicate) {
+    clear();
     
-    // Строим сбалансированное дерево
-    if (!elements.empty()) {
-        buildBalanced(0, elements.size() - 1);
+    Node* head = nullptr;
+    Node* tail = nullptr;
+    size_t count = 0;
+    try {
+        for (; first != last; ++first) {
+            const T& value = *first;
+            if (!predicate(value)) {
+                continue;
+            }
+            if (tail != nullptr && !(tail->data < value)) {
+                throw std::runtime_error("Значения должны строго возрастать");
+            }
+            
+            Node* node = createNode(value);
+            if (tail == nullptr) {
+                head = node;
+            } else {
+                tail->right = node;
+            }
+            tail = node;
+            count++;
+        }
+    } catch (...) {
+        destroyTree(head);
+        throw;
     }
+    
+    root = vineToTree(head, count);
+    size = count;
+}
+
+// Построение сбалансированного дерева из строго возрастающей последовательности
+template <typename T, typename Balancing, typename Allocator>
+template <typename InputIt>
+BinarySearchTree<T, Balancing, Allocator> BinarySearchTree<T, Balancing, Allocator>::fromSorted(InputIt first, InputIt last) {
+    BinarySearchTree<T, Balancing, Allocator> result;
+    result.buildFromSorted(first, last, [](const T&) { return true; });
+    return result;
 }
 
 // 1.2 map, reduce, where
-template <typename T>
-BinarySearchTree<T> BinarySearchTree<T>::map(std::function<T(const T&)> func) const {
-    BinarySearchTree<T> result;
+// Версии с std::function вызывают шаблонные с явно указанным типом функции
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator> BinarySearchTree<T, Balancing, Allocator>::map(std::function<T(const T&)> func) const {
+    return map<std::function<T(const T&)>&>(func, ExecutionMode::Sequential);
+}
+
+template <typename T, typename Balancing, typename Allocator>
+T BinarySearchTree<T, Balancing, Allocator>::reduce(std::function<T(const T&, const T&)> func, const T& initialValue) const {
+    return reduce<std::function<T(const T&, const T&)>&>(func, initialValue);
+}
+
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator> BinarySearchTree<T, Balancing, Allocator>::where(std::function<bool(const T&)> predicate) const {
+    return where<std::function<bool(const T&)>&>(predicate, ExecutionMode::Sequential);
+}
+
+// Значения функции сортируются и собираются в сбалансированное дерево за линейное время
+// В параллельном режиме каждый участок вычисляется и сортируется отдельно,
+// после чего отсортированные участки попарно сливаются.
+// Сортировка и слияние устойчивы: из равных значений, как и при вставке, остаётся первое.
+template <typename T, typename Balancing, typename Allocator>
+template <typename F>
+BinarySearchTree<T, Balancing, Allocator> BinarySearchTree<T, Balancing, Allocator>::map(F func, ExecutionMode mode) const {
+    BinarySearchTree<T, Balancing, Allocator> result;
+    size_t chunks = mode == ExecutionMode::Parallel ? parallelChunkCount() : 1;
     
-    // Обходим исходное дерево и применяем функцию к каждому элементу
-    traverse(TraversalType::InOrder, [&result, &func](const T& value) {
-        result.insert(func(value));
-    });
+    std::vector<T> values;
+    if (chunks == 1) {
+        values.reserve(size);
+        auto apply = [&values, &func](const T& value) {
+            values.push_back(func(value));
+        };
+        forEachInOrder(apply);
+        std::stable_sort(values.begin(), values.end());
+    } else {
+        std::vector<std::vector<T>> parts(chunks);
+        auto mapChunk = [&parts, &func](size_t index, Node* node, size_t count) {
+            std::vector<T>& part = parts[index];
+            part.reserve(count);
+            for (; count > 0; --count, node = successorOf(node)) {
+                part.push_back(func(node->data));
+            }
+            std::stable_sort(part.begin(), part.end());
+        };
+        forEachChunkParallel(chunks, mapChunk);
+        
+        // Попарное слияние: на каждом шаге число участков уменьшается вдвое
+        while (parts.size() > 1) {
+            std::vector<std::vector<T>> merged((parts.size() + 1) / 2);
+            ThreadPool::shared().parallelFor(merged.size(), [&parts, &merged](size_t index) {
+                size_t left = 2 * index;
+                if (left + 1 == parts.size()) {
+                    merged[index] = std::move(parts[left]);
+                    return;
+                }
+                merged[index].resize(parts[left].size() + parts[left + 1].size());
+                std::merge(parts[left].begin(), parts[left].end(),
+                           parts[left + 1].begin(), parts[left + 1].end(), merged[index].begin());
+            });
+            parts = std::move(merged);
+        }
+        values = std::move(parts[0]);
+    }
     
+    result.buildFromSortedValues(values);
     return result;
 }
 
-template <typename T>
-T BinarySearchTree<T>::reduce(std::function<T(const T&, const T&)> func, const T& initialValue) const {
+template <typename T, typename Balancing, typename Allocator>
+template <typename F>
+T BinarySearchTree<T, Balancing, Allocator>::reduce(F func, const T& initialValue) const {
     T result = initialValue;
     
     // Обходим дерево и применяем функцию свертки
-    traverse(TraversalType::InOrder, [&result, &func](const T& value) {
+    auto fold = [&result, &func](const T& value) {
         result = func(value, result);
-    });
+    };
+    forEachInOrder(fold);
     
     return result;
 }
 
-template <typename T>
-BinarySearchTree<T> BinarySearchTree<T>::where(std::function<bool(const T&)> predicate) const {
-    BinarySearchTree<T> result;
+// Независимые цепочки накопления не ждут результатов друг друга, поэтому процессор
+// выполняет их одновременно, а компилятор может векторизовать цикл
+template <typename T, typename Balancing, typename Allocator>
+template <typename F, typename Combiner>
+T BinarySearchTree<T, Balancing, Allocator>::reduceBlock(const T* values, size_t count, F& func, Combiner& combiner, const T& identity) {
+    const size_t quarter = count / 4;
+    const T* first = values;
+    const T* second = first + quarter;
+    const T* third = second + quarter;
+    const T* fourth = third + quarter;
+    
+    T acc0 = identity;
+    T acc1 = identity;
+    T acc2 = identity;
+    T acc3 = identity;
+    for (size_t i = 0; i < quarter; ++i) {
+        acc0 = func(first[i], acc0);
+        acc1 = func(second[i], acc1);
+        acc2 = func(third[i], acc2);
+        acc3 = func(fourth[i], acc3);
+    }
+    // Остаток блока продолжает последнюю четверть
+    for (size_t i = 4 * quarter; i < count; ++i) {
+        acc3 = func(first[i], acc3);
+    }
     
-    // Обходим исходное дерево и фильтруем элементы по предикату
-    traverse(TraversalType::InOrder, [&result, &predicate](const T& value) {
-        if (predicate(value)) {
-            result.insert(value);
+    return combiner(combiner(acc0, acc1), combiner(acc2, acc3));
+}
+
+// Значения собираются из дерева блоками и сворачиваются reduceBlock.
+// В параллельном режиме каждый участок упорядоченного обхода сворачивается отдельной задачей,
+// а частичные результаты объединяются combiner в порядке участков
+template <typename T, typename Balancing, typename Allocator>
+template <typename F, typename Combiner>
+T BinarySearchTree<T, Balancing, Allocator>::reduce(F func, Combiner combiner, const T& identity, ExecutionMode mode) const {
+    size_t chunks = mode == ExecutionMode::Parallel ? parallelChunkCount() : 1;
+    
+    if (chunks == 1) {
+        T result = identity;
+        std::vector<T> block(reduceBlockSize, identity);
+        size_t filled = 0;
+        auto collect = [&](const T& value) {
+            block[filled++] = value;
+            if (filled == reduceBlockSize) {
+                result = combiner(result, reduceBlock(block.data(), filled, func, combiner, identity));
+                filled = 0;
+            }
+        };
+        forEachInOrder(collect);
+        if (filled > 0) {
+            result = combiner(result, reduceBlock(block.data(), filled, func, combiner, identity));
         }
-    });
+        return result;
+    }
+    
+    std::vector<T> partials(chunks, identity);
+    auto reduceChunk = [&](size_t index, Node* node, size_t count) {
+        T result = identity;
+        std::vector<T> block(std::min(count, reduceBlockSize), identity);
+        while (count > 0) {
+            size_t blockCount = std::min(count, reduceBlockSize);
+            for (size_t i = 0; i < blockCount; ++i, node = successorOf(node)) {
+                block[i] = node->data;
+            }
+            result = combiner(result, reduceBlock(block.data(), blockCount, func, combiner, identity));
+            count -= blockCount;
+        }
+        partials[index] = result;
+    };
+    forEachChunkParallel(chunks, reduceChunk);
     
+    T result = identity;
+    for (const T& partial : partials) {
+        result = combiner(result, partial);
+    }
     return result;
 }
 
-// 1.3.1 Получение значений в порядке InOrder
-template <typename T>
-std::vector<T> BinarySearchTree<T>::getValuesInOrder() const {
-    std::vector<T> values;
+// Отобранные элементы идут в порядке возрастания, поэтому дерево строится
+// за O(n) без повторных вставок (и не вырождается в список).
+// В параллельном режиме участки фильтруются независимо и затем соединяются по порядку.
+template <typename T, typename Balancing, typename Allocator>
+template <typename F>
+BinarySearchTree<T, Balancing, Allocator> BinarySearchTree<T, Balancing, Allocator>::where(F predicate, ExecutionMode mode) const {
+    BinarySearchTree<T, Balancing, Allocator> result;
+    size_t chunks = mode == ExecutionMode::Parallel ? parallelChunkCount() : 1;
+    
+    if (chunks == 1) {
+        result.buildFromSorted(begin(), end(), predicate);
+        return result;
+    }
     
-    if (root == nullptr) {
-        return values;
+    std::vector<std::vector<T>> parts(chunks);
+    auto filterChunk = [&parts, &predicate](size_t index, Node* node, size_t count) {
+        std::vector<T>& part = parts[index];
+        for (; count > 0; --count, node = successorOf(node)) {
+            if (predicate(node->data)) {
+                part.push_back(node->data);
+            }
+        }
+    };
+    forEachChunkParallel(chunks, filterChunk);
+    
+    size_t total = 0;
+    for (const auto& part : parts) {
+        total += part.size();
+    }
+    std::vector<T> values;
+    values.reserve(total);
+    for (auto& part : parts) {
+        values.insert(values.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
     }
     
-    // Используем итеративный обход InOrder
-    std::stack<Node*> stack;
-    Node* current = root;
+    result.buildFromSorted(values.begin(), values.end(), [](const T&) { return true; });
+    return result;
+}
+
+// 1.3.1 Получение значений в порядке InOrder
+template <typename T, typename Balancing, typename Allocator>
+std::vector<T> BinarySearchTree<T, Balancing, Allocator>::getValuesInOrder() const {
+    std::vector<T> values;
+    values.reserve(size);
     
-    while (current != nullptr || !stack.empty()) {
-        // Идем до самого левого узла
-        while (current != nullptr) {
-            stack.push(current);
-            current = current->left;
-        }
-        
-        current = stack.top();
-        stack.pop();
-        
-        values.push_back(current->data);
-        
-        current = current->right;
+    // Обход итератором по указателям на родителя, без стека
+    for (const T& value : *this) {
+        values.push_back(value);
     }
     
     return values;
 }
 
 // 1.3.2 Получение значений в порядке заданного обхода
-template <typename T>
-std::vector<T> BinarySearchTree<T>::getValuesByTraversal(TraversalType type) const {
+template <typename T, typename Balancing, typename Allocator>
+std::vector<T> BinarySearchTree<T, Balancing, Allocator>::getValuesByTraversal(TraversalType type) const {
     std::vector<T> values;
     
     // Используем общий метод обхода
@@ -506,205 +1503,431 @@ std::vector<T> BinarySearchTree<T>::getValuesByTraversal(TraversalType type) con
     return values;
 }
 
-// 1.4.1 Сохранение в строку по фиксированному обходу
-template <typename T>
-std::string BinarySearchTree<T>::toString() const {
-    if (root == nullptr) {
-        return "[]";
+// Тип обхода, задаваемый строкой форматирования (по умолчанию - InOrder)
+template <typename T, typename Balancing, typename Allocator>
+TraversalType BinarySearchTree<T, Balancing, Allocator>::traversalFromFormat(const std::string& format) {
+    if (format == "{К}(Л)[П]") {
+        return TraversalType::PreOrder;         // КЛП
+    } else if (format == "(Л){К}[П]") {
+        return TraversalType::InOrder;          // ЛКП
+    } else if (format == "(Л)[П]{К}") {
+        return TraversalType::PostOrder;        // ЛПК
+    } else if (format == "{К}[П](Л)") {
+        return TraversalType::ReversePreOrder;  // КПЛ
+    } else if (format == "[П]{К}(Л)") {
+        return TraversalType::ReverseInOrder;   // ПКЛ
+    } else if (format == "[П](Л){К}") {
+        return TraversalType::ReversePostOrder; // ПЛК
     }
-    
-    std::string result = "[";
+    return TraversalType::InOrder;
+}
+
+// Запись значений в порядке обхода в виде "[a, b, c]"
+// sink - std::string или ChunkedWriter
+template <typename T, typename Balancing, typename Allocator>
+template <typename Sink>
+void BinarySearchTree<T, Balancing, Allocator>::writeList(Sink& sink, TraversalType type) const {
+    sink += '[';
     bool first = true;
-    
-    // Используем InOrder (ЛКП) обход по умолчанию
-    traverse(TraversalType::InOrder, [&result, &first](const T& value) {
+    traverse(type, [&sink, &first](const T& value) {
         if (!first) {
-            result += ", ";
+            sink += ", ";
         }
-        result += valueToString(value);
+        appendValue(sink, value);
         first = false;
     });
-    
-    result += "]";
-    return result;
+    sink += ']';
 }
 
-// 1.4.2 Сохранение в строку по обходу, задаваемому строкой форматирования
-template <typename T>
-std::string BinarySearchTree<T>::toStringFormatted(const std::string& format) const {
-    if (root == nullptr) {
-        return "[]";
-    }
+// Построение дерева из последовательности элементов
+// forEachToken(onToken) вызывает onToken(std::string_view) для каждого элемента; некорректные пропускаются.
+// Пока значения строго возрастают (так их сохраняет toString), узлы собираются в список, который
+// затем за O(n) превращается в сбалансированное дерево; остальные значения вставляются обычным образом.
+// Промежуточный вектор значений не создаётся, поэтому в памяти находится только само дерево.
+template <typename T, typename Balancing, typename Allocator>
+template <typename ForEachToken>
+void BinarySearchTree<T, Balancing, Allocator>::loadTokens(ForEachToken&& forEachToken) {
+    clear();
     
-    // Парсим строку форматирования и определяем тип обхода
-    TraversalType type = TraversalType::InOrder; // По умолчанию
+    Node* head = nullptr;
+    Node* tail = nullptr;
+    size_t count = 0;
+    bool ascending = true;
     
-    if (format == "{К}(Л)[П]") {
-        type = TraversalType::PreOrder;     // КЛП
-    } else if (format == "(Л){К}[П]") {
-        type = TraversalType::InOrder;      // ЛКП
-    } else if (format == "(Л)[П]{К}") {
-        type = TraversalType::PostOrder;    // ЛПК
-    } else if (format == "{К}[П](Л)") {
-        type = TraversalType::ReversePreOrder;  // КПЛ
-    } else if (format == "[П]{К}(Л)") {
-        type = TraversalType::ReverseInOrder;   // ПКЛ
-    } else if (format == "[П](Л){К}") {
-        type = TraversalType::ReversePostOrder; // ПЛК
+    try {
+        forEachToken([&](std::string_view token) {
+            std::optional<T> value = valueFromToken<T>(token);
+            if (!value) {
+                return;
+            }
+            if (ascending) {
+                if (tail == nullptr || tail->data < *value) {
+                    Node* node = createNode(std::move(*value));
+                    if (tail == nullptr) {
+                        head = node;
+                    } else {
+                        tail->right = node;
+                    }
+                    tail = node;
+                    count++;
+                    return;
+                }
+                // Порядок нарушен: превращаем собранный список в дерево и дальше вставляем
+                root = vineToTree(head, count);
+                size = count;
+                ascending = false;
+            }
+            insert(std::move(*value));
+        });
+    } catch (...) {
+        if (ascending) {
+            destroyTree(head);
+        }
+        throw;
     }
     
-    std::string result = "[";
-    bool first = true;
+    if (ascending) {
+        root = vineToTree(head, count);
+        size = count;
+    }
+}
+
+// 1.4.1 Сохранение в строку по фиксированному обходу
+template <typename T, typename Balancing, typename Allocator>
+std::string BinarySearchTree<T, Balancing, Allocator>::toString() const {
+    std::string result;
+    writeList(result, TraversalType::InOrder);
+    return result;
+}
+
+// 1.4.2 Сохранение в строку по обходу, задаваемому строкой форматирования
+template <typename T, typename Balancing, typename Allocator>
+std::string BinarySearchTree<T, Balancing, Allocator>::toStringFormatted(const std::string& format) const {
+    std::string result;
+    writeList(result, traversalFromFormat(format));
+    return result;
+}
+
+// 1.4.3 Запись в поток в формате toString
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::writeTo(std::ostream& out) const {
+    ChunkedWriter writer(out);
+    writeList(writer, TraversalType::InOrder);
+    writer.flush();
+}
+
+// 1.4.4 Запись в поток в формате toStringFormatted
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::writeTo(std::ostream& out, const std::string& format) const {
+    ChunkedWriter writer(out);
+    writeList(writer, traversalFromFormat(format));
+    writer.flush();
+}
+
+// 1.5.1 Чтение из строки по фиксированному обходу
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator> BinarySearchTree<T, Balancing, Allocator>::fromString(const std::string& str) {
+    BinarySearchTree<T, Balancing, Allocator> result;
+    
+    // Разбираем элементы между квадратными скобками за один проход
+    result.loadTokens([&str](auto&& onToken) {
+        ValueTokenizer tokenizer(stripBrackets(str), ", ");
+        std::string_view token;
+        while (tokenizer.next(token)) {
+            onToken(token);
+        }
+    });
     
-    traverse(type, [&result, &first](const T& value) {
-        if (!first) {
-            result += ", ";
+    return result;
+}
+
+// 1.5.2 Чтение из строки по обходу, задаваемому строкой форматирования
+// Значения берутся из всех сегментов, заключённых в {}, () или []; порядок обхода на результат не влияет
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator> BinarySearchTree<T, Balancing, Allocator>::fromStringFormatted(const std::string& str, const std::string& format) {
+    BinarySearchTree<T, Balancing, Allocator> result;
+    if (str.empty() || format.empty()) return result;
+    
+    result.loadTokens([&str](auto&& onToken) {
+        std::string_view text(str);
+        for (size_t i = 0; i < text.size(); ++i) {
+            char open = text[i];
+            char close = 0;
+            if (open == '{') close = '}';
+            else if (open == '(') close = ')';
+            else if (open == '[') close = ']';
+            else continue;
+            size_t end = text.find(close, i + 1);
+            if (end == std::string_view::npos) break;
+            onToken(text.substr(i + 1, end - i - 1));
+            i = end;
         }
-        result += valueToString(value);
-        first = false;
     });
     
-    result += "]";
     return result;
 }
 
-// 1.5.1 Чтение из строки по фиксированному обходу
-template <typename T>
-BinarySearchTree<T> BinarySearchTree<T>::fromString(const std::string& str) {
-    BinarySearchTree<T> result;
+// 1.5.4 Чтение из потока в формате toString
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator> BinarySearchTree<T, Balancing, Allocator>::readFrom(std::istream& in) {
+    BinarySearchTree<T, Balancing, Allocator> result;
+    result.loadTokens([&in](auto&& onToken) {
+        readValueList(in, ", ", onToken);
+    });
+    return result;
+}
+
+// 1.5.5 Чтение из потока в формате fromStringFormatted
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator> BinarySearchTree<T, Balancing, Allocator>::readFrom(std::istream& in, const std::string& format) {
+    BinarySearchTree<T, Balancing, Allocator> result;
+    if (format.empty()) return result;
+    
+    result.loadTokens([&in](auto&& onToken) {
+        readBracketSegments(in, onToken);
+    });
+    return result;
+}
+
+// 1.5.3 Чтение из списка пар «узел-родитель»
+// Каждая пара - узел и его родитель; корень - единственное значение, которое встречается только как
+// родитель. Родители находятся по хеш-индексу значений (ValueIndex), поэтому построение занимает ожидаемое O(n).
+// Пары, не образующие одного дерева поиска (узел с двумя родителями, два левых или правых потомка,
+// несколько корней, цикл, нарушение порядка), приводят к исключению std::runtime_error
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator> BinarySearchTree<T, Balancing, Allocator>::fromNodeParentPairs(const std::vector<std::pair<T, T>>& pairs) {
+    BinarySearchTree<T, Balancing, Allocator> result;
+    if (pairs.empty()) return result;
     
-    // Удаляем квадратные скобки и пробелы
-    std::string data = str;
-    if (data.size() >= 2) {
-        data = data.substr(1, data.size() - 2);
+    // Узел i хранит pairs[i].first, узел n - корень
+    const size_t n = pairs.size();
+    ValueIndex children(n, [&pairs](size_t i) -> const T& { return pairs[i].first; });
+    if (children.hasDuplicates()) {
+        throw std::runtime_error("Узел встречается в списке пар несколько раз");
     }
     
-    // Разбиваем строку на элементы
-    size_t pos = 0;
-    std::string token;
-    while ((pos = data.find(", ")) != std::string::npos) {
-        token = data.substr(0, pos);
-        try {
-            T value = valueFromString<T>(token);
-            result.insert(value);
-        } catch (const std::exception& e) {
-            // Пропускаем элементы, которые не могут быть преобразованы
+    // Номер родителя каждого узла; значения, не найденные среди узлов, должны совпадать (это корень)
+    std::vector<size_t> parentOf(n);
+    const T* rootValue = nullptr;
+    for (size_t i = 0; i < n; ++i) {
+        const T& parentValue = pairs[i].second;
+        parentOf[i] = children.find(parentValue);
+        if (parentOf[i] != children.npos) continue;
+        
+        if (rootValue == nullptr) {
+            rootValue = &parentValue;
+        } else if (*rootValue < parentValue || parentValue < *rootValue) {
+            throw std::runtime_error("Список пар содержит несколько корней");
         }
-        data.erase(0, pos + 2);
+        parentOf[i] = n;
+    }
+    if (rootValue == nullptr) {
+        throw std::runtime_error("В списке пар нет корня: пары образуют цикл");
     }
     
-    // Обрабатываем последний элемент
-    if (!data.empty()) {
-        try {
-            T value = valueFromString<T>(data);
-            result.insert(value);
-        } catch (const std::exception& e) {
-            // Пропускаем элементы, которые не могут быть преобразованы
+    auto valueOf = [&](size_t i) -> const T& {
+        return i == n ? *rootValue : pairs[i].first;
+    };
+    
+    // Связывание по номерам: сторона потомка определяется сравнением с родителем
+    const size_t none = children.npos;
+    std::vector<size_t> leftOf(n + 1, none);
+    std::vector<size_t> rightOf(n + 1, none);
+    for (size_t i = 0; i < n; ++i) {
+        size_t parent = parentOf[i];
+        size_t* slot = nullptr;
+        if (valueOf(i) < valueOf(parent)) {
+            slot = &leftOf[parent];
+        } else if (valueOf(parent) < valueOf(i)) {
+            slot = &rightOf[parent];
+        } else {
+            throw std::runtime_error("Узел не может быть собственным родителем");
         }
+        if (*slot != none) {
+            throw std::runtime_error("У узла в списке пар два потомка с одной стороны");
+        }
+        *slot = i;
     }
     
+    // Симметричный обход от корня: значения должны строго возрастать, а от корня должны
+    // достигаться все узлы (иначе часть пар образует цикл). У каждого узла один родитель,
+    // поэтому узлы цикла от корня недостижимы и обход конечен
+    std::vector<size_t> inorder;
+    inorder.reserve(n + 1);
+    std::vector<size_t> path;
+    size_t current = n;
+    while (current != none || !path.empty()) {
+        while (current != none) {
+            path.push_back(current);
+            current = leftOf[current];
+        }
+        current = path.back();
+        path.pop_back();
+        if (!inorder.empty() && !(valueOf(inorder.back()) < valueOf(current))) {
+            throw std::runtime_error("Список пар нарушает порядок дерева поиска");
+        }
+        inorder.push_back(current);
+        current = rightOf[current];
+    }
+    if (inorder.size() != n + 1) {
+        throw std::runtime_error("Список пар не образует одного дерева: часть пар образует цикл");
+    }
+    
+    // Узлы создаются в порядке возрастания значений, чтобы обходы ниже шли по памяти подряд.
+    // До связывания узлы не принадлежат result, поэтому при ошибке они освобождаются здесь
+    std::vector<Node*> nodes(n + 1, nullptr);
+    try {
+        for (size_t i : inorder) {
+            nodes[i] = result.createNode(valueOf(i));
+        }
+    } catch (...) {
+        for (Node* node : nodes) {
+            if (node != nullptr) result.destroyNode(node);
+        }
+        throw;
+    }
+    for (size_t i = 0; i <= n; ++i) {
+        if (leftOf[i] != none) {
+            nodes[i]->left = nodes[leftOf[i]];
+            nodes[leftOf[i]]->parent = nodes[i];
+        }
+        if (rightOf[i] != none) {
+            nodes[i]->right = nodes[rightOf[i]];
+            nodes[rightOf[i]]->parent = nodes[i];
+        }
+    }
+    
+    result.root = nodes[n];
+    result.size = n + 1;
+    
+    // Высоты узлов вычисляются по готовой структуре
+    updateSubtree(result.root);
+    
+    // Произвольная структура из списка пар может нарушать АВЛ-инвариант
+    if constexpr (autoBalance) {
+        result.balance();
+    }
     return result;
 }
 
-// 1.5.2 Чтение из строки по обходу, задаваемому строкой форматирования
-template <typename T>
-BinarySearchTree<T> BinarySearchTree<T>::fromStringFormatted(const std::string& str, const std::string& format) {
-    BinarySearchTree<T> result;
-    if (str.empty() || format.empty()) return result;
+// 1.5.6 Сохранение двоичного снимка
+// Узлы записываются в префиксном порядке группами по 4: байт флагов (у i-го узла группы бит 2i -
+// есть левый потомок, бит 2i+1 - есть правый), затем элементы группы
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::saveSnapshot(std::ostream& out) const {
+    SnapshotWriter<T> writer(out);
+    writer.writeHeader(SnapshotKind::BinarySearchTree, size);
+    
+    Node* group[4];
+    size_t grouped = 0;
+    auto writeGroup = [&]() {
+        uint8_t flags = 0;
+        for (size_t i = 0; i < grouped; ++i) {
+            if (group[i]->left != nullptr) flags |= static_cast<uint8_t>(1u << (2 * i));
+            if (group[i]->right != nullptr) flags |= static_cast<uint8_t>(2u << (2 * i));
+        }
+        writer.writeByte(flags);
+        for (size_t i = 0; i < grouped; ++i) {
+            writer.writeElement(group[i]->data);
+        }
+        grouped = 0;
+    };
     
-    // Парсим строку форматирования и определяем тип обхода (может пригодиться для особой логики)
-    TraversalType type = TraversalType::InOrder; // По умолчанию
-    if (format == "{К}(Л)[П]") {
-        type = TraversalType::PreOrder;     // КЛП
-    } else if (format == "(Л){К}[П]") {
-        type = TraversalType::InOrder;      // ЛКП
-    } else if (format == "(Л)[П]{К}") {
-        type = TraversalType::PostOrder;    // ЛПК
-    } else if (format == "{К}[П](Л)") {
-        type = TraversalType::ReversePreOrder;  // КПЛ
-    } else if (format == "[П]{К}(Л)") {
-        type = TraversalType::ReverseInOrder;   // ПКЛ
-    } else if (format == "[П](Л){К}") {
-        type = TraversalType::ReversePostOrder; // ПЛК
+    // Префиксный обход с явным стеком
+    std::vector<Node*> stack;
+    if (root != nullptr) {
+        stack.push_back(root);
+    }
+    while (!stack.empty()) {
+        Node* node = stack.back();
+        stack.pop_back();
+        
+        group[grouped++] = node;
+        if (grouped == 4) {
+            writeGroup();
+        }
+        
+        if (node->right != nullptr) stack.push_back(node->right);
+        if (node->left != nullptr) stack.push_back(node->left);
+    }
+    if (grouped > 0) {
+        writeGroup();
     }
     
-    // Извлекаем все сегменты между {}, () и []
-    std::vector<std::string> segments;
-    for (size_t i = 0; i < str.size(); ++i) {
-        char open = str[i];
-        char close = 0;
-        if (open == '{') close = '}';
-        else if (open == '(') close = ')';
-        else if (open == '[') close = ']';
-        else continue;
-        size_t end = str.find(close, i + 1);
-        if (end == std::string::npos) break;
-        segments.emplace_back(str.substr(i + 1, end - i - 1));
-        i = end;
+    writer.flush();
+}
+
+// 1.5.7 Загрузка двоичного снимка
+// Структура восстанавливается по флагам потомков за O(n) без сравнения элементов
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator> BinarySearchTree<T, Balancing, Allocator>::loadSnapshot(std::istream& in) {
+    BinarySearchTree<T, Balancing, Allocator> result;
+    SnapshotReader<T> reader(in);
+    uint64_t count = reader.readHeader(SnapshotKind::BinarySearchTree);
+    
+    std::vector<Node*> order;         // Узлы в префиксном порядке
+    std::vector<Node*> pendingRight;  // Узлы, ожидающие правого потомка
+    Node* pendingLeft = nullptr;      // Узел, ожидающий левого потомка (следующий узел)
+    uint8_t flags = 0;
+    
+    // Созданные узлы сразу связываются с деревом, поэтому при исключении их освободит деструктор
+    for (uint64_t i = 0; i < count; ++i) {
+        if (i % 4 == 0) {
+            flags = reader.readByte();
+        }
+        unsigned nodeFlags = (flags >> (2 * (i % 4))) & 3u;
+        
+        Node* parent = pendingLeft;
+        if (i > 0 && parent == nullptr) {
+            if (pendingRight.empty()) {
+                throw std::runtime_error("Структура дерева в снимке повреждена");
+            }
+            parent = pendingRight.back();
+            pendingRight.pop_back();
+        }
+        
+        Node* node = result.createNode(reader.readElement(), parent);
+        if (parent == nullptr) {
+            result.root = node;
+        } else if (parent == pendingLeft) {
+            parent->left = node;
+        } else {
+            parent->right = node;
+        }
+        result.size++;
+        order.push_back(node);
+        
+        pendingLeft = (nodeFlags & 1u) ? node : nullptr;
+        if (nodeFlags & 2u) {
+            pendingRight.push_back(node);
+        }
+    }
+    if (pendingLeft != nullptr || !pendingRight.empty()) {
+        throw std::runtime_error("Структура дерева в снимке повреждена");
     }
     
-    // Вставляем значения в дерево
-    for (const auto& token : segments) {
-        try {
-            T value = valueFromString<T>(token);
-            result.insert(value);
-        } catch (const std::exception&) {
-            // пропускаем некорректные элементы
+    // Служебные поля пересчитываются от потомков к родителям (в обратном префиксном порядке)
+    bool balanced = true;
+    for (size_t i = order.size(); i-- > 0; ) {
+        Node* node = order[i];
+        updateNode(node);
+        if (std::abs(heightOf(node->left) - heightOf(node->right)) > 1) {
+            balanced = false;
         }
     }
     
-    return result;
-}
-
-// 1.5.3 Чтение из строки в формате списка пар «узел-родитель»
-template <typename T>
-BinarySearchTree<T> BinarySearchTree<T>::fromNodeParentPairs(const std::vector<std::pair<T, T>>& pairs) {
-    BinarySearchTree<T> result;
-    if (pairs.empty()) return result;
-    // Список узлов
-    std::vector<std::pair<T, Node*>> nodeList;
-    auto getNode = [&](const T& value) -> Node* {
-        for (auto& pr : nodeList) {
-            if (pr.first == value) return pr.second;
-        }
-        Node* n = new Node(value);
-        nodeList.emplace_back(value, n);
-        return n;
-    };
-    std::vector<T> children, parents;
-    // Создаем узлы и собираем значения
-    for (auto& pr : pairs) {
-        getNode(pr.first);
-        getNode(pr.second);
-        children.push_back(pr.first);
-        parents.push_back(pr.second);
-    }
-    // Находим корневое значение
-    T rootValue = parents[0];
-    for (T pv : parents) {
-        bool found = false;
-        for (T cv : children) {
-            if (cv == pv) { found = true; break; }
-        }
-        if (!found) { rootValue = pv; break; }
-    }
-    // Привязываем потомков к родителям
-    for (auto& pr : pairs) {
-        Node* child = getNode(pr.first);
-        Node* parent = getNode(pr.second);
-        child->parent = parent;
-        if (pr.first < pr.second) parent->left = child;
-        else parent->right = child;
+    // Снимок дерева без балансировки, загружаемый в AVL-дерево, балансируется заново
+    if (autoBalance && !balanced) {
+        result.balance();
     }
-    result.root = getNode(rootValue);
-    result.size = nodeList.size();
+    
     return result;
 }
 
 // 1.6 Извлечение поддерева (по заданному корню)
-template <typename T>
-BinarySearchTree<T> BinarySearchTree<T>::extractSubtree(const T& value) {
-    BinarySearchTree<T> result;
+template <typename T, typename Balancing, typename Allocator>
+BinarySearchTree<T, Balancing, Allocator> BinarySearchTree<T, Balancing, Allocator>::extractSubtree(const T& value) {
+    BinarySearchTree<T, Balancing, Allocator> result;
     
     // Находим узел, который будет корнем поддерева
     Node* subtreeRoot = findNode(root, value);
@@ -713,20 +1936,17 @@ BinarySearchTree<T> BinarySearchTree<T>::extractSubtree(const T& value) {
     }
     
     // Клонируем поддерево
-    result.root = cloneTree(subtreeRoot);
+    result.root = result.cloneTree(subtreeRoot);
     
-    // Подсчитываем размер поддерева
-    result.size = 0;
-    result.traverse(TraversalType::PreOrder, [&result](const T&) {
-        result.size++;
-    });
+    // Размер поддерева хранится в его корне
+    result.size = countOf(result.root);
     
     return result;
 }
 
 // 1.7 Поиск на вхождение поддерева
-template <typename T>
-bool BinarySearchTree<T>::areIdentical(Node* node1, Node* node2) const {
+template <typename T, typename Balancing, typename Allocator>
+bool BinarySearchTree<T, Balancing, Allocator>::areIdentical(Node* node1, Node* node2) const {
     // Если оба узла пусты, они идентичны
     if (node1 == nullptr && node2 == nullptr) {
         return true;
@@ -737,15 +1957,17 @@ bool BinarySearchTree<T>::areIdentical(Node* node1, Node* node2) const {
         return false;
     }
     
-    // Проверяем текущие узлы и рекурсивно их поддеревья
-    return (node1->data == node2->data) &&
+    // Поддеревья с разными структурными хешами заведомо различны; при равных хешах
+    // проверяем текущие узлы и рекурсивно их поддеревья
+    return node1->hash == node2->hash &&
+           (node1->data == node2->data) &&
            areIdentical(node1->left, node2->left) &&
            areIdentical(node1->right, node2->right);
 }
 
 // Поиск на вхождение поддерева
-template <typename T>
-bool BinarySearchTree<T>::isSubtree(Node* tree, Node* subtree) const {
+template <typename T, typename Balancing, typename Allocator>
+bool BinarySearchTree<T, Balancing, Allocator>::isSubtree(Node* tree, Node* subtree) const {
     // Пустое поддерево всегда является частью любого дерева
     if (subtree == nullptr) {
         return true;
@@ -766,8 +1988,8 @@ bool BinarySearchTree<T>::isSubtree(Node* tree, Node* subtree) const {
 }
 
 // 1.7 Поиск на вхождение поддерева
-template <typename T>
-bool BinarySearchTree<T>::containsSubtree(const BinarySearchTree<T>& subtree) const {
+template <typename T, typename Balancing, typename Allocator>
+bool BinarySearchTree<T, Balancing, Allocator>::containsSubtree(const BinarySearchTree<T, Balancing, Allocator>& subtree) const {
     if (subtree.root == nullptr) {
         return true; // Пустое поддерево всегда является частью любого дерева
     }
@@ -787,8 +2009,8 @@ bool BinarySearchTree<T>::containsSubtree(const BinarySearchTree<T>& subtree) co
 }
 
 // Вывод дерева в консоль (для отладки)
-template <typename T>
-void BinarySearchTree<T>::printTree() const {
+template <typename T, typename Balancing, typename Allocator>
+void BinarySearchTree<T, Balancing, Allocator>::printTree() const {
     if (root == nullptr) {
         std::cout << "Дерево пусто" << std::endl;
         return;
@@ -0,0 +1,253 @@
+#ifndef BINARY_SNAPSHOT_H
+#define BINARY_SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <algorithm>
+#include <limits>
+#include <type_traits>
+#include "data_types.h"
+
+// Двоичный снимок контейнера
+// Формат (все числа - в порядке байтов записавшей машины, он проверяется при чтении):
+//   "BSNP"            - сигнатура, 4 байта
+//   version           - версия формата, uint16
+//   byteOrder         - 0x0102, uint16
+//   kind              - вид контейнера (SnapshotKind), uint32
+//   typeCode          - код типа элемента (SnapshotTraits<T>::typeCode), uint32
+//   elementSize       - размер элемента в байтах, uint32
+//   count             - количество элементов, uint64
+// Далее следуют данные контейнера (см. saveSnapshot в BinarySearchTree и BinaryHeap).
+
+// Вид контейнера в снимке
+enum class SnapshotKind : uint32_t {
+    BinarySearchTree = 1, // Узлы в префиксном порядке группами по 4: байт флагов потомков, затем элементы
+    BinaryHeap = 2        // Элементы в уровневом порядке
+};
+
+// Код типа элемента для арифметических типов: вид (знаковый, беззнаковый, вещественный) и размер
+template <typename T>
+constexpr uint32_t arithmeticTypeCode() {
+    return (std::is_floating_point<T>::value ? 0x300u : std::is_signed<T>::value ? 0x100u : 0x200u)
+        + static_cast<uint32_t>(sizeof(T));
+}
+
+// Способ записи элемента в снимок
+// Снимок поддерживается только для типов с собственным кодом: арифметических и
+// явно специализированных ниже. Для прочих типов SnapshotTraits не определён, поэтому
+// снимок одной структуры нельзя прочитать как другую структуру того же размера.
+template <typename T, typename = void>
+struct SnapshotTraits;
+
+// Арифметические типы записываются байт в байт
+template <typename T>
+struct SnapshotTraits<T, typename std::enable_if<std::is_arithmetic<T>::value>::type> {
+    static constexpr uint32_t typeCode = arithmeticTypeCode<T>();
+    static constexpr size_t elementSize = sizeof(T);
+
+    static void store(const T& value, char* out) {
+        std::memcpy(out, &value, sizeof(T));
+    }
+
+    static T load(const char* in) {
+        T value{};
+        std::memcpy(&value, in, sizeof(T));
+        return value;
+    }
+};
+
+// Complex записывается как две величины double (действительная и мнимая части)
+template <>
+struct SnapshotTraits<Complex> {
+    static constexpr uint32_t typeCode = 0x400u;
+    static constexpr size_t elementSize = 2 * sizeof(double);
+
+    static void store(const Complex& value, char* out) {
+        double parts[2] = {value.real(), value.imag()};
+        std::memcpy(out, parts, sizeof(parts));
+    }
+
+    static Complex load(const char* in) {
+        double parts[2];
+        std::memcpy(parts, in, sizeof(parts));
+        return Complex(parts[0], parts[1]);
+    }
+};
+
+// PersonID записывается как две величины int (серия и номер)
+template <>
+struct SnapshotTraits<PersonID> {
+    static constexpr uint32_t typeCode = 0x500u;
+    static constexpr size_t elementSize = 2 * sizeof(int);
+
+    static void store(const PersonID& value, char* out) {
+        int parts[2] = {value.series, value.number};
+        std::memcpy(out, parts, sizeof(parts));
+    }
+
+    static PersonID load(const char* in) {
+        int parts[2];
+        std::memcpy(parts, in, sizeof(parts));
+        return PersonID{parts[0], parts[1]};
+    }
+};
+
+// Буферизованная запись снимка
+template <typename T>
+class SnapshotWriter {
+private:
+    using Traits = SnapshotTraits<T>;
+
+    std::ostream& out;  // Поток назначения
+    std::string buffer; // Ещё не записанные байты
+
+    template <typename Field>
+    void putField(Field value) {
+        buffer.append(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+public:
+    static constexpr uint16_t version = 1;
+    static constexpr size_t chunkSize = 64 * 1024;
+
+    explicit SnapshotWriter(std::ostream& out) : out(out), buffer() {
+        buffer.reserve(chunkSize + Traits::elementSize);
+    }
+
+    SnapshotWriter(const SnapshotWriter&) = delete;
+    SnapshotWriter& operator=(const SnapshotWriter&) = delete;
+
+    // Запись заголовка
+    void writeHeader(SnapshotKind kind, uint64_t count) {
+        buffer.append("BSNP", 4);
+        putField<uint16_t>(version);
+        putField<uint16_t>(0x0102);
+        putField<uint32_t>(static_cast<uint32_t>(kind));
+        putField<uint32_t>(Traits::typeCode);
+        putField<uint32_t>(static_cast<uint32_t>(Traits::elementSize));
+        putField<uint64_t>(count);
+    }
+
+    // Запись служебного байта
+    void writeByte(uint8_t value) {
+        buffer += static_cast<char>(value);
+        if (buffer.size() >= chunkSize) flush();
+    }
+
+    // Запись элемента
+    void writeElement(const T& value) {
+        size_t offset = buffer.size();
+        buffer.resize(offset + Traits::elementSize);
+        Traits::store(value, &buffer[offset]);
+        if (buffer.size() >= chunkSize) flush();
+    }
+
+    // Запись накопленных байтов в поток; при ошибке потока выбрасывается исключение
+    void flush() {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+        if (!out) {
+            throw std::runtime_error("Ошибка записи снимка в поток");
+        }
+    }
+};
+
+// Буферизованное чтение снимка
+// Из потока читается ровно столько байтов, сколько занимает снимок, поэтому за ним
+// в том же потоке могут следовать другие данные.
+// Любое несоответствие формата или преждевременный конец потока приводят к исключению
+template <typename T>
+class SnapshotReader {
+private:
+    using Traits = SnapshotTraits<T>;
+
+    std::istream& in;   // Поток источника
+    std::string buffer; // Прочитанные байты; разобранная часть - до pos
+    size_t pos;         // Начало неразобранной части буфера
+    uint64_t unread;    // Сколько байтов снимка ещё не прочитано из потока
+
+    // Обеспечение в буфере не менее bytes непрочитанных байтов
+    const char* take(size_t bytes) {
+        if (buffer.size() - pos < bytes) {
+            buffer.erase(0, pos);
+            pos = 0;
+            size_t oldSize = buffer.size();
+            uint64_t request = std::min<uint64_t>(std::max(bytes - oldSize, chunkSize), unread);
+            buffer.resize(oldSize + static_cast<size_t>(request));
+            in.read(&buffer[oldSize], static_cast<std::streamsize>(request));
+            buffer.resize(oldSize + static_cast<size_t>(in.gcount()));
+            unread -= static_cast<uint64_t>(in.gcount());
+            if (in.bad()) {
+                throw std::runtime_error("Ошибка чтения снимка из потока");
+            }
+            if (buffer.size() < bytes) {
+                throw std::runtime_error("Снимок обрывается раньше конца данных");
+            }
+        }
+        const char* result = buffer.data() + pos;
+        pos += bytes;
+        return result;
+    }
+
+    template <typename Field>
+    Field getField() {
+        Field value;
+        std::memcpy(&value, take(sizeof(value)), sizeof(value));
+        return value;
+    }
+
+public:
+    static constexpr size_t chunkSize = 64 * 1024;
+
+    static constexpr size_t headerSize = 28;
+
+    explicit SnapshotReader(std::istream& in) : in(in), buffer(), pos(0), unread(headerSize) {}
+
+    // Чтение и проверка заголовка; возвращает количество элементов
+    uint64_t readHeader(SnapshotKind kind) {
+        if (std::memcmp(take(4), "BSNP", 4) != 0) {
+            throw std::runtime_error("Поток не содержит двоичного снимка");
+        }
+        if (getField<uint16_t>() != SnapshotWriter<T>::version) {
+            throw std::runtime_error("Неподдерживаемая версия снимка");
+        }
+        if (getField<uint16_t>() != 0x0102) {
+            throw std::runtime_error("Снимок записан с другим порядком байтов");
+        }
+        if (getField<uint32_t>() != static_cast<uint32_t>(kind)) {
+            throw std::runtime_error("Снимок содержит контейнер другого вида");
+        }
+        uint32_t typeCode = getField<uint32_t>();
+        uint32_t elementSize = getField<uint32_t>();
+        if (typeCode != Traits::typeCode || elementSize != Traits::elementSize) {
+            throw std::runtime_error("Снимок содержит элементы другого типа");
+        }
+        uint64_t count = getField<uint64_t>();
+        
+        // Размер данных: элементы и, для дерева, байт флагов на каждые 4 узла
+        if (count > std::numeric_limits<uint64_t>::max() / 2 / Traits::elementSize) {
+            throw std::runtime_error("Некорректный размер снимка");
+        }
+        unread = count * Traits::elementSize;
+        if (kind == SnapshotKind::BinarySearchTree) {
+            unread += (count + 3) / 4;
+        }
+        return count;
+    }
+
+    // Чтение служебного байта
+    uint8_t readByte() {
+        return static_cast<uint8_t>(*take(1));
+    }
+
+    // Чтение элемента
+    T readElement() {
+        return Traits::load(take(Traits::elementSize));
+    }
+};
+
+#endif // BINARY_SNAPSHOT_H
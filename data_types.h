@@ -6,6 +6,15 @@
 #include <functional>
 #include <complex>
 #include <ctime>
+#include <sstream>
+#include <stdexcept>
+#include <charconv>
+#include <string_view>
+#include <system_error>
+#include <type_traits>
+#include <cctype>
+#include <cstdint>
+#include <utility>
 
 
 
@@ -199,9 +208,18 @@ protected:
 public:
     Person() : id{0, 0}, firstName(""), middleName(""), lastName(""), birthDate(0) {}
     
-    Person(const PersonID& pid, const std::string& first, const std::string& middle, 
-           const std::string& last, std::time_t birth)
-        : id(pid), firstName(first), middleName(middle), lastName(last), birthDate(birth) {}
+    // Строки принимаются по значению и перемещаются в поля
+    Person(const PersonID& pid, std::string first, std::string middle, 
+           std::string last, std::time_t birth)
+        : id(pid), firstName(std::move(first)), middleName(std::move(middle)), lastName(std::move(last)),
+          birthDate(birth) {}
+
+    // Объявленный ниже виртуальный деструктор подавляет неявное перемещение, поэтому оно задаётся явно:
+    // иначе перемещение Student и Teacher копировало бы строки базового класса
+    Person(const Person&) = default;
+    Person(Person&&) = default;
+    Person& operator=(const Person&) = default;
+    Person& operator=(Person&&) = default;
 
     // Геттеры
     PersonID GetID() const { return id; }
@@ -258,10 +276,11 @@ private:
 public:
     Student() : Person(), groupNumber(""), averageGrade(0.0) {}
     
-    Student(const PersonID& pid, const std::string& first, const std::string& middle, 
-            const std::string& last, std::time_t birth,
-            const std::string& group, double avgGrade)
-        : Person(pid, first, middle, last, birth), groupNumber(group), averageGrade(avgGrade) {}
+    Student(const PersonID& pid, std::string first, std::string middle, 
+            std::string last, std::time_t birth,
+            std::string group, double avgGrade)
+        : Person(pid, std::move(first), std::move(middle), std::move(last), birth),
+          groupNumber(std::move(group)), averageGrade(avgGrade) {}
 
     // Геттеры
     std::string GetGroupNumber() const { return groupNumber; }
@@ -294,10 +313,11 @@ private:
 public:
     Teacher() : Person(), department(""), position("") {}
     
-    Teacher(const PersonID& pid, const std::string& first, const std::string& middle, 
-            const std::string& last, std::time_t birth,
-            const std::string& dept, const std::string& pos)
-        : Person(pid, first, middle, last, birth), department(dept), position(pos) {}
+    Teacher(const PersonID& pid, std::string first, std::string middle, 
+            std::string last, std::time_t birth,
+            std::string dept, std::string pos)
+        : Person(pid, std::move(first), std::move(middle), std::move(last), birth),
+          department(std::move(dept)), position(std::move(pos)) {}
 
     // Геттеры
     std::string GetDepartment() const { return department; }
@@ -321,13 +341,48 @@ public:
     }
 };
 
+// Числовые типы, которые преобразуются через std::to_chars / std::from_chars
+// (bool и символьные типы выводятся потоком иначе, чем числа, поэтому исключены)
+template <typename T>
+struct IsCharsConvertible : std::integral_constant<bool,
+    std::is_arithmetic<T>::value
+    && !std::is_same<T, bool>::value
+    && !std::is_same<T, char>::value
+    && !std::is_same<T, signed char>::value
+    && !std::is_same<T, unsigned char>::value
+    && !std::is_same<T, wchar_t>::value
+    && !std::is_same<T, char16_t>::value
+    && !std::is_same<T, char32_t>::value> {};
+
+// Максимальная длина текстового представления числа (с запасом для double)
+constexpr size_t maxNumberChars = 64;
+
+// Запись числа в буфер [first, last) без выделения памяти и без учёта локали
+// Вещественные числа записываются так же, как их выводит поток по умолчанию (%g, 6 значащих цифр)
+// Возвращает указатель за последним записанным символом и код ошибки (если буфер мал)
+template <typename T>
+std::to_chars_result valueToChars(char* first, char* last, const T& value) {
+    static_assert(IsCharsConvertible<T>::value, "valueToChars поддерживает только числовые типы");
+    if constexpr (std::is_floating_point<T>::value) {
+        return std::to_chars(first, last, value, std::chars_format::general, 6);
+    } else {
+        return std::to_chars(first, last, value);
+    }
+}
+
 // Вспомогательная функция для преобразования значения в строку
 template <typename T>
 std::string valueToString(const T& value) {
-    // Для стандартных типов используем std::to_string или потоки
-    std::ostringstream ss;
-    ss << value;
-    return ss.str();
+    if constexpr (IsCharsConvertible<T>::value) {
+        char buffer[maxNumberChars];
+        auto result = valueToChars(buffer, buffer + maxNumberChars, value);
+        return std::string(buffer, result.ptr);
+    } else {
+        // Для остальных типов используем потоки
+        std::ostringstream ss;
+        ss << value;
+        return ss.str();
+    }
 }
 
 // Специализации для пользовательских типов
@@ -358,16 +413,62 @@ T valueFromString(const std::string& str) {
     throw std::runtime_error("Преобразование из строки не поддерживается для данного типа");
 }
 
+// Разбор числа без исключений, выделения памяти и учёта локали
+// Пробельные символы по краям и знак '+' допускаются; остальная строка должна быть числом целиком.
+// При ошибке (не число, лишние символы, выход за пределы типа) возвращает false, value не меняется
+template <typename T>
+bool numberFromChars(std::string_view str, T& value) {
+    static_assert(IsCharsConvertible<T>::value, "numberFromChars поддерживает только числовые типы");
+    
+    const char* first = str.data();
+    const char* last = first + str.size();
+    while (first != last && std::isspace(static_cast<unsigned char>(*first))) ++first;
+    while (last != first && std::isspace(static_cast<unsigned char>(*(last - 1)))) --last;
+    if (first != last && *first == '+' && last - first > 1 && first[1] != '-') ++first;
+    
+    T parsed{};
+    auto result = std::from_chars(first, last, parsed);
+    if (result.ec != std::errc() || result.ptr != last) {
+        return false;
+    }
+    value = parsed;
+    return true;
+}
+
+// Преобразование строки в значение без исключений: false, если строка некорректна
+// Для числовых типов используется std::from_chars, для остальных - valueFromString
+template <typename T>
+bool tryValueFromString(std::string_view str, T& value) {
+    if constexpr (IsCharsConvertible<T>::value) {
+        return numberFromChars(str, value);
+    } else {
+        try {
+            value = valueFromString<T>(std::string(str));
+            return true;
+        } catch (const std::exception&) {
+            return false;
+        }
+    }
+}
+
 // Специализация для int
 template <>
 inline int valueFromString<int>(const std::string& str) {
-    return std::stoi(str);
+    int value = 0;
+    if (!numberFromChars(str, value)) {
+        throw std::invalid_argument("Некорректное целое число: " + str);
+    }
+    return value;
 }
 
 // Специализация для double
 template <>
 inline double valueFromString<double>(const std::string& str) {
-    return std::stod(str);
+    double value = 0.0;
+    if (!numberFromChars(str, value)) {
+        throw std::invalid_argument("Некорректное вещественное число: " + str);
+    }
+    return value;
 }
 
 // Специализация для строк
@@ -428,6 +529,79 @@ inline Teacher valueFromString<Teacher>(const std::string& str) {
     return Teacher(id, "Jane", "M", "Smith", std::time(nullptr), "Math", "Professor");
 }
 
+// Запись значения в конец строки: числа записываются напрямую, без промежуточной строки
+template <typename T>
+void appendValue(std::string& out, const T& value) {
+    if constexpr (IsCharsConvertible<T>::value) {
+        char buffer[maxNumberChars];
+        auto result = valueToChars(buffer, buffer + maxNumberChars, value);
+        out.append(buffer, result.ptr);
+    } else {
+        out += valueToString(value);
+    }
+}
+
+// Перемешивание битов хеша (финализатор splitmix64)
+inline size_t mixHash(uint64_t h) {
+    h ^= h >> 30;
+    h *= 0xbf58476d1ce4e5b9ull;
+    h ^= h >> 27;
+    h *= 0x94d049bb133111ebull;
+    h ^= h >> 31;
+    return static_cast<size_t>(h);
+}
+
+// Доступна ли для типа стандартная хеш-функция std::hash
+template <typename T>
+struct IsStdHashable : std::is_default_constructible<std::hash<T>> {};
+
+// Хеш значения, согласованный с operator== (равные значения имеют равные хеши)
+// Для типов без std::hash и без специализации хеш постоянный: тогда структурные хеши
+// различают только форму деревьев, а значения сравнивает полная проверка
+template <typename T>
+size_t valueHash(const T& value) {
+    if constexpr (IsStdHashable<T>::value) {
+        return mixHash(std::hash<T>{}(value));
+    } else {
+        (void)value;
+        return 0;
+    }
+}
+
+template <>
+inline size_t valueHash(const Complex& value) {
+    return mixHash(valueHash(value.real()) ^ (valueHash(value.imag()) + 0x9e3779b97f4a7c15ull));
+}
+
+template <>
+inline size_t valueHash(const FunctionWrapper& value) {
+    return valueHash(value.getId());
+}
+
+template <>
+inline size_t valueHash(const PersonID& value) {
+    return mixHash(valueHash(value.series) ^ (valueHash(value.number) + 0x9e3779b97f4a7c15ull));
+}
+
+// Студенты и преподаватели сравниваются по идентификатору, поэтому и хешируются по нему
+template <>
+inline size_t valueHash(const Student& value) {
+    return valueHash(value.GetID());
+}
+
+template <>
+inline size_t valueHash(const Teacher& value) {
+    return valueHash(value.GetID());
+}
+
+// Структурный (меркловский) хеш поддерева по хешу значения корня и хешам его поддеревьев
+// Хеш пустого поддерева - 0. Равные по значениям и форме поддеревья имеют равные хеши
+inline size_t subtreeHash(size_t rootValueHash, size_t leftHash, size_t rightHash) {
+    uint64_t h = mixHash(rootValueHash + 0x9e3779b97f4a7c15ull);
+    h = mixHash(h ^ leftHash);
+    return mixHash(h + rightHash + 0x632be59bd9b4e019ull);
+}
+
 // Специализация для преобразования в строку и из строки для специальных типов
 namespace std {
     // Специализация to_string для комплексных чисел
@@ -0,0 +1,428 @@
+#ifndef INDEXED_HEAP_H
+#define INDEXED_HEAP_H
+
+#include <iostream>
+#include <string>
+#include <stdexcept>
+#include <functional>
+#include <vector>
+#include <sstream>
+#include <unordered_map>
+#include "data_types.h" // Включаем определения пользовательских типов
+
+// Шаблонный класс индексированной бинарной кучи (max heap по умолчанию)
+// Элементы хранятся в массиве в уровневом порядке вместе с дескрипторами - номерами,
+// которые не меняются, пока элемент находится в куче. Позиция элемента в массиве хранится
+// в отдельном массиве по дескриптору, поэтому обмен элементов при просеивании обновляет
+// две ячейки массива без обращений к хеш-таблице. Хеш-таблица связывает хеш значения
+// с дескриптором и меняется только при вставке и удалении; сами значения хранятся
+// один раз - в массиве кучи. Поиск выполняется за O(1), удаление и изменение приоритета - за O(log n).
+// Значения в куче уникальны (по operator== и Hash): повторная вставка игнорируется,
+// как и в BinarySearchTree. Это позволяет использовать значение как дескриптор задачи.
+template <typename T, typename Comparator = std::less<T>, typename Hash = std::hash<T>>
+class IndexedHeap {
+private:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+    
+    // Элемент кучи и его дескриптор
+    struct Entry {
+        T value;
+        size_t handle;
+    };
+    
+    std::vector<Entry> data;                           // Элементы кучи в уровневом порядке
+    std::vector<size_t> positions;                     // Позиция элемента по дескриптору; у свободного
+                                                       // дескриптора - следующий свободный дескриптор
+    size_t freeHandle;                                 // Начало списка свободных дескрипторов
+    std::unordered_multimap<size_t, size_t> handles;   // Дескрипторы по хешу значения
+    Comparator comp;                                   // Компаратор для определения порядка элементов
+    Hash hasher;                                       // Хеш-функция значений
+    
+    // Вычисление позиций по индексу
+    static size_t parentOf(size_t index) { return (index - 1) / 2; }
+    static size_t leftOf(size_t index) { return 2 * index + 1; }
+    
+    // Вспомогательные методы
+    
+    // Позиция значения в массиве или npos
+    size_t findPosition(const T& value) const;
+    
+    // Запись таблицы с заданным дескриптором для значения с хешем hash
+    typename std::unordered_multimap<size_t, size_t>::iterator findEntry(size_t hash, size_t handle);
+    
+    // Добавление значения в конец массива без восстановления свойства кучи
+    // При исключении куча остаётся прежней
+    void pushValue(const T& value, size_t hash);
+    
+    // Обмен элементов местами с обновлением их позиций
+    void swapValues(size_t a, size_t b);
+    
+    // Восстановление свойства кучи при добавлении элемента (просеивание вверх)
+    size_t heapifyUp(size_t index);
+    
+    // Восстановление свойства кучи при удалении элемента (просеивание вниз)
+    size_t heapifyDown(size_t index);
+    
+    // Удаление элемента по позиции; возвращает удалённое значение
+    T removeAt(size_t index);
+    
+    // Замена элемента на позиции новым значением с восстановлением свойства кучи
+    void replaceAt(size_t index, T value);
+
+public:
+    // Конструкторы и деструкторы
+    IndexedHeap();
+    
+    // Базовые операции
+    bool insert(const T& value);       // Вставка элемента (false, если значение уже есть)
+    bool search(const T& value) const; // Поиск элемента за O(1)
+    bool contains(const T& value) const; // То же, что search
+    bool remove(const T& value);       // Удаление элемента за O(log n)
+    T extractMax();                    // Извлечение максимального элемента (для max-heap)
+    T top() const;                     // Получение вершины кучи
+    
+    // Изменение приоритета за O(log n)
+    // Элемент, равный value (по operator== и Hash), заменяется на value
+    bool updatePriority(const T& value);
+    // Значение oldValue заменяется на newValue (false, если oldValue нет или newValue уже есть)
+    bool updatePriority(const T& oldValue, const T& newValue);
+    
+    // Дополнительные операции
+    bool isEmpty() const;              // Проверка на пустоту
+    size_t getSize() const;            // Получение размера кучи
+    void clear();                      // Очистка кучи
+    
+    // Построение кучи из набора значений за O(n); повторяющиеся значения пропускаются
+    void build(const std::vector<T>& values);
+    
+    // Сохранение в строку (уровневый обход)
+    std::string toString() const;
+    
+    // Обход кучи с вызовом функции обратного вызова для каждого элемента
+    void traverse(std::function<void(const T&)> callback) const;
+    
+    // Вывод кучи в консоль (для отладки)
+    void printHeap() const;
+};
+
+// Реализация методов класса IndexedHeap
+
+// Конструктор по умолчанию
+template <typename T, typename Comparator, typename Hash>
+IndexedHeap<T, Comparator, Hash>::IndexedHeap()
+    : data(), positions(), freeHandle(npos), handles(), comp(), hasher() {}
+
+// Проверка, пуста ли куча
+template <typename T, typename Comparator, typename Hash>
+bool IndexedHeap<T, Comparator, Hash>::isEmpty() const {
+    return data.empty();
+}
+
+// Получение размера кучи
+template <typename T, typename Comparator, typename Hash>
+size_t IndexedHeap<T, Comparator, Hash>::getSize() const {
+    return data.size();
+}
+
+// Очистка кучи
+template <typename T, typename Comparator, typename Hash>
+void IndexedHeap<T, Comparator, Hash>::clear() {
+    data.clear();
+    positions.clear();
+    freeHandle = npos;
+    handles.clear();
+}
+
+// Поиск позиции значения: среди дескрипторов с тем же хешем сравниваются сами значения
+template <typename T, typename Comparator, typename Hash>
+size_t IndexedHeap<T, Comparator, Hash>::findPosition(const T& value) const {
+    auto range = handles.equal_range(hasher(value));
+    for (auto it = range.first; it != range.second; ++it) {
+        size_t position = positions[it->second];
+        if (data[position].value == value) {
+            return position;
+        }
+    }
+    return npos;
+}
+
+template <typename T, typename Comparator, typename Hash>
+typename std::unordered_multimap<size_t, size_t>::iterator IndexedHeap<T, Comparator, Hash>::findEntry(size_t hash, size_t handle) {
+    auto range = handles.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == handle) {
+            return it;
+        }
+    }
+    return handles.end();
+}
+
+// Добавление значения: дескриптор берётся из списка свободных или выделяется новый.
+// Каждый шаг, который может выбросить исключение, откатывается, поэтому в таблице
+// не остаётся записей без элемента
+template <typename T, typename Comparator, typename Hash>
+void IndexedHeap<T, Comparator, Hash>::pushValue(const T& value, size_t hash) {
+    bool newHandle = freeHandle == npos;
+    size_t handle = newHandle ? positions.size() : freeHandle;
+    if (newHandle) {
+        positions.push_back(npos);
+    }
+    
+    try {
+        data.push_back(Entry{value, handle});
+        try {
+            handles.emplace(hash, handle);
+        } catch (...) {
+            data.pop_back();
+            throw;
+        }
+    } catch (...) {
+        if (newHandle) {
+            positions.pop_back();
+        }
+        throw;
+    }
+    
+    if (!newHandle) {
+        freeHandle = positions[handle];
+    }
+    positions[handle] = data.size() - 1;
+}
+
+// Обмен элементов местами с обновлением их позиций
+template <typename T, typename Comparator, typename Hash>
+void IndexedHeap<T, Comparator, Hash>::swapValues(size_t a, size_t b) {
+    std::swap(data[a], data[b]);
+    positions[data[a].handle] = a;
+    positions[data[b].handle] = b;
+}
+
+// Восстановление свойства кучи при добавлении элемента (просеивание вверх)
+// Возвращает итоговую позицию элемента
+template <typename T, typename Comparator, typename Hash>
+size_t IndexedHeap<T, Comparator, Hash>::heapifyUp(size_t index) {
+    while (index > 0) {
+        size_t parent = parentOf(index);
+        if (!comp(data[parent].value, data[index].value)) break;
+        swapValues(index, parent);
+        index = parent;
+    }
+    return index;
+}
+
+// Восстановление свойства кучи при удалении элемента (просеивание вниз)
+// Возвращает итоговую позицию элемента
+template <typename T, typename Comparator, typename Hash>
+size_t IndexedHeap<T, Comparator, Hash>::heapifyDown(size_t index) {
+    const size_t count = data.size();
+    while (true) {
+        size_t largest = index;
+        size_t left = leftOf(index);
+        size_t right = left + 1;
+        
+        if (left < count && comp(data[largest].value, data[left].value)) {
+            largest = left;
+        }
+        if (right < count && comp(data[largest].value, data[right].value)) {
+            largest = right;
+        }
+        
+        if (largest == index) break;
+        
+        swapValues(index, largest);
+        index = largest;
+    }
+    return index;
+}
+
+// Удаление элемента по позиции; дескриптор возвращается в список свободных без выделения памяти
+template <typename T, typename Comparator, typename Hash>
+T IndexedHeap<T, Comparator, Hash>::removeAt(size_t index) {
+    size_t handle = data[index].handle;
+    handles.erase(findEntry(hasher(data[index].value), handle));
+    positions[handle] = freeHandle;
+    freeHandle = handle;
+    
+    T result = std::move(data[index].value);
+    
+    // Заменяем удаляемый элемент последним
+    size_t last = data.size() - 1;
+    if (index != last) {
+        data[index] = std::move(data[last]);
+        data.pop_back();
+        positions[data[index].handle] = index;
+        
+        // Восстанавливаем свойство кучи
+        if (heapifyDown(index) == index) {
+            heapifyUp(index);
+        }
+    } else {
+        data.pop_back();
+    }
+    return result;
+}
+
+// Замена элемента на позиции новым значением с восстановлением свойства кучи
+template <typename T, typename Comparator, typename Hash>
+void IndexedHeap<T, Comparator, Hash>::replaceAt(size_t index, T value) {
+    bool increased = comp(data[index].value, value);
+    data[index].value = std::move(value);
+    
+    if (increased) {
+        heapifyUp(index);
+    } else {
+        heapifyDown(index);
+    }
+}
+
+// Вставка элемента в кучу
+template <typename T, typename Comparator, typename Hash>
+bool IndexedHeap<T, Comparator, Hash>::insert(const T& value) {
+    if (findPosition(value) != npos) {
+        return false; // Значение уже есть в куче
+    }
+    
+    pushValue(value, hasher(value));
+    heapifyUp(data.size() - 1);
+    return true;
+}
+
+// Поиск элемента в куче
+template <typename T, typename Comparator, typename Hash>
+bool IndexedHeap<T, Comparator, Hash>::search(const T& value) const {
+    return findPosition(value) != npos;
+}
+
+template <typename T, typename Comparator, typename Hash>
+bool IndexedHeap<T, Comparator, Hash>::contains(const T& value) const {
+    return search(value);
+}
+
+// Удаление элемента из кучи
+template <typename T, typename Comparator, typename Hash>
+bool IndexedHeap<T, Comparator, Hash>::remove(const T& value) {
+    size_t position = findPosition(value);
+    if (position == npos) return false;
+    
+    removeAt(position);
+    return true;
+}
+
+// Извлечение максимального элемента (для max-heap)
+template <typename T, typename Comparator, typename Hash>
+T IndexedHeap<T, Comparator, Hash>::extractMax() {
+    if (isEmpty()) {
+        throw std::runtime_error("Куча пуста");
+    }
+    
+    return removeAt(0);
+}
+
+// Получение вершины кучи
+template <typename T, typename Comparator, typename Hash>
+T IndexedHeap<T, Comparator, Hash>::top() const {
+    if (isEmpty()) {
+        throw std::runtime_error("Куча пуста");
+    }
+    
+    return data[0].value;
+}
+
+// Изменение приоритета элемента, равного value
+template <typename T, typename Comparator, typename Hash>
+bool IndexedHeap<T, Comparator, Hash>::updatePriority(const T& value) {
+    size_t position = findPosition(value);
+    if (position == npos) return false;
+    
+    // Хеш нового значения равен прежнему, поэтому запись таблицы остаётся прежней
+    replaceAt(position, value);
+    return true;
+}
+
+// Замена значения oldValue на newValue
+// Новое значение копируется и заносится в таблицу до изменения кучи, поэтому
+// при исключении куча остаётся прежней
+template <typename T, typename Comparator, typename Hash>
+bool IndexedHeap<T, Comparator, Hash>::updatePriority(const T& oldValue, const T& newValue) {
+    size_t position = findPosition(oldValue);
+    if (position == npos) return false;
+    if (oldValue == newValue) return updatePriority(newValue);
+    if (findPosition(newValue) != npos) return false;
+    
+    T value = newValue;
+    size_t handle = data[position].handle;
+    handles.emplace(hasher(newValue), handle);
+    handles.erase(findEntry(hasher(oldValue), handle));
+    replaceAt(position, std::move(value));
+    return true;
+}
+
+// Построение кучи из набора значений за O(n)
+template <typename T, typename Comparator, typename Hash>
+void IndexedHeap<T, Comparator, Hash>::build(const std::vector<T>& values) {
+    clear();
+    data.reserve(values.size());
+    positions.reserve(values.size());
+    handles.reserve(values.size());
+    
+    for (const auto& value : values) {
+        if (findPosition(value) == npos) {
+            pushValue(value, hasher(value));
+        }
+    }
+    
+    // Просеиваем вниз все внутренние узлы, начиная с последнего (метод Флойда)
+    for (size_t i = data.size() / 2; i-- > 0; ) {
+        heapifyDown(i);
+    }
+}
+
+// Сохранение в строку (уровневый обход)
+template <typename T, typename Comparator, typename Hash>
+std::string IndexedHeap<T, Comparator, Hash>::toString() const {
+    if (isEmpty()) return "[]";
+    
+    std::string result = "[";
+    for (size_t i = 0; i < data.size(); ++i) {
+        if (i > 0) result += ',';
+        appendValue(result, data[i].value);
+    }
+    result += ']';
+    return result;
+}
+
+// Обход кучи с вызовом функции обратного вызова для каждого элемента (уровневый обход)
+template <typename T, typename Comparator, typename Hash>
+void IndexedHeap<T, Comparator, Hash>::traverse(std::function<void(const T&)> callback) const {
+    if (!callback) return;
+    
+    for (const auto& entry : data) {
+        callback(entry.value);
+    }
+}
+
+// Вывод кучи в консоль (для отладки)
+template <typename T, typename Comparator, typename Hash>
+void IndexedHeap<T, Comparator, Hash>::printHeap() const {
+    if (isEmpty()) {
+        std::cout << "Куча пуста" << std::endl;
+        return;
+    }
+    
+    std::cout << "Индексированная куча (размер: " << data.size() << "):" << std::endl;
+    
+    size_t first = 0;
+    size_t width = 1;
+    for (int level = 0; first < data.size(); ++level) {
+        std::cout << "Уровень " << level << ": ";
+        size_t last = std::min(first + width, data.size());
+        for (size_t i = first; i < last; ++i) {
+            std::cout << valueToString(data[i].value) << " ";
+        }
+        std::cout << std::endl;
+        first = last;
+        width *= 2;
+    }
+}
+
+#endif // INDEXED_HEAP_H
@@ -62,7 +62,7 @@ public:
     void insert(const std::string& valueStr) override {
         try {
             T value = parseValue(valueStr);
-            tree.insert(value);
+            tree.insert(std::move(value));
         } catch (const std::exception& e) {
             std::cerr << "Ошибка при вставке: " << e.what() << std::endl;
         }
@@ -144,9 +144,21 @@ public:
     
     std::vector<std::string> getValuesByTraversal(TraversalType type) const override {
         std::vector<std::string> result;
-        auto values = tree.getValuesByTraversal(type);
-        for (const auto& value : values) {
-            result.push_back(valueToString(value));
+        result.reserve(tree.getSize());
+        
+        // Значения преобразуются в строки сразу при обходе, без промежуточной копии дерева
+        if (type == TraversalType::InOrder) {
+            for (const auto& value : tree) {
+                result.push_back(valueToString(value));
+            }
+        } else if (type == TraversalType::ReverseInOrder) {
+            for (auto it = tree.rbegin(); it != tree.rend(); ++it) {
+                result.push_back(valueToString(*it));
+            }
+        } else {
+            tree.traverse(type, [&result](const T& value) {
+                result.push_back(valueToString(value));
+            });
         }
         return result;
     }
@@ -157,7 +169,7 @@ public:
             auto subtree = tree.extractSubtree(value);
             
             auto result = std::make_shared<TreeWrapper<T>>();
-            result->tree = subtree;
+            result->tree = std::move(subtree);
             return result;
         } catch (const std::exception& e) {
             std::cerr << "Ошибка при извлечении поддерева: " << e.what() << std::endl;
@@ -212,10 +224,12 @@ std::shared_ptr<AbstractTreeWrapper> TreeWrapper<int>::map(const std::string& mu
 template<>
 std::string TreeWrapper<int>::reduce(const std::string& initialValueStr) const {
     try {
+        // Сложение ассоциативно, поэтому сумма считается параллельно по участкам дерева
         int initialValue = std::stoi(initialValueStr);
-        int result = tree.reduce([](const int& value, const int& acc) {
-            return value + acc;
-        }, initialValue);
+        auto plus = [](const int& a, const int& b) {
+            return a + b;
+        };
+        int result = initialValue + tree.reduce(plus, plus, 0, ExecutionMode::Parallel);
         
         return std::to_string(result);
     } catch (const std::exception& e) {
@@ -244,19 +258,16 @@ std::shared_ptr<AbstractTreeWrapper> TreeWrapper<int>::where(int filterType, con
                 
             case 3: // Больше значения
             {
+                // Подходящие элементы образуют непрерывный участок упорядоченного обхода
                 int threshold = std::stoi(valueStr);
-                result->tree = tree.where([threshold](const int& value) {
-                    return value > threshold;
-                });
+                result->tree = BinarySearchTree<int>::fromSorted(tree.upperBound(threshold), tree.end());
                 break;
             }
                 
             case 4: // Меньше значения
             {
                 int threshold = std::stoi(valueStr);
-                result->tree = tree.where([threshold](const int& value) {
-                    return value < threshold;
-                });
+                result->tree = BinarySearchTree<int>::fromSorted(tree.begin(), tree.lowerBound(threshold));
                 break;
             }
                 
@@ -638,24 +649,17 @@ int main() {
                                 
                                 // Парсим строку и заполняем дерево
                                 // Упрощенная версия: просто разбиваем строку по запятым
-                                size_t pos = 0;
-                                std::string token;
-                                std::string data = valueStr;
+                                std::string_view data = valueStr;
                                 
                                 // Удаляем квадратные скобки, если они есть
-                                if (data.size() >= 2 && data[0] == '[' && data[data.size() - 1] == ']') {
-                                    data = data.substr(1, data.size() - 2);
+                                if (data.size() >= 2 && data.front() == '[' && data.back() == ']') {
+                                    data = stripBrackets(data);
                                 }
                                 
-                                while ((pos = data.find(", ")) != std::string::npos) {
-                                    token = data.substr(0, pos);
-                                    newTree->insert(token);
-                                    data.erase(0, pos + 2);
-                                }
-                                
-                                // Добавляем последний элемент
-                                if (!data.empty()) {
-                                    newTree->insert(data);
+                                ValueTokenizer tokenizer(data, ", ");
+                                std::string_view token;
+                                while (tokenizer.next(token)) {
+                                    newTree->insert(std::string(token));
                                 }
                                 
                                 std::cout << "Создано дерево из строки:\n";
@@ -702,19 +706,10 @@ int main() {
                                 auto subtree = createTreeWrapper(currentType);
                                 
                                 // Парсим строку и заполняем дерево
-                                size_t pos = 0;
-                                std::string token;
-                                std::string data = valueStr;
-                                
-                                while ((pos = data.find(",")) != std::string::npos) {
-                                    token = data.substr(0, pos);
-                                    subtree->insert(token);
-                                    data.erase(0, pos + 1);
-                                }
-                                
-                                // Добавляем последний элемент
-                                if (!data.empty()) {
-                                    subtree->insert(data);
+                                ValueTokenizer tokenizer(valueStr, ",");
+                                std::string_view token;
+                                while (tokenizer.next(token)) {
+                                    subtree->insert(std::string(token));
                                 }
                                 
                                 std::cout << "Созданное поддерево:\n";
@@ -774,7 +769,7 @@ int main() {
                                     auto loaded = BinarySearchTree<int>::fromString(str);
                                     auto wrapperInt = std::dynamic_pointer_cast<TreeWrapper<int>>(tree);
                                     if (wrapperInt) {
-                                        wrapperInt->getTree() = loaded;
+                                        wrapperInt->getTree() = std::move(loaded);
                                         std::cout << "Дерево создано из строки.\n";
                                     }
                                 }
@@ -794,7 +789,7 @@ int main() {
                                     auto loaded = BinarySearchTree<int>::fromStringFormatted(str, formatStr);
                                     auto wrapperInt = std::dynamic_pointer_cast<TreeWrapper<int>>(tree);
                                     if (wrapperInt) {
-                                        wrapperInt->getTree() = loaded;
+                                        wrapperInt->getTree() = std::move(loaded);
                                         std::cout << "Дерево создано из отформатированной строки.\n";
                                     }
                                 }
@@ -807,24 +802,16 @@ int main() {
                                 std::cout << "Введите пары 'узел-родитель' через запятую (например 5-3,7-3,...): ";
                                 std::string pairsStr;
                                 std::getline(std::cin, pairsStr);
-                                {
-                                    std::vector<std::pair<int,int>> pairs;
-                                    std::stringstream ss(pairsStr);
-                                    std::string item;
-                                    while (std::getline(ss, item, ',')) {
-                                        size_t dashPos = item.find('-');
-                                        if (dashPos != std::string::npos) {
-                                            int node = std::stoi(item.substr(0, dashPos));
-                                            int parent = std::stoi(item.substr(dashPos + 1));
-                                            pairs.emplace_back(node, parent);
-                                        }
-                                    }
+                                try {
+                                    auto pairs = parseNodeParentPairs<int>(pairsStr);
                                     auto loaded = BinarySearchTree<int>::fromNodeParentPairs(pairs);
                                     auto wrapperInt = std::dynamic_pointer_cast<TreeWrapper<int>>(tree);
                                     if (wrapperInt) {
-                                        wrapperInt->getTree() = loaded;
+                                        wrapperInt->getTree() = std::move(loaded);
                                         std::cout << "Дерево создано из списка пар.\n";
                                     }
+                                } catch (const std::exception& e) {
+                                    std::cerr << "Ошибка при чтении списка пар: " << e.what() << std::endl;
                                 }
                                 waitForKeyPress();
                                 break;
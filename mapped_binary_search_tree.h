@@ -0,0 +1,483 @@
+#ifndef MAPPED_BINARY_SEARCH_TREE_H
+#define MAPPED_BINARY_SEARCH_TREE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+#include <functional>
+#include "binary_search_tree.h"
+#include "binary_snapshot.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Файл, отображённый в память только для чтения
+// Страницы отображения берутся из общего страничного кэша ОС, поэтому процессы,
+// открывшие один и тот же файл, не держат в памяти собственных копий.
+class MappedFile {
+private:
+    const char* data; // Начало отображения (nullptr для пустого файла)
+    size_t length;    // Размер файла
+#ifdef _WIN32
+    HANDLE file;
+    HANDLE mapping;
+#endif
+
+    void unmap() {
+#ifdef _WIN32
+        if (data != nullptr) UnmapViewOfFile(data);
+        if (mapping != nullptr) CloseHandle(mapping);
+        if (file != INVALID_HANDLE_VALUE) CloseHandle(file);
+        mapping = nullptr;
+        file = INVALID_HANDLE_VALUE;
+#else
+        if (data != nullptr) munmap(const_cast<char*>(data), length);
+#endif
+        data = nullptr;
+        length = 0;
+    }
+
+public:
+    explicit MappedFile(const std::string& path) : data(nullptr), length(0)
+#ifdef _WIN32
+        , file(INVALID_HANDLE_VALUE), mapping(nullptr)
+#endif
+    {
+#ifdef _WIN32
+        file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                           OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Не удалось открыть файл: " + path);
+        }
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(file, &fileSize)) {
+            unmap();
+            throw std::runtime_error("Не удалось определить размер файла: " + path);
+        }
+        length = static_cast<size_t>(fileSize.QuadPart);
+        if (length > 0) {
+            mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping == nullptr) {
+                unmap();
+                throw std::runtime_error("Не удалось отобразить файл в память: " + path);
+            }
+            data = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+            if (data == nullptr) {
+                unmap();
+                throw std::runtime_error("Не удалось отобразить файл в память: " + path);
+            }
+        }
+#else
+        int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0) {
+            throw std::runtime_error("Не удалось открыть файл: " + path);
+        }
+        struct stat status;
+        if (fstat(descriptor, &status) != 0) {
+            close(descriptor);
+            throw std::runtime_error("Не удалось определить размер файла: " + path);
+        }
+        length = static_cast<size_t>(status.st_size);
+        if (length > 0) {
+            void* address = mmap(nullptr, length, PROT_READ, MAP_SHARED, descriptor, 0);
+            if (address == MAP_FAILED) {
+                close(descriptor);
+                length = 0;
+                throw std::runtime_error("Не удалось отобразить файл в память: " + path);
+            }
+            data = static_cast<const char*>(address);
+        }
+        // Отображение остаётся действительным и после закрытия дескриптора
+        close(descriptor);
+#endif
+    }
+
+    ~MappedFile() {
+        unmap();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* begin() const { return data; }
+    size_t size() const { return length; }
+};
+
+// Дерево поиска только для чтения, работающее непосредственно над отображённым в память файлом
+// Файл создаётся статическим методом write по обычному дереву. Узлы хранятся в префиксном порядке,
+// а потомки задаются индексами, а не указателями, поэтому файл используется без разбора и выделения
+// памяти под узлы: открытие занимает O(1), страницы подгружаются по мере обращения.
+// Формат файла:
+//   заголовок (64 байта, см. Header), затем count узлов Node по nodeSize байт.
+//   Левый потомок узла i, если он есть, - узел i + 1; поддерево узла занимает непрерывный отрезок.
+// Тип T должен быть тривиально копируемым; файл читается на машине с тем же порядком байтов.
+template <typename T>
+class MappedBinarySearchTree {
+public:
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "MappedBinarySearchTree поддерживает только тривиально копируемые типы");
+
+    // Узел в файле
+    struct Node {
+        T data;         // Данные узла
+        uint32_t left;  // Индекс левого потомка или noChild
+        uint32_t right; // Индекс правого потомка или noChild
+    };
+
+    static constexpr uint32_t noChild = 0xFFFFFFFFu;
+    static constexpr uint16_t version = 1;
+
+private:
+    // Заголовок файла
+    struct Header {
+        char signature[4];    // "BSTM"
+        uint16_t version;     // Версия формата
+        uint16_t byteOrder;   // 0x0102 в порядке байтов записавшей машины
+        uint32_t typeCode;    // Код типа элемента (SnapshotTraits<T>::typeCode)
+        uint32_t elementSize; // sizeof(T)
+        uint32_t nodeSize;    // sizeof(Node)
+        uint32_t root;        // Индекс корня или noChild
+        uint64_t count;       // Количество узлов
+        uint8_t reserved[32]; // Дополняет заголовок до 64 байт (выравнивание узлов)
+    };
+
+    static_assert(sizeof(Header) == 64, "Размер заголовка должен быть 64 байта");
+    static_assert(alignof(Node) <= 64, "Узлы должны быть выровнены внутри отображения");
+
+    MappedFile file;    // Отображение файла
+    const Node* nodes;  // Узлы в префиксном порядке
+    uint32_t root;      // Индекс корня
+    size_t count;       // Количество узлов
+
+    // Узел по индексу с проверкой границ (защита от повреждённого файла)
+    const Node& nodeAt(uint32_t index) const {
+        if (index >= count) {
+            throw std::runtime_error("Файл дерева повреждён: индекс узла вне диапазона");
+        }
+        return nodes[index];
+    }
+
+    // Индекс узла со значением value или noChild
+    uint32_t findIndex(const T& value) const;
+
+    // Конец отрезка, занимаемого поддеревом узла index (индекс за последним узлом)
+    uint32_t subtreeEnd(uint32_t index) const;
+
+public:
+    // Открытие файла, созданного write; при несоответствии формата выбрасывается исключение
+    explicit MappedBinarySearchTree(const std::string& path);
+
+    MappedBinarySearchTree(const MappedBinarySearchTree&) = delete;
+    MappedBinarySearchTree& operator=(const MappedBinarySearchTree&) = delete;
+
+    // Запись дерева в файл в формате, пригодном для отображения в память
+    template <typename Balancing, typename Allocator>
+    static void write(const BinarySearchTree<T, Balancing, Allocator>& tree, std::ostream& out);
+    template <typename Balancing, typename Allocator>
+    static void write(const BinarySearchTree<T, Balancing, Allocator>& tree, const std::string& path);
+
+    // Базовые операции
+    bool search(const T& value) const;   // Поиск элемента
+    bool contains(const T& value) const; // То же, что search
+    bool isEmpty() const;                // Проверка на пустоту
+    size_t getSize() const;              // Получение размера дерева
+
+    // Обход дерева с вызовом функции обратного вызова для каждого элемента
+    template <typename F>
+    void traverse(TraversalType type, F&& callback) const;
+    void traverse(TraversalType type, std::function<void(const T&)> callback) const;
+
+    // Значения в порядке возрастания
+    std::vector<T> getValuesInOrder() const;
+
+    // Поиск на вхождение поддерева (те же правила, что у BinarySearchTree::containsSubtree)
+    // Поддерево в файле - непрерывный отрезок, поэтому сравнение идёт последовательно по памяти
+    template <typename Balancing, typename Allocator>
+    bool containsSubtree(const BinarySearchTree<T, Balancing, Allocator>& subtree) const;
+    bool containsSubtree(const MappedBinarySearchTree<T>& subtree) const;
+};
+
+// Реализация методов класса MappedBinarySearchTree
+
+template <typename T>
+MappedBinarySearchTree<T>::MappedBinarySearchTree(const std::string& path)
+    : file(path), nodes(nullptr), root(noChild), count(0) {
+    if (file.size() < sizeof(Header)) {
+        throw std::runtime_error("Файл не содержит отображаемого дерева: " + path);
+    }
+    Header header;
+    std::memcpy(&header, file.begin(), sizeof(Header));
+
+    if (std::memcmp(header.signature, "BSTM", 4) != 0) {
+        throw std::runtime_error("Файл не содержит отображаемого дерева: " + path);
+    }
+    if (header.version != version) {
+        throw std::runtime_error("Неподдерживаемая версия файла дерева");
+    }
+    if (header.byteOrder != 0x0102) {
+        throw std::runtime_error("Файл дерева записан с другим порядком байтов");
+    }
+    if (header.typeCode != SnapshotTraits<T>::typeCode || header.elementSize != sizeof(T)
+        || header.nodeSize != sizeof(Node)) {
+        throw std::runtime_error("Файл дерева содержит элементы другого типа");
+    }
+    if (header.count != (file.size() - sizeof(Header)) / sizeof(Node)
+        || (file.size() - sizeof(Header)) % sizeof(Node) != 0) {
+        throw std::runtime_error("Размер файла дерева не соответствует заголовку");
+    }
+    if (header.count == 0 ? header.root != noChild : header.root >= header.count) {
+        throw std::runtime_error("Файл дерева повреждён: некорректный корень");
+    }
+
+    nodes = reinterpret_cast<const Node*>(file.begin() + sizeof(Header));
+    root = header.root;
+    count = static_cast<size_t>(header.count);
+}
+
+// Запись дерева: значения берутся в префиксном порядке, связи восстанавливаются по ним за O(n)
+// стеком (в префиксном обходе дерева поиска структура однозначно задаётся порядком значений)
+template <typename T>
+template <typename Balancing, typename Allocator>
+void MappedBinarySearchTree<T>::write(const BinarySearchTree<T, Balancing, Allocator>& tree, std::ostream& out) {
+    if (tree.getSize() >= noChild) {
+        throw std::runtime_error("Слишком много узлов для отображаемого дерева");
+    }
+
+    std::vector<Node> layout;
+    layout.reserve(tree.getSize());
+    std::vector<uint32_t> stack; // Узлы, в правое поддерево которых ещё могут попасть значения
+    tree.traverse(TraversalType::PreOrder, [&layout, &stack](const T& value) {
+        uint32_t index = static_cast<uint32_t>(layout.size());
+        Node node;
+        std::memset(&node, 0, sizeof(Node)); // Байты выравнивания в файле всегда нулевые
+        node.data = value;
+        node.left = noChild;
+        node.right = noChild;
+        layout.push_back(node);
+
+        uint32_t parent = noChild;
+        while (!stack.empty() && layout[stack.back()].data < value) {
+            parent = stack.back();
+            stack.pop_back();
+        }
+        if (parent != noChild) {
+            layout[parent].right = index;
+        } else if (!stack.empty()) {
+            layout[stack.back()].left = index;
+        }
+        stack.push_back(index);
+    });
+
+    Header header;
+    std::memset(&header, 0, sizeof(Header));
+    std::memcpy(header.signature, "BSTM", 4);
+    header.version = version;
+    header.byteOrder = 0x0102;
+    header.typeCode = SnapshotTraits<T>::typeCode;
+    header.elementSize = sizeof(T);
+    header.nodeSize = sizeof(Node);
+    header.root = layout.empty() ? noChild : 0;
+    header.count = layout.size();
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(Header));
+    out.write(reinterpret_cast<const char*>(layout.data()), static_cast<std::streamsize>(layout.size() * sizeof(Node)));
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Ошибка записи файла дерева");
+    }
+}
+
+template <typename T>
+template <typename Balancing, typename Allocator>
+void MappedBinarySearchTree<T>::write(const BinarySearchTree<T, Balancing, Allocator>& tree, const std::string& path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Не удалось создать файл: " + path);
+    }
+    write(tree, out);
+}
+
+template <typename T>
+uint32_t MappedBinarySearchTree<T>::findIndex(const T& value) const {
+    uint32_t index = root;
+    size_t steps = 0;
+    while (index != noChild) {
+        const Node& node = nodeAt(index);
+        if (value < node.data) {
+            index = node.left;
+        } else if (node.data < value) {
+            index = node.right;
+        } else {
+            return index;
+        }
+        if (++steps > count) {
+            throw std::runtime_error("Файл дерева повреждён: цикл в структуре");
+        }
+    }
+    return noChild;
+}
+
+template <typename T>
+uint32_t MappedBinarySearchTree<T>::subtreeEnd(uint32_t index) const {
+    // Последний узел поддерева в префиксном порядке: спуск вправо, а при отсутствии правого - влево
+    size_t steps = 0;
+    while (true) {
+        const Node& node = nodeAt(index);
+        if (node.right != noChild) {
+            index = node.right;
+        } else if (node.left != noChild) {
+            index = node.left;
+        } else {
+            return index + 1;
+        }
+        if (++steps > count) {
+            throw std::runtime_error("Файл дерева повреждён: цикл в структуре");
+        }
+    }
+}
+
+template <typename T>
+bool MappedBinarySearchTree<T>::search(const T& value) const {
+    return findIndex(value) != noChild;
+}
+
+template <typename T>
+bool MappedBinarySearchTree<T>::contains(const T& value) const {
+    return search(value);
+}
+
+template <typename T>
+bool MappedBinarySearchTree<T>::isEmpty() const {
+    return count == 0;
+}
+
+template <typename T>
+size_t MappedBinarySearchTree<T>::getSize() const {
+    return count;
+}
+
+// Обход с явным стеком; для каждого узла хранится этап: 0 - не посещён, 1 - пройден первый потомок,
+// 2 - пройден второй потомок
+template <typename T>
+template <typename F>
+void MappedBinarySearchTree<T>::traverse(TraversalType type, F&& callback) const {
+    if (root == noChild) {
+        return;
+    }
+
+    bool reversed = type == TraversalType::ReversePreOrder
+        || type == TraversalType::ReverseInOrder
+        || type == TraversalType::ReversePostOrder;
+    bool preOrder = type == TraversalType::PreOrder || type == TraversalType::ReversePreOrder;
+    bool inOrder = type == TraversalType::InOrder || type == TraversalType::ReverseInOrder;
+
+    struct Frame {
+        uint32_t index;
+        uint8_t stage;
+    };
+    std::vector<Frame> stack;
+    stack.push_back({root, 0});
+    size_t visited = 0;
+
+    while (!stack.empty()) {
+        Frame& frame = stack.back();
+        const Node& node = nodeAt(frame.index);
+        uint32_t first = reversed ? node.right : node.left;
+        uint32_t second = reversed ? node.left : node.right;
+
+        if (frame.stage == 0) {
+            frame.stage = 1;
+            if (preOrder) {
+                if (++visited > count) throw std::runtime_error("Файл дерева повреждён: цикл в структуре");
+                callback(node.data);
+            }
+            if (first != noChild) stack.push_back({first, 0});
+        } else if (frame.stage == 1) {
+            frame.stage = 2;
+            if (inOrder) {
+                if (++visited > count) throw std::runtime_error("Файл дерева повреждён: цикл в структуре");
+                callback(node.data);
+            }
+            if (second != noChild) stack.push_back({second, 0});
+        } else {
+            if (!preOrder && !inOrder) {
+                if (++visited > count) throw std::runtime_error("Файл дерева повреждён: цикл в структуре");
+                callback(node.data);
+            }
+            stack.pop_back();
+        }
+    }
+}
+
+template <typename T>
+void MappedBinarySearchTree<T>::traverse(TraversalType type, std::function<void(const T&)> callback) const {
+    if (!callback) return;
+    traverse<std::function<void(const T&)>&>(type, callback);
+}
+
+template <typename T>
+std::vector<T> MappedBinarySearchTree<T>::getValuesInOrder() const {
+    std::vector<T> values;
+    values.reserve(count);
+    traverse(TraversalType::InOrder, [&values](const T& value) {
+        values.push_back(value);
+    });
+    return values;
+}
+
+// В дереве поиска одинаковая структура равносильна одинаковому префиксному обходу,
+// поэтому поддерево сравнивается как последовательность значений
+template <typename T>
+template <typename Balancing, typename Allocator>
+bool MappedBinarySearchTree<T>::containsSubtree(const BinarySearchTree<T, Balancing, Allocator>& subtree) const {
+    if (subtree.isEmpty()) {
+        return true; // Пустое поддерево всегда является частью любого дерева
+    }
+
+    std::vector<T> preOrder = subtree.getValuesByTraversal(TraversalType::PreOrder);
+    uint32_t first = findIndex(preOrder.front());
+    if (first == noChild || subtreeEnd(first) - first != preOrder.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < preOrder.size(); ++i) {
+        if (!(nodes[first + i].data == preOrder[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename T>
+bool MappedBinarySearchTree<T>::containsSubtree(const MappedBinarySearchTree<T>& subtree) const {
+    if (subtree.isEmpty()) {
+        return true;
+    }
+
+    uint32_t first = findIndex(subtree.nodes[subtree.root].data);
+    uint32_t subFirst = subtree.root;
+    uint32_t length = subtree.subtreeEnd(subFirst) - subFirst;
+    if (first == noChild || subtreeEnd(first) - first != length) {
+        return false;
+    }
+    for (uint32_t i = 0; i < length; ++i) {
+        if (!(nodes[first + i].data == subtree.nodes[subFirst + i].data)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+#endif // MAPPED_BINARY_SEARCH_TREE_H
@@ -0,0 +1,483 @@
+#ifndef PERSISTENT_BINARY_SEARCH_TREE_H
+#define PERSISTENT_BINARY_SEARCH_TREE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <stack>
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+#include "binary_search_tree.h"
+
+// Персистентное АВЛ-дерево поиска
+// Узлы после создания не изменяются и разделяются между копиями дерева через std::shared_ptr:
+// копия (снимок) создаётся за O(1), а вставка и удаление копируют только узлы на пути от корня
+// до изменённого места - O(log n) узлов; все остальные узлы остаются общими со снимками.
+// Снимок не меняется при последующих изменениях дерева, из которого он получен, поэтому его можно
+// читать из другого потока, пока дерево изменяется (счётчики ссылок std::shared_ptr атомарны).
+// Один и тот же объект дерева, как и другие контейнеры, нельзя одновременно изменять и читать.
+template <typename T>
+class PersistentBinarySearchTree {
+private:
+    struct Node;
+    using NodePtr = std::shared_ptr<const Node>;
+
+    // Неизменяемый узел дерева; служебные поля вычисляются при создании
+    struct Node {
+        T data;        // Данные узла
+        NodePtr left;  // Левое поддерево
+        NodePtr right; // Правое поддерево
+        int height;    // Высота поддерева (у листа 1)
+        size_t count;  // Количество узлов в поддереве
+        size_t hash;   // Структурный хеш поддерева (subtreeHash)
+
+        Node(const T& value, NodePtr left, NodePtr right);
+    };
+
+    NodePtr root; // Корень дерева
+
+    explicit PersistentBinarySearchTree(NodePtr root);
+
+    // Служебные поля поддерева (0 для пустого)
+    static int heightOf(const NodePtr& node);
+    static size_t countOf(const NodePtr& node);
+    static size_t hashOf(const NodePtr& node);
+
+    // Новый узел со значением value и поддеревьями left и right, высоты которых отличаются
+    // не более чем на 2; АВЛ-инвариант восстанавливается поворотом, создающим новые узлы
+    static NodePtr balanced(const T& value, NodePtr left, NodePtr right);
+
+    // Изменение поддерева с копированием пути; при отсутствии изменений возвращается тот же узел
+    static NodePtr insertInto(const NodePtr& node, const T& value, bool& inserted);
+    static NodePtr removeFrom(const NodePtr& node, const T& value, bool& removed);
+    static NodePtr removeMin(const NodePtr& node, T& minValue);
+
+    // Сбалансированное поддерево из строго возрастающих values[first, last)
+    static NodePtr buildBalanced(const std::vector<T>& values, size_t first, size_t last);
+
+    // Дерево из значений в произвольном порядке: неупорядоченные значения сортируются, повторы отбрасываются
+    static PersistentBinarySearchTree<T> buildFromValues(std::vector<T>& values);
+
+    // Узел со значением value или nullptr
+    const NodePtr* findNode(const T& value) const;
+
+    // Сравнение поддеревьев: сначала структурные хеши, затем значения
+    static bool areIdentical(const Node* node1, const Node* node2);
+
+public:
+    PersistentBinarySearchTree();
+
+    // Копирование и присваивание разделяют узлы и выполняются за O(1)
+    PersistentBinarySearchTree(const PersistentBinarySearchTree&) = default;
+    PersistentBinarySearchTree& operator=(const PersistentBinarySearchTree&) = default;
+
+    // Базовые операции; вставка и удаление создают O(log n) новых узлов
+    void insert(const T& value);       // Вставка элемента
+    bool search(const T& value) const; // Поиск элемента
+    bool remove(const T& value);       // Удаление элемента
+
+    // Дополнительные операции
+    bool isEmpty() const;              // Проверка на пустоту
+    size_t getSize() const;            // Получение размера дерева
+    int getHeight() const;             // Получение высоты дерева
+    void clear();                      // Очистка дерева (снимки не затрагиваются)
+
+    // Снимок текущего состояния за O(1)
+    PersistentBinarySearchTree<T> snapshot() const;
+
+    // Порядковые статистики за O(log n)
+    const T& select(size_t k) const;   // k-й по возрастанию элемент (нумерация с 0)
+    size_t rank(const T& value) const; // Количество элементов, меньших value
+
+    // Извлечение поддерева за O(log n): узлы поддерева не копируются, а разделяются с деревом
+    PersistentBinarySearchTree<T> extractSubtree(const T& value) const;
+
+    // Поиск на вхождение поддерева (те же правила, что у BinarySearchTree::containsSubtree)
+    bool containsSubtree(const PersistentBinarySearchTree<T>& subtree) const;
+
+    // map и where: результат строится заново из отсортированных значений (O(n log n) и O(n))
+    template <typename F>
+    PersistentBinarySearchTree<T> map(F func) const;
+    template <typename F>
+    PersistentBinarySearchTree<T> where(F predicate) const;
+
+    // Обход в порядке возрастания без рекурсии
+    template <typename F>
+    void forEachInOrder(F&& callback) const;
+
+    // Значения в порядке возрастания и строка в формате BinarySearchTree::toString
+    std::vector<T> getValuesInOrder() const;
+    std::string toString() const;
+
+    // Построение сбалансированного дерева за O(n) из возрастающей последовательности
+    // (иначе значения сортируются за O(n log n), повторы отбрасываются)
+    template <typename InputIt>
+    static PersistentBinarySearchTree<T> fromSorted(InputIt first, InputIt last);
+
+    // Преобразование из обычного дерева и обратно за O(n)
+    template <typename Balancing, typename Allocator>
+    static PersistentBinarySearchTree<T> fromTree(const BinarySearchTree<T, Balancing, Allocator>& tree);
+    template <typename Balancing = AVLBalanced>
+    BinarySearchTree<T, Balancing> toTree() const;
+};
+
+// Реализация методов класса PersistentBinarySearchTree
+
+template <typename T>
+PersistentBinarySearchTree<T>::Node::Node(const T& value, NodePtr left, NodePtr right)
+    : data(value), left(std::move(left)), right(std::move(right)),
+      height(1 + std::max(heightOf(this->left), heightOf(this->right))),
+      count(1 + countOf(this->left) + countOf(this->right)),
+      hash(subtreeHash(valueHash(value), hashOf(this->left), hashOf(this->right))) {}
+
+template <typename T>
+PersistentBinarySearchTree<T>::PersistentBinarySearchTree() : root(nullptr) {}
+
+template <typename T>
+PersistentBinarySearchTree<T>::PersistentBinarySearchTree(NodePtr root) : root(std::move(root)) {}
+
+template <typename T>
+int PersistentBinarySearchTree<T>::heightOf(const NodePtr& node) {
+    return node ? node->height : 0;
+}
+
+template <typename T>
+size_t PersistentBinarySearchTree<T>::countOf(const NodePtr& node) {
+    return node ? node->count : 0;
+}
+
+template <typename T>
+size_t PersistentBinarySearchTree<T>::hashOf(const NodePtr& node) {
+    return node ? node->hash : 0;
+}
+
+// Балансировка копированием: вместо поворота существующих узлов создаются 2-3 новых
+template <typename T>
+typename PersistentBinarySearchTree<T>::NodePtr PersistentBinarySearchTree<T>::balanced(const T& value, NodePtr left, NodePtr right) {
+    int leftHeight = heightOf(left);
+    int rightHeight = heightOf(right);
+
+    if (leftHeight > rightHeight + 1) {
+        if (heightOf(left->left) >= heightOf(left->right)) {
+            // Правый поворот
+            return std::make_shared<const Node>(left->data, left->left,
+                                                std::make_shared<const Node>(value, left->right, std::move(right)));
+        }
+        // Большой правый поворот (лево-правый случай)
+        const NodePtr& pivot = left->right;
+        return std::make_shared<const Node>(pivot->data,
+                                            std::make_shared<const Node>(left->data, left->left, pivot->left),
+                                            std::make_shared<const Node>(value, pivot->right, std::move(right)));
+    }
+
+    if (rightHeight > leftHeight + 1) {
+        if (heightOf(right->right) >= heightOf(right->left)) {
+            // Левый поворот
+            return std::make_shared<const Node>(right->data,
+                                                std::make_shared<const Node>(value, std::move(left), right->left),
+                                                right->right);
+        }
+        // Большой левый поворот (право-левый случай)
+        const NodePtr& pivot = right->left;
+        return std::make_shared<const Node>(pivot->data,
+                                            std::make_shared<const Node>(value, std::move(left), pivot->left),
+                                            std::make_shared<const Node>(right->data, pivot->right, right->right));
+    }
+
+    return std::make_shared<const Node>(value, std::move(left), std::move(right));
+}
+
+// Вставка копированием пути; глубина рекурсии равна высоте дерева, т.е. O(log n)
+template <typename T>
+typename PersistentBinarySearchTree<T>::NodePtr PersistentBinarySearchTree<T>::insertInto(const NodePtr& node, const T& value, bool& inserted) {
+    if (!node) {
+        inserted = true;
+        return std::make_shared<const Node>(value, nullptr, nullptr);
+    }
+    if (value < node->data) {
+        NodePtr left = insertInto(node->left, value, inserted);
+        return inserted ? balanced(node->data, std::move(left), node->right) : node;
+    }
+    if (node->data < value) {
+        NodePtr right = insertInto(node->right, value, inserted);
+        return inserted ? balanced(node->data, node->left, std::move(right)) : node;
+    }
+    inserted = false; // Значение уже есть в дереве
+    return node;
+}
+
+// Удаление копированием пути
+template <typename T>
+typename PersistentBinarySearchTree<T>::NodePtr PersistentBinarySearchTree<T>::removeFrom(const NodePtr& node, const T& value, bool& removed) {
+    if (!node) {
+        removed = false;
+        return node;
+    }
+    if (value < node->data) {
+        NodePtr left = removeFrom(node->left, value, removed);
+        return removed ? balanced(node->data, std::move(left), node->right) : node;
+    }
+    if (node->data < value) {
+        NodePtr right = removeFrom(node->right, value, removed);
+        return removed ? balanced(node->data, node->left, std::move(right)) : node;
+    }
+
+    removed = true;
+    if (!node->left) return node->right;
+    if (!node->right) return node->left;
+
+    // Узел с двумя потомками заменяется новым узлом со значением преемника
+    T successor = node->data;
+    NodePtr right = removeMin(node->right, successor);
+    return balanced(successor, node->left, std::move(right));
+}
+
+// Удаление наименьшего элемента поддерева; его значение записывается в minValue
+template <typename T>
+typename PersistentBinarySearchTree<T>::NodePtr PersistentBinarySearchTree<T>::removeMin(const NodePtr& node, T& minValue) {
+    if (!node->left) {
+        minValue = node->data;
+        return node->right;
+    }
+    NodePtr left = removeMin(node->left, minValue);
+    return balanced(node->data, std::move(left), node->right);
+}
+
+template <typename T>
+typename PersistentBinarySearchTree<T>::NodePtr PersistentBinarySearchTree<T>::buildBalanced(const std::vector<T>& values, size_t first, size_t last) {
+    if (first == last) {
+        return nullptr;
+    }
+    size_t middle = first + (last - first) / 2;
+    return std::make_shared<const Node>(values[middle], buildBalanced(values, first, middle),
+                                        buildBalanced(values, middle + 1, last));
+}
+
+template <typename T>
+PersistentBinarySearchTree<T> PersistentBinarySearchTree<T>::buildFromValues(std::vector<T>& values) {
+    auto less = [](const T& a, const T& b) { return a < b; };
+    if (std::adjacent_find(values.begin(), values.end(), [](const T& a, const T& b) { return !(a < b); }) != values.end()) {
+        std::stable_sort(values.begin(), values.end(), less);
+        values.erase(std::unique(values.begin(), values.end(), [](const T& a, const T& b) {
+            return !(a < b) && !(b < a);
+        }), values.end());
+    }
+    return PersistentBinarySearchTree<T>(buildBalanced(values, 0, values.size()));
+}
+
+template <typename T>
+const typename PersistentBinarySearchTree<T>::NodePtr* PersistentBinarySearchTree<T>::findNode(const T& value) const {
+    const NodePtr* current = &root;
+    while (*current) {
+        if (value < (*current)->data) {
+            current = &(*current)->left;
+        } else if ((*current)->data < value) {
+            current = &(*current)->right;
+        } else {
+            return current;
+        }
+    }
+    return nullptr;
+}
+
+template <typename T>
+bool PersistentBinarySearchTree<T>::areIdentical(const Node* node1, const Node* node2) {
+    // Общий узел идентичен сам себе без сравнения поддеревьев
+    if (node1 == node2) return true;
+    if (!node1 || !node2) return false;
+
+    return node1->hash == node2->hash &&
+           node1->data == node2->data &&
+           areIdentical(node1->left.get(), node2->left.get()) &&
+           areIdentical(node1->right.get(), node2->right.get());
+}
+
+// Базовые операции
+
+template <typename T>
+void PersistentBinarySearchTree<T>::insert(const T& value) {
+    bool inserted = false;
+    root = insertInto(root, value, inserted);
+}
+
+template <typename T>
+bool PersistentBinarySearchTree<T>::search(const T& value) const {
+    return findNode(value) != nullptr;
+}
+
+template <typename T>
+bool PersistentBinarySearchTree<T>::remove(const T& value) {
+    bool removed = false;
+    root = removeFrom(root, value, removed);
+    return removed;
+}
+
+template <typename T>
+bool PersistentBinarySearchTree<T>::isEmpty() const {
+    return !root;
+}
+
+template <typename T>
+size_t PersistentBinarySearchTree<T>::getSize() const {
+    return countOf(root);
+}
+
+template <typename T>
+int PersistentBinarySearchTree<T>::getHeight() const {
+    return heightOf(root);
+}
+
+template <typename T>
+void PersistentBinarySearchTree<T>::clear() {
+    root.reset();
+}
+
+template <typename T>
+PersistentBinarySearchTree<T> PersistentBinarySearchTree<T>::snapshot() const {
+    return *this;
+}
+
+// Порядковые статистики
+
+template <typename T>
+const T& PersistentBinarySearchTree<T>::select(size_t k) const {
+    if (k >= getSize()) {
+        throw std::runtime_error("Номер элемента выходит за пределы дерева");
+    }
+    const Node* node = root.get();
+    while (true) {
+        size_t leftCount = countOf(node->left);
+        if (k < leftCount) {
+            node = node->left.get();
+        } else if (k == leftCount) {
+            return node->data;
+        } else {
+            k -= leftCount + 1;
+            node = node->right.get();
+        }
+    }
+}
+
+template <typename T>
+size_t PersistentBinarySearchTree<T>::rank(const T& value) const {
+    size_t result = 0;
+    const Node* node = root.get();
+    while (node) {
+        if (node->data < value) {
+            result += countOf(node->left) + 1;
+            node = node->right.get();
+        } else {
+            node = node->left.get();
+        }
+    }
+    return result;
+}
+
+// Извлечение и поиск поддерева
+
+template <typename T>
+PersistentBinarySearchTree<T> PersistentBinarySearchTree<T>::extractSubtree(const T& value) const {
+    const NodePtr* node = findNode(value);
+    return node ? PersistentBinarySearchTree<T>(*node) : PersistentBinarySearchTree<T>();
+}
+
+template <typename T>
+bool PersistentBinarySearchTree<T>::containsSubtree(const PersistentBinarySearchTree<T>& subtree) const {
+    if (!subtree.root) {
+        return true; // Пустое поддерево всегда является частью любого дерева
+    }
+    // Значения в дереве поиска уникальны, поэтому кандидат - единственный узел со значением корня поддерева
+    const NodePtr* node = findNode(subtree.root->data);
+    return node && areIdentical(node->get(), subtree.root.get());
+}
+
+// map и where
+
+template <typename T>
+template <typename F>
+PersistentBinarySearchTree<T> PersistentBinarySearchTree<T>::map(F func) const {
+    std::vector<T> values;
+    values.reserve(getSize());
+    forEachInOrder([&values, &func](const T& value) { values.push_back(func(value)); });
+    return buildFromValues(values);
+}
+
+template <typename T>
+template <typename F>
+PersistentBinarySearchTree<T> PersistentBinarySearchTree<T>::where(F predicate) const {
+    std::vector<T> values;
+    forEachInOrder([&values, &predicate](const T& value) {
+        if (predicate(value)) {
+            values.push_back(value);
+        }
+    });
+    return PersistentBinarySearchTree<T>(buildBalanced(values, 0, values.size()));
+}
+
+// Обход и преобразование в строку
+
+template <typename T>
+template <typename F>
+void PersistentBinarySearchTree<T>::forEachInOrder(F&& callback) const {
+    std::stack<const Node*> path;
+    const Node* current = root.get();
+    while (current || !path.empty()) {
+        while (current) {
+            path.push(current);
+            current = current->left.get();
+        }
+        current = path.top();
+        path.pop();
+        callback(current->data);
+        current = current->right.get();
+    }
+}
+
+template <typename T>
+std::vector<T> PersistentBinarySearchTree<T>::getValuesInOrder() const {
+    std::vector<T> values;
+    values.reserve(getSize());
+    forEachInOrder([&values](const T& value) { values.push_back(value); });
+    return values;
+}
+
+template <typename T>
+std::string PersistentBinarySearchTree<T>::toString() const {
+    std::string result = "[";
+    bool first = true;
+    forEachInOrder([&result, &first](const T& value) {
+        if (!first) {
+            result += ", ";
+        }
+        appendValue(result, value);
+        first = false;
+    });
+    result += ']';
+    return result;
+}
+
+// Построение и преобразование
+
+template <typename T>
+template <typename InputIt>
+PersistentBinarySearchTree<T> PersistentBinarySearchTree<T>::fromSorted(InputIt first, InputIt last) {
+    std::vector<T> values(first, last);
+    return buildFromValues(values);
+}
+
+template <typename T>
+template <typename Balancing, typename Allocator>
+PersistentBinarySearchTree<T> PersistentBinarySearchTree<T>::fromTree(const BinarySearchTree<T, Balancing, Allocator>& tree) {
+    std::vector<T> values(tree.begin(), tree.end());
+    return PersistentBinarySearchTree<T>(buildBalanced(values, 0, values.size()));
+}
+
+template <typename T>
+template <typename Balancing>
+BinarySearchTree<T, Balancing> PersistentBinarySearchTree<T>::toTree() const {
+    std::vector<T> values = getValuesInOrder();
+    return BinarySearchTree<T, Balancing>::fromSorted(values.begin(), values.end());
+}
+
+#endif // PERSISTENT_BINARY_SEARCH_TREE_H
@@ -0,0 +1,215 @@
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <memory>
+#include <vector>
+#include <type_traits>
+#include <utility>
+
+// Пул памяти для узлов контейнеров
+// Память выделяется крупными блоками (слэбами), внутри блока объекты размещаются подряд,
+// поэтому соседние узлы попадают в общие кэш-линии и не несут служебных заголовков malloc.
+// Освобождённые объекты попадают в список свободных ячеек своего размера и используются повторно.
+// release() возвращает все блоки разом - за время, пропорциональное числу блоков, а не объектов.
+class NodePool {
+private:
+    // Свободная ячейка хранит указатель на следующую свободную ячейку того же размера
+    struct FreeCell {
+        FreeCell* next;
+    };
+
+    // Список свободных ячеек одного размера
+    struct FreeList {
+        size_t bytes;
+        FreeCell* head;
+    };
+
+    static constexpr size_t initialSlabBytes = 4096;      // Размер первого блока
+    static constexpr size_t maxSlabBytes = 1024 * 1024;   // Предельный размер блока
+
+    std::vector<void*> slabs;        // Все выделенные блоки
+    std::vector<FreeList> freeLists; // Списки свободных ячеек по размерам
+    char* current;                   // Начало свободной части текущего блока
+    char* end;                       // Конец текущего блока
+    size_t nextSlabBytes;            // Размер следующего блока
+    size_t live;                     // Количество выделенных и ещё не освобождённых объектов
+
+    // Размер ячейки с учётом выравнивания и места под указатель списка свободных ячеек
+    static size_t cellSize(size_t bytes) noexcept {
+        const size_t align = alignof(std::max_align_t);
+        if (bytes < sizeof(FreeCell)) bytes = sizeof(FreeCell);
+        return (bytes + align - 1) / align * align;
+    }
+
+    // Поиск списка свободных ячеек заданного размера без выделения памяти
+    FreeList* findFreeList(size_t bytes) noexcept {
+        for (auto& list : freeLists) {
+            if (list.bytes == bytes) return &list;
+        }
+        return nullptr;
+    }
+
+    // Список создаётся при первом выделении ячейки своего размера,
+    // поэтому к моменту её возврата он уже существует
+    FreeList& freeListFor(size_t bytes) {
+        FreeList* list = findFreeList(bytes);
+        if (list != nullptr) return *list;
+        freeLists.push_back({bytes, nullptr});
+        return freeLists.back();
+    }
+
+    // Выделение нового блока, вмещающего хотя бы одну ячейку заданного размера
+    void addSlab(size_t bytes) {
+        size_t slabBytes = nextSlabBytes;
+        while (slabBytes < bytes) slabBytes *= 2;
+
+        void* slab = std::malloc(slabBytes);
+        if (slab == nullptr) throw std::bad_alloc();
+        slabs.push_back(slab);
+
+        current = static_cast<char*>(slab);
+        end = current + slabBytes;
+        if (nextSlabBytes < maxSlabBytes) nextSlabBytes *= 2;
+    }
+
+public:
+    NodePool() : slabs(), freeLists(), current(nullptr), end(nullptr),
+                 nextSlabBytes(initialSlabBytes), live(0) {}
+
+    NodePool(const NodePool&) = delete;
+    NodePool& operator=(const NodePool&) = delete;
+
+    ~NodePool() {
+        release();
+    }
+
+    // Выделение памяти под объект размера bytes
+    void* allocate(size_t bytes) {
+        bytes = cellSize(bytes);
+
+        FreeList& list = freeListFor(bytes);
+        if (list.head != nullptr) {
+            FreeCell* cell = list.head;
+            list.head = cell->next;
+            ++live;
+            return cell;
+        }
+
+        if (current == nullptr || static_cast<size_t>(end - current) < bytes) {
+            addSlab(bytes);
+        }
+        void* result = current;
+        current += bytes;
+        ++live;
+        return result;
+    }
+
+    // Возврат ячейки в список свободных; память при этом не выделяется
+    // Ячейка, выделенная не этим пулом, в списки не попадает
+    void deallocate(void* pointer, size_t bytes) noexcept {
+        bytes = cellSize(bytes);
+        FreeList* list = findFreeList(bytes);
+        if (list == nullptr) return;
+        FreeCell* cell = static_cast<FreeCell*>(pointer);
+        cell->next = list->head;
+        list->head = cell;
+        --live;
+    }
+
+    // Освобождение всех блоков сразу; объекты в пуле к этому моменту должны быть разрушены
+    void release() {
+        for (void* slab : slabs) {
+            std::free(slab);
+        }
+        slabs.clear();
+        freeLists.clear();
+        current = nullptr;
+        end = nullptr;
+        nextSlabBytes = initialSlabBytes;
+        live = 0;
+    }
+
+    // Количество объектов, выделенных из пула и ещё не освобождённых
+    size_t liveCount() const {
+        return live;
+    }
+
+    // Количество выделенных блоков
+    size_t slabCount() const {
+        return slabs.size();
+    }
+};
+
+// Распределитель, выделяющий память из общего пула NodePool
+// Копии распределителя (в том числе для других типов через rebind) разделяют один пул.
+// При копировании контейнера создаётся новый пул, чтобы копия могла освобождать свою
+// память целиком, не затрагивая оригинал.
+template <typename T>
+class PoolAllocator {
+private:
+    template <typename U> friend class PoolAllocator;
+
+    std::shared_ptr<NodePool> pool;
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::false_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::false_type;
+
+    PoolAllocator() : pool(std::make_shared<NodePool>()) {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>& other) noexcept : pool(other.pool) {}
+
+    T* allocate(size_t count) {
+        return static_cast<T*>(pool->allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T* pointer, size_t count) noexcept {
+        pool->deallocate(pointer, count * sizeof(T));
+    }
+
+    // Копия контейнера получает собственный пул
+    PoolAllocator select_on_container_copy_construction() const {
+        return PoolAllocator();
+    }
+
+    // Освобождение всей памяти пула, если в нём не осталось объектов, кроме ownedCount
+    // объектов вызывающего контейнера (их деструкторы к этому моменту должны быть вызваны)
+    // Возвращает false, если пул разделяется с другим контейнером и освобождать его нельзя
+    bool release(size_t ownedCount) {
+        if (pool->liveCount() != ownedCount) return false;
+        pool->release();
+        return true;
+    }
+
+    // Количество объектов, выделенных из пула и ещё не освобождённых
+    size_t liveCount() const {
+        return pool->liveCount();
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>& other) const {
+        return pool == other.pool;
+    }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>& other) const {
+        return pool != other.pool;
+    }
+};
+
+// Поддерживает ли распределитель массовое освобождение памяти (метод release)
+template <typename Allocator, typename = void>
+struct SupportsBulkRelease : std::false_type {};
+
+template <typename Allocator>
+struct SupportsBulkRelease<Allocator,
+    std::void_t<decltype(std::declval<Allocator&>().release(size_t()))>> : std::true_type {};
+
+#endif // POOL_ALLOCATOR_H
@@ -3,7 +3,21 @@
 #include <cassert>
 #include <vector>
 #include <utility>
+#include <algorithm>
+#include <iterator>
+#include <numeric>
+#include <functional>
+#include <atomic>
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+#include <random>
+#include <thread>
 #include "../include/binary_search_tree.h"
+#include "../include/mapped_binary_search_tree.h"
+#include "../include/persistent_binary_search_tree.h"
+#include "../include/pool_allocator.h"
+#include "../include/thread_pool.h"
 #include "../include/data_types.h"
 
 // Тест базовых операций для int
@@ -523,6 +537,1350 @@ void testSubtreeSearch() {
     std::cout << "Тест поиска на вхождение поддерева пройден!" << std::endl;
 }
 
+// Тест автоматической балансировки (АВЛ-политика)
+void testAVLBalancing() {
+    std::cout << "Запуск теста автоматической балансировки..." << std::endl;
+    
+    BinarySearchTree<int> plainTree;
+    BinarySearchTree<int, AVLBalanced> tree;
+    
+    // Почти отсортированные ключи: обычное дерево вырождается в список
+    const int count = 1000;
+    for (int i = 1; i <= count; i++) {
+        plainTree.insert(i);
+        tree.insert(i);
+    }
+    
+    assert(plainTree.getHeight() == count);
+    assert(tree.getSize() == static_cast<size_t>(count));
+    assert(tree.getHeight() <= 15); // 1.44 * log2(1000) ~ 14.4
+    
+    std::vector<int> values = tree.getValuesInOrder();
+    for (int i = 0; i < count; i++) {
+        assert(values[i] == i + 1);
+    }
+    
+    // Удаление сохраняет баланс
+    for (int i = 1; i <= count; i += 2) {
+        assert(tree.remove(i) == true);
+    }
+    assert(tree.getSize() == static_cast<size_t>(count / 2));
+    assert(tree.getHeight() <= 14);
+    assert(tree.search(1) == false);
+    assert(tree.search(2) == true);
+    
+    // Повторная вставка не меняет дерево
+    tree.insert(2);
+    assert(tree.getSize() == static_cast<size_t>(count / 2));
+    
+    // Извлечение поддерева и поиск поддерева работают и для сбалансированного дерева
+    BinarySearchTree<int, AVLBalanced> subtree = tree.extractSubtree(tree.getValuesByTraversal(TraversalType::PreOrder)[1]);
+    assert(subtree.getSize() > 0);
+    assert(tree.containsSubtree(subtree) == true);
+    
+    std::cout << "Тест автоматической балансировки пройден!" << std::endl;
+}
+
+// Тест линейной балансировки с переиспользованием узлов
+void testLinearBalance() {
+    std::cout << "Запуск теста линейной балансировки..." << std::endl;
+    
+    BinarySearchTree<int> tree;
+    const int count = 1000;
+    for (int i = 1; i <= count; i++) {
+        tree.insert(i);
+    }
+    assert(tree.getHeight() == count);
+    
+    tree.balance();
+    
+    // Идеально сбалансированное дерево из 1000 узлов имеет высоту 10
+    assert(tree.getSize() == static_cast<size_t>(count));
+    assert(tree.getHeight() == 10);
+    
+    // Корнем становится средний элемент, порядок элементов сохраняется
+    std::vector<int> preOrder = tree.getValuesByTraversal(TraversalType::PreOrder);
+    assert(preOrder[0] == 500);
+    std::vector<int> values = tree.getValuesInOrder();
+    for (int i = 0; i < count; i++) {
+        assert(values[i] == i + 1);
+    }
+    
+    // Связи с родителями корректны: удаление и вставка после балансировки работают
+    for (int i = 2; i <= count; i += 2) {
+        assert(tree.remove(i) == true);
+    }
+    assert(tree.getSize() == static_cast<size_t>(count / 2));
+    tree.insert(2);
+    assert(tree.search(2) == true);
+    assert(tree.search(4) == false);
+    
+    // Балансировка небольших деревьев
+    BinarySearchTree<int> small;
+    small.balance();
+    assert(small.isEmpty() == true);
+    small.insert(3);
+    small.insert(2);
+    small.insert(1);
+    small.balance();
+    std::vector<int> expected = {2, 1, 3};
+    assert(small.getValuesByTraversal(TraversalType::PreOrder) == expected);
+    
+    std::cout << "Тест линейной балансировки пройден!" << std::endl;
+}
+
+// Стресс-тест вырожденных деревьев: вставка, поиск, удаление, копирование и удаление
+// дерева выполняются циклами и не зависят от глубины стека
+void testDegenerateTreeStress() {
+    std::cout << "Запуск стресс-теста вырожденных деревьев..." << std::endl;
+    
+    // Вставка отсортированных ключей по одному квадратична, поэтому цепочки строятся
+    // из пар "узел-родитель" за O(n log n) без балансировки
+    const int count = 10000000;
+    std::vector<std::pair<int, int>> pairs;
+    pairs.reserve(count - 1);
+    
+    // Цепочка вправо (возрастающие ключи 0..count-1)
+    for (int i = 1; i < count; i++) {
+        pairs.emplace_back(i, i - 1);
+    }
+    BinarySearchTree<int> ascending = BinarySearchTree<int>::fromNodeParentPairs(pairs);
+    assert(ascending.getSize() == static_cast<size_t>(count));
+    assert(ascending.getHeight() == count);
+    assert(ascending.search(count - 1) == true);
+    assert(ascending.search(count) == false);
+    
+    // Цепочка влево (убывающие ключи count..1)
+    pairs.clear();
+    for (int i = 1; i < count; i++) {
+        pairs.emplace_back(i, i + 1);
+    }
+    BinarySearchTree<int> descending = BinarySearchTree<int>::fromNodeParentPairs(pairs);
+    std::vector<std::pair<int, int>>().swap(pairs);
+    assert(descending.getHeight() == count);
+    assert(descending.search(1) == true);
+    
+    // Вставка на дне цепочки проходит её целиком
+    descending.insert(0);
+    assert(descending.getHeight() == count + 1);
+    assert(descending.select(0) == 0);
+    
+    // Копирование и уничтожение вырожденного дерева
+    {
+        BinarySearchTree<int> copy(ascending);
+        assert(copy.getSize() == static_cast<size_t>(count));
+        assert(copy.getHeight() == count);
+        BinarySearchTree<int> assigned;
+        assigned = descending;
+        assert(assigned.getHeight() == count + 1);
+        assert(assigned.search(count / 2) == true);
+        
+        // Присваивание поверх непустого дерева уничтожает прежнюю цепочку
+        copy = descending;
+        assert(copy.getHeight() == count + 1);
+        assert(copy.search(count - 1) == true);
+    }
+    
+    // Удаление из середины и с концов цепочки
+    assert(ascending.remove(count / 2) == true);
+    assert(ascending.remove(0) == true);
+    assert(ascending.remove(count - 1) == true);
+    assert(ascending.getSize() == static_cast<size_t>(count - 3));
+    assert(ascending.search(count / 2) == false);
+    assert(ascending.search(count / 2 + 1) == true);
+    
+    ascending.clear();
+    descending.clear();
+    assert(ascending.isEmpty() == true);
+    assert(descending.isEmpty() == true);
+    
+    std::cout << "Стресс-тест вырожденных деревьев пройден!" << std::endl;
+}
+
+// Тест дерева с распределителем узлов из пула
+void testPoolAllocatedTree() {
+    std::cout << "Запуск теста дерева с пулом узлов..." << std::endl;
+    
+    using PoolTree = BinarySearchTree<int, AVLBalanced, PoolAllocator<int>>;
+    
+    PoolTree tree;
+    for (int i = 0; i < 1000; i++) {
+        tree.insert(i);
+    }
+    assert(tree.getSize() == 1000);
+    assert(tree.getAllocator().liveCount() == 1000);
+    
+    // Удалённые узлы возвращаются в пул и используются повторно
+    for (int i = 0; i < 1000; i += 2) {
+        assert(tree.remove(i) == true);
+    }
+    assert(tree.getAllocator().liveCount() == 500);
+    for (int i = 0; i < 1000; i += 2) {
+        tree.insert(i);
+    }
+    assert(tree.getAllocator().liveCount() == 1000);
+    
+    // Копия получает собственный пул
+    PoolTree copy(tree);
+    assert(copy.getAllocator() != tree.getAllocator());
+    assert(copy.getAllocator().liveCount() == 1000);
+    assert(copy.getValuesInOrder() == tree.getValuesInOrder());
+    
+    // Очистка освобождает пул целиком, после неё дерево снова пригодно к работе
+    tree.clear();
+    assert(tree.isEmpty() == true);
+    assert(tree.getAllocator().liveCount() == 0);
+    tree.insert(42);
+    assert(tree.search(42) == true);
+    assert(copy.search(999) == true);
+    
+    // Пул, разделяемый двумя деревьями, не освобождается целиком при очистке одного из них
+    PoolAllocator<int> shared;
+    PoolTree first(shared);
+    PoolTree second(shared);
+    for (int i = 0; i < 100; i++) {
+        first.insert(i);
+        second.insert(-i);
+    }
+    first.clear();
+    assert(shared.liveCount() == 100);
+    assert(second.search(-99) == true);
+    
+    // Данные с нетривиальным деструктором
+    BinarySearchTree<std::string, Unbalanced, PoolAllocator<std::string>> strings;
+    for (int i = 0; i < 100; i++) {
+        strings.insert("строка, не помещающаяся в буфер короткой строки " + std::to_string(i));
+    }
+    BinarySearchTree<std::string, Unbalanced, PoolAllocator<std::string>> stringsCopy;
+    stringsCopy = strings;
+    strings.clear();
+    assert(strings.isEmpty() == true);
+    assert(stringsCopy.getSize() == 100);
+    
+    std::cout << "Тест дерева с пулом узлов пройден!" << std::endl;
+}
+
+// Проверка порядковых статистик дерева по отсортированному списку его значений
+template <typename Tree>
+void checkOrderStatistics(const Tree& tree) {
+    std::vector<int> values = tree.getValuesInOrder();
+    assert(values.size() == tree.getSize());
+    
+    for (size_t k = 0; k < values.size(); k++) {
+        assert(tree.select(k) == values[k]);
+        assert(tree.rank(values[k]) == k);
+        // Отсутствующие значения между соседними элементами
+        assert(tree.rank(values[k] + 1) == k + 1);
+    }
+    
+    if (!values.empty()) {
+        assert(tree.countInRange(values.front(), values.back()) == values.size());
+        assert(tree.countInRange(values.front() - 10, values.front() - 1) == 0);
+    }
+}
+
+// Тест порядковых статистик: select, rank, countInRange
+template <typename Balancing>
+void testOrderStatisticsFor() {
+    BinarySearchTree<int, Balancing> tree;
+    
+    // Чётные значения в перемешанном порядке
+    for (int i = 0; i < 500; i++) {
+        tree.insert(((i * 211) % 500) * 2);
+    }
+    assert(tree.getSize() == 500);
+    checkOrderStatistics(tree);
+    
+    assert(tree.select(0) == 0);
+    assert(tree.select(499) == 998);
+    assert(tree.rank(-5) == 0);
+    assert(tree.rank(10000) == 500);
+    assert(tree.countInRange(10, 20) == 6);  // 10, 12, 14, 16, 18, 20
+    assert(tree.countInRange(11, 19) == 4);  // 12, 14, 16, 18
+    assert(tree.countInRange(20, 10) == 0);
+    
+    bool thrown = false;
+    try {
+        tree.select(500);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown == true);
+    
+    // Размеры поддеревьев поддерживаются при удалении и балансировке
+    for (int i = 0; i < 1000; i += 6) {
+        assert(tree.remove(i) == true);
+    }
+    checkOrderStatistics(tree);
+    tree.balance();
+    checkOrderStatistics(tree);
+    
+    // ... при копировании, извлечении поддерева и чтении из списка пар
+    BinarySearchTree<int, Balancing> copy(tree);
+    checkOrderStatistics(copy);
+    BinarySearchTree<int, Balancing> subtree = tree.extractSubtree(tree.select(tree.getSize() / 4));
+    checkOrderStatistics(subtree);
+    
+    std::vector<std::pair<int, int>> pairs = {{3, 5}, {8, 5}, {1, 3}, {4, 3}, {9, 8}};
+    BinarySearchTree<int, Balancing> fromPairs = BinarySearchTree<int, Balancing>::fromNodeParentPairs(pairs);
+    checkOrderStatistics(fromPairs);
+    assert(fromPairs.select(2) == 4);
+}
+
+void testOrderStatistics() {
+    std::cout << "Запуск теста порядковых статистик..." << std::endl;
+    
+    testOrderStatisticsFor<Unbalanced>();
+    testOrderStatisticsFor<AVLBalanced>();
+    
+    std::cout << "Тест порядковых статистик пройден!" << std::endl;
+}
+
+// Тест упорядоченного обхода и запросов диапазонов
+void testRangeQueries() {
+    std::cout << "Запуск теста запросов диапазонов..." << std::endl;
+    
+    BinarySearchTree<int> tree;
+    std::vector<int> values = {50, 30, 70, 20, 40, 60, 80, 10, 35, 65};
+    for (int value : values) {
+        tree.insert(value);
+    }
+    
+    // Упорядоченный обход итератором совпадает с InOrder
+    std::vector<int> ordered;
+    for (int value : tree.range(0, 100)) {
+        ordered.push_back(value);
+    }
+    assert(ordered == tree.getValuesInOrder());
+    
+    std::vector<int> iterated(tree.begin(), tree.end());
+    assert(iterated == ordered);
+    
+    // Границы
+    assert(*tree.lowerBound(35) == 35);
+    assert(*tree.lowerBound(36) == 40);
+    assert(*tree.upperBound(35) == 40);
+    assert(*tree.lowerBound(-100) == 10);
+    assert(tree.lowerBound(81) == tree.end());
+    assert(tree.upperBound(80) == tree.end());
+    
+    // Диапазоны [lo, hi]
+    std::vector<int> inRange;
+    for (int value : tree.range(30, 65)) {
+        inRange.push_back(value);
+    }
+    assert(inRange == std::vector<int>({30, 35, 40, 50, 60, 65}));
+    
+    inRange.clear();
+    for (int value : tree.range(31, 34)) {
+        inRange.push_back(value);
+    }
+    assert(inRange.empty() == true);
+    assert(tree.range(31, 34).empty() == true);
+    assert(tree.range(65, 30).empty() == true);
+    
+    BinarySearchTree<int> empty;
+    assert(empty.begin() == empty.end());
+    assert(empty.range(0, 10).empty() == true);
+    
+    // Построение сбалансированного дерева из участка упорядоченного обхода
+    auto above = BinarySearchTree<int>::fromSorted(tree.upperBound(40), tree.end());
+    assert(above.getValuesInOrder() == std::vector<int>({50, 60, 65, 70, 80}));
+    assert(above.getHeight() == 3);
+    
+    auto below = BinarySearchTree<int>::fromSorted(tree.begin(), tree.lowerBound(40));
+    assert(below.getValuesInOrder() == std::vector<int>({10, 20, 30, 35}));
+    
+    std::vector<int> sorted;
+    for (int i = 0; i < 1023; i++) {
+        sorted.push_back(i * 3);
+    }
+    auto perfect = BinarySearchTree<int, AVLBalanced>::fromSorted(sorted.begin(), sorted.end());
+    assert(perfect.getSize() == 1023);
+    assert(perfect.getHeight() == 10);
+    assert(perfect.rank(300) == 100);
+    perfect.insert(1);
+    assert(perfect.search(1) == true);
+    
+    // Неупорядоченная последовательность отвергается
+    std::vector<int> unsorted = {1, 3, 2};
+    bool thrown = false;
+    try {
+        BinarySearchTree<int>::fromSorted(unsorted.begin(), unsorted.end());
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown == true);
+    
+    // where строит сбалансированное дерево и на упорядоченных данных
+    BinarySearchTree<int> chain;
+    for (int i = 0; i < 1000; i++) {
+        chain.insert(i);
+    }
+    auto evens = chain.where([](const int& value) { return value % 2 == 0; });
+    assert(evens.getSize() == 500);
+    assert(evens.getHeight() == 9);
+    
+    std::cout << "Тест запросов диапазонов пройден!" << std::endl;
+}
+
+// Тест двунаправленных итераторов и совместимости с алгоритмами STL
+void testBidirectionalIterators() {
+    std::cout << "Запуск теста двунаправленных итераторов..." << std::endl;
+    
+    BinarySearchTree<int, AVLBalanced> tree;
+    for (int i = 0; i < 200; i++) {
+        tree.insert((i * 73) % 200);
+    }
+    
+    // Цикл for по диапазону
+    int expected = 0;
+    for (int value : tree) {
+        assert(value == expected);
+        expected++;
+    }
+    assert(expected == 200);
+    
+    // Обратный обход совпадает с ReverseInOrder
+    std::vector<int> reversed(tree.rbegin(), tree.rend());
+    assert(reversed == tree.getValuesByTraversal(TraversalType::ReverseInOrder));
+    assert(reversed.front() == 199 && reversed.back() == 0);
+    
+    // Шаги назад и вперёд
+    auto it = tree.end();
+    --it;
+    assert(*it == 199);
+    it--;
+    assert(*it == 198);
+    ++it;
+    assert(*it == 199);
+    ++it;
+    assert(it == tree.end());
+    
+    auto bound = tree.lowerBound(100);
+    assert(*std::prev(bound) == 99);
+    assert(*std::next(bound, 5) == 105);
+    
+    // Алгоритмы STL
+    assert(std::distance(tree.begin(), tree.end()) == 200);
+    assert(std::is_sorted(tree.begin(), tree.end()) == true);
+    assert(std::count_if(tree.begin(), tree.end(), [](int value) { return value % 10 == 0; }) == 20);
+    assert(*std::max_element(tree.begin(), tree.end()) == 199);
+    assert(std::binary_search(tree.begin(), tree.end(), 150) == true);
+    assert(std::accumulate(tree.cbegin(), tree.cend(), 0) == 199 * 200 / 2);
+    
+    auto found = std::find(tree.rbegin(), tree.rend(), 42);
+    assert(found != tree.rend() && *found == 42);
+    
+    std::vector<int> tail;
+    std::copy(tree.upperBound(195), tree.end(), std::back_inserter(tail));
+    assert(tail == std::vector<int>({196, 197, 198, 199}));
+    
+    // Пустое дерево
+    BinarySearchTree<int> empty;
+    assert(empty.begin() == empty.end());
+    assert(empty.rbegin() == empty.rend());
+    
+    std::cout << "Тест двунаправленных итераторов пройден!" << std::endl;
+}
+
+// Тест шаблонных обходов: все типы обхода и вызов с произвольным вызываемым объектом
+void testTemplateTraversal() {
+    std::cout << "Запуск теста шаблонных обходов..." << std::endl;
+    
+    // Дерево: 50 -> (30, 70), 30 -> (20, 40), 40 -> (35, -), 70 -> (-, 80)
+    BinarySearchTree<int> tree;
+    for (int value : {50, 30, 70, 20, 40, 80, 35}) {
+        tree.insert(value);
+    }
+    
+    auto collect = [&tree](TraversalType type) {
+        std::vector<int> values;
+        tree.traverse(type, [&values](const int& value) { values.push_back(value); });
+        return values;
+    };
+    
+    assert(collect(TraversalType::PreOrder) == std::vector<int>({50, 30, 20, 40, 35, 70, 80}));
+    assert(collect(TraversalType::InOrder) == std::vector<int>({20, 30, 35, 40, 50, 70, 80}));
+    assert(collect(TraversalType::PostOrder) == std::vector<int>({20, 35, 40, 30, 80, 70, 50}));
+    assert(collect(TraversalType::ReversePreOrder) == std::vector<int>({50, 70, 80, 30, 40, 35, 20}));
+    assert(collect(TraversalType::ReverseInOrder) == std::vector<int>({80, 70, 50, 40, 35, 30, 20}));
+    assert(collect(TraversalType::ReversePostOrder) == std::vector<int>({80, 70, 35, 40, 20, 30, 50}));
+    
+    // Обход поддерева не выходит за его пределы
+    auto subtree = tree.extractSubtree(30);
+    std::vector<int> subtreeValues;
+    subtree.traverse(TraversalType::PostOrder, [&subtreeValues](const int& value) {
+        subtreeValues.push_back(value);
+    });
+    assert(subtreeValues == std::vector<int>({20, 35, 40, 30}));
+    
+    // Обход вырожденного дерева не использует стек вызовов
+    BinarySearchTree<int> chain;
+    for (int i = 0; i < 20000; i++) {
+        chain.insert(-i);
+    }
+    long long chainSum = 0;
+    chain.traverse(TraversalType::PostOrder, [&chainSum](const int& value) { chainSum += value; });
+    assert(chainSum == -199990000LL);
+    
+    // Шаблонные и std::function версии map, reduce, where дают одинаковый результат
+    std::function<int(const int&, const int&)> sumFunction = [](const int& a, const int& b) { return a + b; };
+    assert(tree.reduce(sumFunction, 0) == 325);
+    assert(tree.reduce([](const int& a, const int& b) { return a + b; }, 0) == 325);
+    
+    struct Doubler {
+        int operator()(const int& value) const { return value * 2; }
+    };
+    assert(tree.map(Doubler()).getValuesInOrder() == std::vector<int>({40, 60, 70, 80, 100, 140, 160}));
+    
+    std::function<bool(const int&)> isEven = [](const int& value) { return value % 2 == 0; };
+    assert(tree.where(isEven).getValuesInOrder() == tree.where([](const int& value) { return value % 2 == 0; }).getValuesInOrder());
+    
+    std::cout << "Тест шаблонных обходов пройден!" << std::endl;
+}
+
+// Тест параллельных map и where
+void testParallelMapWhere() {
+    std::cout << "Запуск теста параллельных map и where..." << std::endl;
+    
+    // Пул потоков: все итерации выполняются ровно один раз, исключение передаётся вызывающему
+    ThreadPool pool(3);
+    std::vector<int> hits(1000, 0);
+    pool.parallelFor(hits.size(), [&hits](size_t index) { hits[index]++; });
+    assert(std::count(hits.begin(), hits.end(), 1) == 1000);
+    assert(pool.submit([]() { return 42; }).get() == 42);
+    
+    bool thrown = false;
+    try {
+        pool.parallelFor(10, [](size_t index) {
+            if (index == 7) throw std::runtime_error("ошибка в задаче");
+        });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown == true);
+    
+    // Вложенный параллельный вызов из задачи пула не блокируется
+    std::atomic<int> nested(0);
+    ThreadPool::shared().parallelFor(4, [&nested](size_t) {
+        ThreadPool::shared().parallelFor(4, [&nested](size_t) { nested++; });
+    });
+    assert(nested == 16);
+    
+    // Дерево достаточно большое, чтобы делиться на несколько участков
+    std::vector<int> keys;
+    for (int i = 0; i < 100000; i++) {
+        keys.push_back(i);
+    }
+    auto tree = BinarySearchTree<int>::fromSorted(keys.begin(), keys.end());
+    
+    auto isMultipleOf3 = [](const int& value) { return value % 3 == 0; };
+    auto sequentialWhere = tree.where(isMultipleOf3);
+    auto parallelWhere = tree.where(isMultipleOf3, ExecutionMode::Parallel);
+    assert(parallelWhere.getSize() == 33334);
+    assert(parallelWhere.getValuesInOrder() == sequentialWhere.getValuesInOrder());
+    assert(parallelWhere.getHeight() == sequentialWhere.getHeight());
+    
+    // Немонотонная функция с повторами значений
+    auto square = [](const int& value) {
+        long long shifted = value - 50000;
+        return static_cast<int>(shifted * shifted % 1000003);
+    };
+    auto sequentialMap = tree.map(square);
+    auto parallelMap = tree.map(square, ExecutionMode::Parallel);
+    assert(parallelMap.getValuesInOrder() == sequentialMap.getValuesInOrder());
+    
+    BinarySearchTree<int> inserted;
+    for (int value : tree) {
+        inserted.insert(square(value));
+    }
+    assert(sequentialMap.getValuesInOrder() == inserted.getValuesInOrder());
+    
+    // Вырожденное дерево делится на участки так же, как сбалансированное
+    BinarySearchTree<int> chain;
+    for (int i = 0; i < 10000; i++) {
+        chain.insert(i);
+    }
+    auto chainEvens = chain.where([](const int& value) { return value % 2 == 0; }, ExecutionMode::Parallel);
+    assert(chainEvens.getSize() == 5000);
+    assert(chainEvens.select(4999) == 9998);
+    
+    std::cout << "Тест параллельных map и where пройден!" << std::endl;
+}
+
+// Тест ассоциативной свёртки с объединением частичных результатов
+void testAssociativeReduce() {
+    std::cout << "Запуск теста ассоциативной свёртки..." << std::endl;
+    
+    std::vector<int> keys;
+    for (int i = 1; i <= 50000; i++) {
+        keys.push_back(i);
+    }
+    auto tree = BinarySearchTree<int>::fromSorted(keys.begin(), keys.end());
+    
+    auto plus = [](const long long& a, const long long& b) { return a + b; };
+    auto intPlus = [](const int& a, const int& b) { return a + b; };
+    
+    // Сумма по модулю совпадает с обычной свёрткой в обоих режимах
+    auto modPlus = [](const int& a, const int& b) { return (a + b) % 1000003; };
+    int expected = tree.reduce(modPlus, 0);
+    assert(tree.reduce(modPlus, modPlus, 0) == expected);
+    assert(tree.reduce(modPlus, modPlus, 0, ExecutionMode::Parallel) == expected);
+    
+    // Максимум: нейтральный элемент - наименьшее значение
+    auto maxOf = [](const int& a, const int& b) { return std::max(a, b); };
+    assert(tree.reduce(maxOf, maxOf, 0, ExecutionMode::Parallel) == 50000);
+    
+    // Небольшие деревья и блоки, не кратные четырём
+    for (int n : {0, 1, 3, 255, 257, 1001}) {
+        BinarySearchTree<int> small;
+        for (int i = 1; i <= n; i++) {
+            small.insert(i);
+        }
+        assert(small.reduce(intPlus, intPlus, 0) == n * (n + 1) / 2);
+        assert(small.reduce(intPlus, intPlus, 0, ExecutionMode::Parallel) == n * (n + 1) / 2);
+    }
+    
+    BinarySearchTree<long long> wide;
+    for (long long i = 0; i < 20000; i++) {
+        wide.insert(i * 100000);
+    }
+    assert(wide.reduce(plus, plus, 0LL, ExecutionMode::Parallel) == 19999LL * 20000 / 2 * 100000);
+    
+    // Конкатенация строк ассоциативна, но не коммутативна: порядок элементов сохраняется
+    BinarySearchTree<std::string> words;
+    for (int i = 0; i < 10000; i++) {
+        std::string word = std::to_string(i);
+        words.insert(std::string(5 - word.size(), '0') + word);
+    }
+    auto append = [](const std::string& value, const std::string& acc) { return acc + value; };
+    auto concat = [](const std::string& left, const std::string& right) { return left + right; };
+    std::string ordered = words.reduce(append, std::string());
+    assert(words.reduce(append, concat, std::string()) == ordered);
+    assert(words.reduce(append, concat, std::string(), ExecutionMode::Parallel) == ordered);
+    assert(ordered.substr(0, 15) == "000000000100002");
+    
+    std::cout << "Тест ассоциативной свёртки пройден!" << std::endl;
+}
+
+// Тест преобразования чисел в строку и обратно
+void testNumericConversions() {
+    std::cout << "Запуск теста преобразования чисел..." << std::endl;
+    
+    // Целые числа: граничные значения и круговое преобразование
+    for (int value : {0, 1, -1, 42, -2147483647 - 1, 2147483647}) {
+        assert(valueToString(value) == std::to_string(value));
+        assert(valueFromString<int>(valueToString(value)) == value);
+    }
+    
+    // Вещественные числа выводятся так же, как потоком по умолчанию
+    for (double value : {0.0, 1.5, -2.25, 3.14159265, 1e-7, 123456789.0, 1e300}) {
+        std::ostringstream ss;
+        ss << value;
+        assert(valueToString(value) == ss.str());
+    }
+    assert(valueFromString<double>("2.5") == 2.5);
+    assert(valueFromString<double>("-1e3") == -1000.0);
+    
+    // Разбор без исключений
+    int number = 7;
+    assert(tryValueFromString("  -15 ", number) && number == -15);
+    assert(tryValueFromString("+8", number) && number == 8);
+    assert(!tryValueFromString("12abc", number) && number == 8);
+    assert(!tryValueFromString("", number));
+    assert(!tryValueFromString("+-3", number));
+    assert(!tryValueFromString("99999999999", number));
+    
+    double real = 0.0;
+    assert(tryValueFromString("0.125", real) && real == 0.125);
+    assert(!tryValueFromString("1.5.2", real) && real == 0.125);
+    
+    // Для нечисловых типов используется valueFromString
+    std::string text;
+    assert(tryValueFromString("abc", text) && text == "abc");
+    
+    // Ошибка разбора в valueFromString сообщается исключением
+    bool thrown = false;
+    try {
+        valueFromString<int>("abc");
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    // Запись в строку без промежуточных объектов
+    std::string out = "[";
+    appendValue(out, 10);
+    out += ',';
+    appendValue(out, 0.5);
+    out += ',';
+    appendValue(out, std::string("x"));
+    assert(out == "[10,0.5,x");
+    
+    // Круговое преобразование дерева
+    BinarySearchTree<int> tree;
+    for (int i = -500; i <= 500; i += 7) {
+        tree.insert(i);
+    }
+    auto restored = BinarySearchTree<int>::fromString(tree.toString());
+    assert(restored.getSize() == tree.getSize());
+    assert(restored.toString() == tree.toString());
+    
+    std::cout << "Тест преобразования чисел пройден!" << std::endl;
+}
+
+// Тест однопроходного разбора строкового представления
+void testStreamingParse() {
+    std::cout << "Запуск теста однопроходного разбора строки..." << std::endl;
+    
+    // Разбиение на элементы без копирования
+    std::string text = "1, 22, , 333, ";
+    ValueTokenizer tokenizer(text, ", ");
+    std::vector<std::string> tokens;
+    std::string_view token;
+    while (tokenizer.next(token)) {
+        tokens.emplace_back(token);
+    }
+    std::vector<std::string> expectedTokens = {"1", "22", "", "333"};
+    assert(tokens == expectedTokens);
+    
+    ValueTokenizer empty("", ", ");
+    assert(!empty.next(token));
+    assert(stripBrackets("[]").empty() && stripBrackets("[").empty());
+    
+    // Упорядоченная строка (результат toString) даёт сбалансированное дерево даже без балансировки
+    const int n = 100000;
+    std::string dump = "[";
+    for (int i = 0; i < n; i++) {
+        if (i > 0) dump += ", ";
+        dump += std::to_string(i * 2);
+    }
+    dump += "]";
+    auto sorted = BinarySearchTree<int>::fromString(dump);
+    assert(sorted.getSize() == static_cast<size_t>(n));
+    assert(sorted.getHeight() <= 18);
+    assert(sorted.toString() == dump);
+    assert(sorted.select(500) == 1000);
+    
+    // Неупорядоченная строка: значения вставляются, повторы и некорректные элементы пропускаются
+    auto unsorted = BinarySearchTree<int>::fromString("[5, 3, x, 8, 3, 12abc, 1]");
+    std::vector<int> expected = {1, 3, 5, 8};
+    assert(unsorted.getValuesInOrder() == expected);
+    
+    // Повтор в упорядоченной строке
+    auto repeated = BinarySearchTree<int>::fromString("[1, 2, 2, 3]");
+    assert(repeated.getSize() == 3);
+    
+    assert(BinarySearchTree<int>::fromString("[]").getSize() == 0);
+    assert(BinarySearchTree<int>::fromString("").getSize() == 0);
+    
+    auto words = BinarySearchTree<std::string>::fromString("[apple, banana, cherry]");
+    assert(words.getSize() == 3 && words.search("banana"));
+    
+    std::cout << "Тест однопроходного разбора строки пройден!" << std::endl;
+}
+
+// Тест записи в поток и чтения из потока
+void testStreamSerialization() {
+    std::cout << "Запуск теста записи в поток и чтения из потока..." << std::endl;
+    
+    // Дерево, текст которого занимает несколько участков буфера
+    BinarySearchTree<int> tree;
+    for (int i = 0; i < 60000; i++) {
+        tree.insert((i * 7919) % 60000 - 30000);
+    }
+    
+    std::stringstream stream;
+    tree.writeTo(stream);
+    assert(stream.str() == tree.toString());
+    auto restored = BinarySearchTree<int>::readFrom(stream);
+    assert(restored.getSize() == tree.getSize());
+    assert(restored.toString() == tree.toString());
+    
+    // Формат с заданным обходом
+    std::stringstream formatted;
+    tree.writeTo(formatted, "{К}(Л)[П]");
+    assert(formatted.str() == tree.toStringFormatted("{К}(Л)[П]"));
+    
+    std::stringstream segments("{10}(5)[15]");
+    auto small = BinarySearchTree<int>::readFrom(segments, "{К}(Л)[П]");
+    assert(small.getValuesInOrder() == std::vector<int>({5, 10, 15}));
+    
+    // Файл с переводом строки в конце
+    const char* path = "bst_stream_test.txt";
+    {
+        std::ofstream file(path);
+        tree.writeTo(file);
+        file << '\n';
+    }
+    {
+        std::ifstream file(path);
+        auto loaded = BinarySearchTree<int>::readFrom(file);
+        assert(loaded.toString() == tree.toString());
+    }
+    std::remove(path);
+    
+    // Пустой поток и пустой список дают пустое дерево
+    std::stringstream emptyStream;
+    assert(BinarySearchTree<int>::readFrom(emptyStream).getSize() == 0);
+    std::stringstream emptyList(" [] ");
+    assert(BinarySearchTree<int>::readFrom(emptyList).getSize() == 0);
+    
+    // Некорректные элементы пропускаются, как в fromString
+    std::stringstream mixed("[3, x, 1, 2]");
+    assert(BinarySearchTree<int>::readFrom(mixed).getValuesInOrder() == std::vector<int>({1, 2, 3}));
+    
+    // Нарушение формата списка
+    for (const char* text : {"3, 4]", "[3, 4"}) {
+        std::stringstream broken(text);
+        bool thrown = false;
+        try {
+            BinarySearchTree<int>::readFrom(broken);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    }
+    
+    // Ошибка записи сообщается исключением
+    std::ofstream closed;
+    bool thrown = false;
+    try {
+        tree.writeTo(closed);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    std::cout << "Тест записи в поток и чтения из потока пройден!" << std::endl;
+}
+
+// Тест двоичного снимка дерева
+void testBinarySnapshot() {
+    std::cout << "Запуск теста двоичного снимка дерева..." << std::endl;
+    
+    BinarySearchTree<int> tree;
+    for (int i = 0; i < 30000; i++) {
+        tree.insert((i * 7919) % 30000 - 15000);
+    }
+    
+    std::stringstream stream;
+    tree.saveSnapshot(stream);
+    auto loaded = BinarySearchTree<int>::loadSnapshot(stream);
+    
+    // Структура совпадает: префиксный обход и высота те же
+    assert(loaded.getSize() == tree.getSize());
+    assert(loaded.getHeight() == tree.getHeight());
+    assert(loaded.toStringFormatted("{К}(Л)[П]") == tree.toStringFormatted("{К}(Л)[П]"));
+    assert(loaded.select(100) == tree.select(100));
+    assert(loaded.rank(0) == tree.rank(0));
+    
+    // Снимок меньше текстового представления
+    assert(stream.str().size() < tree.toString().size());
+    
+    // Несколько снимков в одном потоке, включая пустое дерево и Complex
+    BinarySearchTree<Complex> complexTree;
+    for (int i = 0; i < 100; i++) {
+        complexTree.insert(Complex(i % 10, i / 10 - 5.5));
+    }
+    BinarySearchTree<double> empty;
+    std::stringstream several;
+    complexTree.saveSnapshot(several);
+    empty.saveSnapshot(several);
+    tree.saveSnapshot(several);
+    auto loadedComplex = BinarySearchTree<Complex>::loadSnapshot(several);
+    assert(loadedComplex.getValuesInOrder() == complexTree.getValuesInOrder());
+    assert(BinarySearchTree<double>::loadSnapshot(several).getSize() == 0);
+    assert(BinarySearchTree<int>::loadSnapshot(several).toString() == tree.toString());
+    
+    // Вырожденное дерево без балансировки при загрузке в AVL-дерево балансируется
+    BinarySearchTree<int> chain;
+    for (int i = 0; i < 1000; i++) {
+        chain.insert(i);
+    }
+    std::stringstream chainStream;
+    chain.saveSnapshot(chainStream);
+    std::string chainSnapshot = chainStream.str();
+    std::stringstream chainCopy(chainSnapshot);
+    assert(BinarySearchTree<int>::loadSnapshot(chainCopy).getHeight() == 1000);
+    std::stringstream chainAVL(chainSnapshot);
+    auto balanced = BinarySearchTree<int, AVLBalanced>::loadSnapshot(chainAVL);
+    assert(balanced.getHeight() <= 11);
+    assert(balanced.getValuesInOrder() == chain.getValuesInOrder());
+    
+    // Некорректные снимки
+    auto expectFailure = [](const std::string& data) {
+        std::stringstream input(data);
+        bool thrown = false;
+        try {
+            BinarySearchTree<int>::loadSnapshot(input);
+        } catch (const std::runtime_error&) {
+            thrown = true;
+        }
+        assert(thrown);
+    };
+    std::string snapshot = stream.str();
+    expectFailure("");
+    expectFailure("[1, 2, 3]");
+    expectFailure(snapshot.substr(0, snapshot.size() - 1));
+    std::stringstream doubleStream;
+    BinarySearchTree<double> doubles;
+    doubles.insert(1.5);
+    doubles.saveSnapshot(doubleStream);
+    expectFailure(doubleStream.str());
+    
+    std::cout << "Тест двоичного снимка дерева пройден!" << std::endl;
+}
+
+// Тест дерева, отображённого в память
+void testMappedTree() {
+    std::cout << "Запуск теста дерева, отображённого в память..." << std::endl;
+    
+    BinarySearchTree<int> tree;
+    for (int i = 0; i < 20000; i++) {
+        tree.insert((i * 7919) % 20000 - 10000);
+    }
+    
+    const std::string path = "mapped_tree_test.bin";
+    MappedBinarySearchTree<int>::write(tree, path);
+    {
+        MappedBinarySearchTree<int> mapped(path);
+        MappedBinarySearchTree<int> shared(path); // Второе отображение того же файла
+        
+        assert(mapped.getSize() == tree.getSize());
+        assert(mapped.getValuesInOrder() == tree.getValuesInOrder());
+        for (int value = -10005; value <= 10005; value += 3) {
+            assert(mapped.search(value) == tree.search(value));
+        }
+        
+        // Все виды обхода совпадают с исходным деревом
+        for (TraversalType type : {TraversalType::PreOrder, TraversalType::InOrder, TraversalType::PostOrder,
+                                   TraversalType::ReversePreOrder, TraversalType::ReverseInOrder,
+                                   TraversalType::ReversePostOrder}) {
+            std::vector<int> values;
+            mapped.traverse(type, [&values](const int& value) { values.push_back(value); });
+            assert(values == tree.getValuesByTraversal(type));
+        }
+        
+        // Поиск поддерева: по обычному дереву и по другому отображению
+        int subtreeRoot = tree.getValuesByTraversal(TraversalType::PreOrder)[3];
+        auto subtree = tree.extractSubtree(subtreeRoot);
+        assert(mapped.containsSubtree(subtree));
+        assert(shared.containsSubtree(mapped));
+        BinarySearchTree<int> other;
+        other.insert(subtreeRoot);
+        assert(mapped.containsSubtree(other) == tree.containsSubtree(other));
+        other.insert(20000);
+        assert(!mapped.containsSubtree(other) && !tree.containsSubtree(other));
+        assert(mapped.containsSubtree(BinarySearchTree<int>()));
+    }
+    
+    // Пустое дерево
+    MappedBinarySearchTree<int>::write(BinarySearchTree<int>(), path);
+    {
+        MappedBinarySearchTree<int> empty(path);
+        assert(empty.isEmpty() && !empty.search(0));
+        assert(empty.getValuesInOrder().empty());
+    }
+    
+    // Файл с элементами другого типа и повреждённый файл не открываются
+    BinarySearchTree<double> doubles;
+    doubles.insert(1.5);
+    MappedBinarySearchTree<double>::write(doubles, path);
+    bool thrown = false;
+    try {
+        MappedBinarySearchTree<int> wrongType(path);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    MappedBinarySearchTree<int>::write(tree, path);
+    {
+        std::ofstream truncate(path, std::ios::binary | std::ios::app);
+        truncate << 'x';
+    }
+    thrown = false;
+    try {
+        MappedBinarySearchTree<int> damaged(path);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    std::remove(path.c_str());
+    
+    std::cout << "Тест дерева, отображённого в память, пройден!" << std::endl;
+}
+
+// Проверка, что список пар отвергается с исключением
+template <typename Tree>
+bool rejectsNodeParentPairs(const std::vector<std::pair<int, int>>& pairs) {
+    try {
+        Tree::fromNodeParentPairs(pairs);
+    } catch (const std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+// Тест проверки и линейного построения дерева из списка пар «узел-родитель»
+void testNodeParentPairsValidation() {
+    std::cout << "Запуск теста проверки списка пар «узел-родитель»..." << std::endl;
+    
+    // Разбор списка пар в формате меню, в том числе с отрицательными значениями
+    std::vector<std::pair<int, int>> parsed = parseNodeParentPairs<int>("5-10, 15-10,-3-5, -7--3 ,");
+    std::vector<std::pair<int, int>> expectedPairs = {{5, 10}, {15, 10}, {-3, 5}, {-7, -3}};
+    assert(parsed == expectedPairs);
+    assert(parseNodeParentPairs<int>("").empty());
+    bool rejected = false;
+    try {
+        parseNodeParentPairs<int>("5-10,15");
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
+    
+    BinarySearchTree<int> parsedTree = BinarySearchTree<int>::fromNodeParentPairs(parsed);
+    std::vector<int> expectedValues = {-7, -3, 5, 10, 15};
+    assert(parsedTree.getValuesInOrder() == expectedValues);
+    assert(parsedTree.getHeight() == 4);
+    
+    // Некорректные списки: два родителя, два левых потомка, несколько корней, цикл,
+    // узел - собственный родитель, нарушение порядка дерева поиска
+    assert((rejectsNodeParentPairs<BinarySearchTree<int>>({{5, 10}, {5, 15}})));
+    assert((rejectsNodeParentPairs<BinarySearchTree<int>>({{5, 10}, {3, 10}})));
+    assert((rejectsNodeParentPairs<BinarySearchTree<int>>({{5, 10}, {25, 20}})));
+    assert((rejectsNodeParentPairs<BinarySearchTree<int>>({{5, 10}, {10, 5}})));
+    assert((rejectsNodeParentPairs<BinarySearchTree<int>>({{5, 10}, {20, 30}, {30, 20}})));
+    assert((rejectsNodeParentPairs<BinarySearchTree<int>>({{5, 10}, {7, 7}})));
+    assert((rejectsNodeParentPairs<BinarySearchTree<int>>({{5, 10}, {12, 5}})));
+    assert((rejectsNodeParentPairs<BinarySearchTree<int, AVLBalanced>>({{5, 10}, {12, 5}})));
+    
+    // Значения без хеш-функции попадают в одну корзину индекса и различаются через operator==
+    using Unhashed = std::pair<int, int>;
+    static_assert(!IsStdHashable<Unhashed>::value, "У пары не должно быть std::hash");
+    std::vector<std::pair<Unhashed, Unhashed>> unhashedPairs = {
+        {{1, 0}, {2, 0}}, {{3, 0}, {2, 0}}, {{0, 5}, {1, 0}}, {{2, 1}, {3, 0}}};
+    BinarySearchTree<Unhashed> unhashed = BinarySearchTree<Unhashed>::fromNodeParentPairs(unhashedPairs);
+    std::vector<Unhashed> expectedUnhashed = {{0, 5}, {1, 0}, {2, 0}, {2, 1}, {3, 0}};
+    assert(unhashed.getValuesInOrder() == expectedUnhashed);
+    unhashedPairs.push_back({{1, 0}, {0, 5}});
+    rejected = false;
+    try {
+        BinarySearchTree<Unhashed>::fromNodeParentPairs(unhashedPairs);
+    } catch (const std::runtime_error&) {
+        rejected = true;
+    }
+    assert(rejected);
+    
+    // Вырожденная цепочка из миллиона узлов в перемешанном порядке пар строится за ожидаемое O(n)
+    const int n = 1000000;
+    std::vector<std::pair<int, int>> chain;
+    chain.reserve(n - 1);
+    for (int i = 1; i < n; ++i) {
+        chain.emplace_back(i, i - 1);
+    }
+    std::shuffle(chain.begin(), chain.end(), std::mt19937(21));
+    
+    BinarySearchTree<int> degenerate = BinarySearchTree<int>::fromNodeParentPairs(chain);
+    assert(degenerate.getSize() == static_cast<size_t>(n));
+    assert(degenerate.getHeight() == n);
+    assert(degenerate.select(n / 2) == n / 2);
+    assert(degenerate.search(n - 1) && !degenerate.search(n));
+    
+    BinarySearchTree<int, AVLBalanced> balanced = BinarySearchTree<int, AVLBalanced>::fromNodeParentPairs(chain);
+    assert(balanced.getSize() == static_cast<size_t>(n));
+    assert(balanced.getHeight() <= 21);
+    assert(balanced.select(n / 2) == n / 2);
+    
+    std::cout << "Тест проверки списка пар «узел-родитель» пройден!" << std::endl;
+}
+
+// Проверка структурных хешей: копия из снимка (хеши в ней вычислены заново) и её поддеревья
+// должны находиться в дереве, хеши которого поддерживались при вставках и удалениях
+template <typename Balancing>
+void checkSubtreeHashes(const BinarySearchTree<int, Balancing>& tree) {
+    std::stringstream snapshot;
+    tree.saveSnapshot(snapshot);
+    BinarySearchTree<int, Balancing> fresh = BinarySearchTree<int, Balancing>::loadSnapshot(snapshot);
+    assert(tree.containsSubtree(fresh));
+    
+    std::vector<int> values = tree.getValuesInOrder();
+    for (size_t i = 0; i < values.size(); i += 7) {
+        assert(tree.containsSubtree(fresh.extractSubtree(values[i])));
+    }
+}
+
+template <typename Balancing>
+void testSubtreeHashesFor() {
+    BinarySearchTree<int, Balancing> tree;
+    std::mt19937 generator(23);
+    std::uniform_int_distribution<int> distribution(0, 5000);
+    
+    for (int step = 1; step <= 3000; ++step) {
+        if (step % 3 == 0) {
+            tree.remove(distribution(generator));
+        } else {
+            tree.insert(distribution(generator));
+        }
+        if (step % 500 == 0) {
+            checkSubtreeHashes(tree);
+        }
+    }
+    tree.balance();
+    checkSubtreeHashes(tree);
+    
+    // Поддерево с тем же корнем, но другим листом, не находится
+    BinarySearchTree<int, Balancing> copy(tree);
+    int leaf = copy.getValuesInOrder().front();
+    BinarySearchTree<int, Balancing> changed = copy.extractSubtree(copy.select(0));
+    changed.remove(leaf);
+    changed.insert(leaf - 1);
+    assert(!tree.containsSubtree(changed));
+}
+
+// Тест структурных хешей для поиска вхождения поддерева
+void testSubtreeHashes() {
+    std::cout << "Запуск теста структурных хешей поддеревьев..." << std::endl;
+    
+    testSubtreeHashesFor<Unbalanced>();
+    testSubtreeHashesFor<AVLBalanced>();
+    
+    // Хеши согласованы с operator== и для пользовательских типов
+    assert(valueHash(Complex(1.0, 2.0)) == valueHash(Complex(1.0, 2.0)));
+    assert(valueHash(0.0) == valueHash(-0.0));
+    BinarySearchTree<Complex> complexTree;
+    for (int i = 0; i < 20; ++i) {
+        complexTree.insert(Complex(i % 5, i));
+    }
+    BinarySearchTree<Complex> complexSubtree = complexTree.extractSubtree(Complex(2.0, 2.0));
+    assert(complexSubtree.getSize() > 1);
+    assert(complexTree.containsSubtree(complexSubtree));
+    complexSubtree.insert(Complex(2.5, 0.0));
+    assert(!complexTree.containsSubtree(complexSubtree));
+    
+    std::cout << "Тест структурных хешей поддеревьев пройден!" << std::endl;
+}
+
+// Тест персистентного дерева: снимки за O(1) и разделение узлов
+void testPersistentTree() {
+    std::cout << "Запуск теста персистентного дерева..." << std::endl;
+    
+    PersistentBinarySearchTree<int> tree;
+    assert(tree.isEmpty());
+    assert(tree.toString() == "[]");
+    for (int i = 0; i < 1000; ++i) {
+        tree.insert((i * 7919) % 1000);
+    }
+    tree.insert(5); // Повтор не добавляется
+    assert(tree.getSize() == 1000);
+    assert(tree.getHeight() <= 15); // Граница высоты АВЛ-дерева: 1.44 * log2(1000)
+    for (size_t k = 0; k < 1000; k += 37) {
+        assert(tree.select(k) == static_cast<int>(k));
+        assert(tree.rank(static_cast<int>(k)) == k);
+    }
+    
+    // Снимок не меняется при изменении дерева, а дерево - при изменении снимка
+    PersistentBinarySearchTree<int> snapshot = tree.snapshot();
+    for (int i = 0; i < 1000; i += 2) {
+        assert(tree.remove(i));
+    }
+    assert(!tree.remove(0));
+    tree.insert(5000);
+    assert(tree.getSize() == 501);
+    assert(tree.getHeight() <= 14);
+    assert(snapshot.getSize() == 1000);
+    assert(snapshot.search(0) && !snapshot.search(5000));
+    std::vector<int> expected(1000);
+    std::iota(expected.begin(), expected.end(), 0);
+    assert(snapshot.getValuesInOrder() == expected);
+    
+    PersistentBinarySearchTree<int> copy = snapshot;
+    copy.clear();
+    assert(copy.isEmpty() && snapshot.getSize() == 1000);
+    
+    // Извлечённое поддерево разделяет узлы с деревом и остаётся корректным деревом поиска
+    PersistentBinarySearchTree<int> subtree;
+    for (int value = 0; subtree.getSize() < 2; ++value) {
+        subtree = snapshot.extractSubtree(value);
+    }
+    assert(snapshot.containsSubtree(subtree));
+    std::vector<int> subtreeValues = subtree.getValuesInOrder();
+    assert(std::is_sorted(subtreeValues.begin(), subtreeValues.end()));
+    assert(snapshot.extractSubtree(-1).isEmpty());
+    subtree.insert(-1);
+    assert(!snapshot.containsSubtree(subtree));
+    assert(!snapshot.search(-1));
+    
+    // map и where строят новые деревья, исходное не меняется
+    PersistentBinarySearchTree<int> halves = snapshot.map([](const int& x) { return x / 2; });
+    assert(halves.getSize() == 500 && halves.select(499) == 499);
+    PersistentBinarySearchTree<int> odd = snapshot.where([](const int& x) { return x % 2 != 0; });
+    assert(odd.getSize() == 500 && odd.select(0) == 1);
+    assert(snapshot.getSize() == 1000);
+    
+    // Из равных после map значений остаётся первое в порядке обхода, как в BinarySearchTree::map
+    // (номер i переходит в 7i mod 500; первым из равных 7i идёт i = 143k mod 500, так как 7 * 143 = 1001)
+    PersistentBinarySearchTree<Student> students;
+    for (int i = 0; i < 2000; ++i) {
+        students.insert(Student(PersonID{0, i}, std::to_string(i), "", "", 0, "", 0.0));
+    }
+    PersistentBinarySearchTree<Student> merged = students.map([](const Student& s) {
+        return Student(PersonID{0, s.GetID().number * 7 % 500}, s.GetFirstName(), "", "", 0, "", 0.0);
+    });
+    std::vector<Student> mergedValues = merged.getValuesInOrder();
+    assert(mergedValues.size() == 500);
+    for (int k = 0; k < 500; ++k) {
+        assert(mergedValues[k].GetFirstName() == std::to_string(k * 143 % 500));
+    }
+    
+    // Преобразование в обычное дерево и обратно; toString совпадает
+    BinarySearchTree<int, AVLBalanced> regular = odd.toTree();
+    assert(regular.getSize() == 500);
+    assert(regular.toString() == odd.toString());
+    PersistentBinarySearchTree<int> restored = PersistentBinarySearchTree<int>::fromTree(regular);
+    assert(restored.getValuesInOrder() == odd.getValuesInOrder());
+    std::vector<int> unsorted = {5, 3, 9, 3, 1};
+    assert(PersistentBinarySearchTree<int>::fromSorted(unsorted.begin(), unsorted.end()).toString() == "[1, 3, 5, 9]");
+    
+    bool thrown = false;
+    try {
+        odd.select(500);
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+    
+    // Читатель обходит снимок в другом потоке, пока писатель изменяет дерево
+    PersistentBinarySearchTree<int> shared = PersistentBinarySearchTree<int>::fromSorted(expected.begin(), expected.end());
+    PersistentBinarySearchTree<int> view = shared.snapshot();
+    std::atomic<bool> consistent(true);
+    std::thread reader([&view, &expected, &consistent]() {
+        for (int pass = 0; pass < 50; ++pass) {
+            if (view.getValuesInOrder() != expected || view.select(500) != 500) {
+                consistent = false;
+            }
+        }
+    });
+    for (int i = 0; i < 20000; ++i) {
+        shared.insert(1000 + i);
+        shared.remove(i % 1000);
+    }
+    reader.join();
+    assert(consistent);
+    assert(view.getSize() == 1000);
+    
+    // Строки
+    PersistentBinarySearchTree<std::string> words;
+    words.insert("b");
+    words.insert("a");
+    PersistentBinarySearchTree<std::string> wordsSnapshot = words;
+    words.insert("c");
+    assert(words.toString() == "[a, b, c]");
+    assert(wordsSnapshot.getSize() == 2);
+    
+    std::cout << "Тест персистентного дерева пройден!" << std::endl;
+}
+
+// Значение, считающее свои копирования: перемещение не должно их добавлять
+struct CopyCounted {
+    static int copies;
+    
+    int key;
+    std::string payload;
+    
+    CopyCounted(int key, std::string payload) : key(key), payload(std::move(payload)) {}
+    CopyCounted(const CopyCounted& other) : key(other.key), payload(other.payload) { ++copies; }
+    CopyCounted(CopyCounted&&) = default;
+    CopyCounted& operator=(const CopyCounted& other) {
+        key = other.key;
+        payload = other.payload;
+        ++copies;
+        return *this;
+    }
+    CopyCounted& operator=(CopyCounted&&) = default;
+    
+    bool operator==(const CopyCounted& other) const { return key == other.key; }
+    bool operator<(const CopyCounted& other) const { return key < other.key; }
+    bool operator>(const CopyCounted& other) const { return key > other.key; }
+};
+
+int CopyCounted::copies = 0;
+
+// Тест перемещения деревьев и вставки перемещением
+void testMoveSemantics() {
+    std::cout << "Запуск теста перемещения деревьев..." << std::endl;
+    
+    // Вставка, emplace, удаление и балансировка не копируют значения
+    BinarySearchTree<CopyCounted, AVLBalanced> tree;
+    CopyCounted::copies = 0;
+    for (int i = 0; i < 1000; ++i) {
+        int key = (i * 7919) % 1000;
+        if (i % 2 == 0) {
+            CopyCounted value(key, "value " + std::to_string(key));
+            tree.insert(std::move(value));
+        } else {
+            tree.emplace(key, "value " + std::to_string(key));
+        }
+    }
+    tree.emplace(5, "duplicate");
+    for (int i = 0; i < 1000; i += 3) {
+        assert(tree.remove(CopyCounted(i, "")));
+    }
+    assert(CopyCounted::copies == 0);
+    assert(tree.getSize() == 666);
+    assert(tree.select(0).key == 1 && tree.select(0).payload == "value 1");
+    
+    // Перемещение забирает узлы, исходное дерево остаётся пустым и пригодным
+    BinarySearchTree<CopyCounted, AVLBalanced> moved(std::move(tree));
+    assert(CopyCounted::copies == 0);
+    assert(moved.getSize() == 666 && moved.search(CopyCounted(2, "")));
+    assert(tree.isEmpty() && tree.getHeight() == 0);
+    tree.emplace(-1, "reused");
+    assert(tree.getSize() == 1);
+    
+    tree = std::move(moved);
+    assert(CopyCounted::copies == 0);
+    assert(tree.getSize() == 666 && !tree.search(CopyCounted(-1, "")));
+    assert(moved.isEmpty());
+    
+    // Результаты map и extractSubtree присваиваются перемещением
+    BinarySearchTree<int> numbers;
+    for (int i = 0; i < 100; ++i) {
+        numbers.insert(i);
+    }
+    BinarySearchTree<int> doubled;
+    doubled = numbers.map([](const int& x) { return x * 2; });
+    assert(doubled.getSize() == 100 && doubled.search(198));
+    
+    // Деревья с пулом: копии распределителя разделяют пул, оба дерева остаются рабочими
+    using PoolTree = BinarySearchTree<std::string, AVLBalanced, PoolAllocator<std::string>>;
+    PoolTree pooled;
+    for (int i = 0; i < 100; ++i) {
+        pooled.insert(std::to_string(i));
+    }
+    PoolTree pooledMoved(std::move(pooled));
+    pooled.insert("after move");
+    pooledMoved.insert("another");
+    assert(pooled.getSize() == 1 && pooledMoved.getSize() == 101);
+    pooled = std::move(pooledMoved);
+    assert(pooled.getSize() == 101 && pooledMoved.isEmpty());
+    pooledMoved.insert("again");
+    assert(pooledMoved.getSize() == 1);
+    
+    // Студенты строятся прямо из аргументов конструктора
+    BinarySearchTree<Student, AVLBalanced> students;
+    students.emplace(PersonID{1, 1}, "Иван", "Иванович", "Иванов", 0, "Б01", 4.5);
+    Student student(PersonID{1, 2}, "Пётр", "Петрович", "Петров", 0, "Б02", 4.0);
+    students.insert(std::move(student));
+    assert(students.getSize() == 2);
+    assert(students.select(1).GetLastName() == "Петров");
+    assert(students.select(0).GetGroupNumber() == "Б01");
+    
+    std::cout << "Тест перемещения деревьев пройден!" << std::endl;
+}
+
 int main() {
     setlocale(LC_ALL, "Russian");
     setlocale(LC_ALL, "ru_RU.UTF-8");
@@ -554,6 +1912,25 @@ int main() {
         testFromNodeParentPairs();
         testSubtreeExtraction();
         testSubtreeSearch();
+        testAVLBalancing();
+        testLinearBalance();
+        testDegenerateTreeStress();
+        testPoolAllocatedTree();
+        testOrderStatistics();
+        testRangeQueries();
+        testBidirectionalIterators();
+        testTemplateTraversal();
+        testParallelMapWhere();
+        testAssociativeReduce();
+        testNumericConversions();
+        testStreamingParse();
+        testStreamSerialization();
+        testBinarySnapshot();
+        testMappedTree();
+        testNodeParentPairsValidation();
+        testSubtreeHashes();
+        testPersistentTree();
+        testMoveSemantics();
         
         std::cout << "Все тесты успешно пройдены!" << std::endl;
         std::cin.get();
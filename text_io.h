@@ -0,0 +1,377 @@
+#ifndef TEXT_IO_H
+#define TEXT_IO_H
+
+#include <string>
+#include <string_view>
+#include <optional>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+#include <utility>
+#include <istream>
+#include <ostream>
+#include <cctype>
+#include "data_types.h"
+
+// Разбиение текста на элементы по разделителю без копирования
+// Элементы возвращаются как std::string_view, указывающие в исходный текст, поэтому текст
+// должен существовать, пока используются элементы. Текст просматривается один раз, слева направо.
+// Пустой элемент после последнего разделителя (как и пустой текст) элементом не считается.
+class ValueTokenizer {
+private:
+    std::string_view rest;      // Ещё не разобранная часть текста
+    std::string_view separator; // Разделитель элементов
+    bool finished;              // Все элементы возвращены
+
+public:
+    ValueTokenizer(std::string_view text, std::string_view separator)
+        : rest(text), separator(separator), finished(text.empty()) {}
+
+    // Получение следующего элемента; false, если элементов больше нет
+    bool next(std::string_view& token) {
+        if (finished) {
+            return false;
+        }
+        size_t pos = rest.find(separator);
+        if (pos == std::string_view::npos) {
+            token = rest;
+            finished = true;
+            return true;
+        }
+        token = rest.substr(0, pos);
+        rest.remove_prefix(pos + separator.size());
+        finished = rest.empty();
+        return true;
+    }
+};
+
+// Текст без первого и последнего символа (квадратных скобок списка)
+// Строка короче двух символов считается пустым списком
+inline std::string_view stripBrackets(std::string_view text) {
+    if (text.size() < 2) {
+        return std::string_view();
+    }
+    return text.substr(1, text.size() - 2);
+}
+
+// Преобразование элемента в значение; пустой результат, если элемент некорректен
+// В отличие от tryValueFromString, не требует конструктора по умолчанию у T
+template <typename T>
+std::optional<T> valueFromToken(std::string_view token) {
+    if constexpr (IsCharsConvertible<T>::value) {
+        T value{};
+        if (numberFromChars(token, value)) {
+            return value;
+        }
+        return std::nullopt;
+    } else {
+        try {
+            return valueFromString<T>(std::string(token));
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+    }
+}
+
+
+
+// Буферизованная запись в поток участками по chunkSize байт
+// Интерфейс (+= и appendValue) совпадает со std::string, поэтому один и тот же код может
+// формировать строку целиком или записывать её в поток, не держа в памяти весь текст.
+// flush() нужно вызвать по окончании записи: деструктор дописывает остаток, но не сообщает об ошибках.
+class ChunkedWriter {
+private:
+    std::ostream& out;  // Поток назначения
+    std::string buffer; // Ещё не записанные символы
+
+    void flushIfFull() {
+        if (buffer.size() >= chunkSize) {
+            flush();
+        }
+    }
+
+public:
+    static constexpr size_t chunkSize = 64 * 1024;
+
+    explicit ChunkedWriter(std::ostream& out) : out(out), buffer() {
+        buffer.reserve(chunkSize + maxNumberChars);
+    }
+
+    ChunkedWriter(const ChunkedWriter&) = delete;
+    ChunkedWriter& operator=(const ChunkedWriter&) = delete;
+
+    ~ChunkedWriter() {
+        if (!buffer.empty()) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        }
+    }
+
+    ChunkedWriter& operator+=(char c) {
+        buffer += c;
+        flushIfFull();
+        return *this;
+    }
+
+    ChunkedWriter& operator+=(std::string_view text) {
+        buffer += text;
+        flushIfFull();
+        return *this;
+    }
+
+    // Запись значения (см. appendValue)
+    template <typename T>
+    void append(const T& value) {
+        appendValue(buffer, value);
+        flushIfFull();
+    }
+
+    // Запись накопленных символов в поток; при ошибке потока выбрасывается исключение
+    void flush() {
+        out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        buffer.clear();
+        if (!out) {
+            throw std::runtime_error("Ошибка записи в поток");
+        }
+    }
+};
+
+template <typename T>
+void appendValue(ChunkedWriter& out, const T& value) {
+    out.append(value);
+}
+
+// Буферизованное чтение из потока участками по chunkSize байт
+// В памяти хранится только текущий участок и начало элемента, пересекающего его границу.
+class ChunkedReader {
+private:
+    std::istream& in;   // Поток источника
+    std::string buffer; // Прочитанные символы; разобранная часть - до pos
+    size_t pos;         // Начало неразобранной части буфера
+    bool exhausted;     // Поток прочитан до конца
+    bool lastWithoutSeparator; // Последний элемент readUntil закончился концом потока
+
+    // Чтение следующего участка; разобранная часть буфера отбрасывается
+    // Возвращает false, если поток закончился
+    bool fill() {
+        if (exhausted) {
+            return false;
+        }
+        buffer.erase(0, pos);
+        pos = 0;
+        
+        size_t oldSize = buffer.size();
+        buffer.resize(oldSize + chunkSize);
+        in.read(&buffer[oldSize], static_cast<std::streamsize>(chunkSize));
+        size_t received = static_cast<size_t>(in.gcount());
+        buffer.resize(oldSize + received);
+        
+        if (in.bad()) {
+            throw std::runtime_error("Ошибка чтения из потока");
+        }
+        if (received < chunkSize) {
+            exhausted = true;
+        }
+        return received > 0;
+    }
+
+public:
+    static constexpr size_t chunkSize = 64 * 1024;
+
+    explicit ChunkedReader(std::istream& in)
+        : in(in), buffer(), pos(0), exhausted(false), lastWithoutSeparator(false) {}
+
+    // Пропуск пробельных символов; false, если поток закончился
+    bool skipSpace() {
+        while (true) {
+            while (pos < buffer.size() && std::isspace(static_cast<unsigned char>(buffer[pos]))) {
+                ++pos;
+            }
+            if (pos < buffer.size()) {
+                return true;
+            }
+            if (!fill()) {
+                return false;
+            }
+        }
+    }
+
+    // Извлечение одного символа; false, если поток закончился
+    bool get(char& c) {
+        if (pos == buffer.size() && !fill()) {
+            return false;
+        }
+        c = buffer[pos++];
+        return true;
+    }
+
+    // Чтение до разделителя (сам разделитель пропускается) или до конца потока
+    // Возвращает false, если данных не осталось. token действителен до следующего вызова.
+    bool readUntil(std::string_view separator, std::string_view& token) {
+        size_t scanned = 0; // Сколько символов после pos уже проверено
+        while (true) {
+            size_t found = buffer.find(separator.data(), pos + scanned, separator.size());
+            if (found != std::string::npos) {
+                token = std::string_view(buffer.data() + pos, found - pos);
+                pos = found + separator.size();
+                lastWithoutSeparator = false;
+                return true;
+            }
+            // Разделитель может начинаться в конце буфера и продолжаться в следующем участке
+            size_t available = buffer.size() - pos;
+            scanned = available >= separator.size() ? available - separator.size() + 1 : 0;
+            if (!fill()) {
+                break;
+            }
+        }
+        if (pos == buffer.size()) {
+            return false;
+        }
+        token = std::string_view(buffer.data() + pos, buffer.size() - pos);
+        pos = buffer.size();
+        lastWithoutSeparator = true;
+        return true;
+    }
+
+    // Закончился ли последний прочитанный readUntil элемент концом потока, а не разделителем
+    bool endedWithoutSeparator() const {
+        return lastWithoutSeparator;
+    }
+};
+
+// Отбрасывание пробельных символов в конце элемента
+inline std::string_view trimTrailingSpace(std::string_view text) {
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// Преобразование элемента в значение; при некорректном элементе выбрасывается исключение
+template <typename T>
+T valueFromTokenOrThrow(std::string_view token) {
+    std::optional<T> value = valueFromToken<T>(token);
+    if (!value) {
+        throw std::runtime_error("Некорректное значение: " + std::string(token));
+    }
+    return std::move(*value);
+}
+
+// Разбор пары вида "(node:parent)"; при нарушении формата выбрасывается исключение
+template <typename T>
+std::pair<T, T> nodeParentPairFromToken(std::string_view token) {
+    while (!token.empty() && std::isspace(static_cast<unsigned char>(token.front()))) {
+        token.remove_prefix(1);
+    }
+    token = trimTrailingSpace(token);
+    size_t colon = token.find(':');
+    if (token.size() < 2 || token.front() != '(' || token.back() != ')' || colon == std::string_view::npos) {
+        throw std::runtime_error("Некорректная пара узел-родитель: " + std::string(token));
+    }
+    return {valueFromTokenOrThrow<T>(token.substr(1, colon - 1)),
+            valueFromTokenOrThrow<T>(token.substr(colon + 1, token.size() - colon - 2))};
+}
+
+// Разбор списка пар вида "[(node:parent),(node:parent),...]" (формат toNodeParentPairs) за один проход
+// При нарушении формата выбрасывается исключение
+template <typename T>
+std::vector<std::pair<T, T>> parseNodeParentPairList(std::string_view text) {
+    std::vector<std::pair<T, T>> pairs;
+    ValueTokenizer tokenizer(stripBrackets(trimTrailingSpace(text)), ",");
+    std::string_view token;
+    while (tokenizer.next(token)) {
+        pairs.push_back(nodeParentPairFromToken<T>(token));
+    }
+    return pairs;
+}
+
+// Разбор списка пар вида "node-parent,node-parent,..." (как в меню дерева) за один проход
+// Разделитель ищется после первого символа пары, поэтому отрицательные значения допускаются
+// ("-5--3" - узел -5 и родитель -3). При нарушении формата выбрасывается исключение
+template <typename T>
+std::vector<std::pair<T, T>> parseNodeParentPairs(std::string_view text, char delimiter = '-') {
+    std::vector<std::pair<T, T>> pairs;
+    ValueTokenizer tokenizer(trimTrailingSpace(text), ",");
+    std::string_view token;
+    while (tokenizer.next(token)) {
+        size_t start = 0;
+        while (start < token.size() && std::isspace(static_cast<unsigned char>(token[start]))) {
+            ++start;
+        }
+        size_t split = token.find(delimiter, start + 1);
+        if (split == std::string_view::npos) {
+            throw std::runtime_error("Некорректная пара узел-родитель: " + std::string(token));
+        }
+        pairs.emplace_back(valueFromTokenOrThrow<T>(token.substr(0, split)),
+                           valueFromTokenOrThrow<T>(token.substr(split + 1)));
+    }
+    return pairs;
+}
+
+// Разбор списка вида "[value1,value2,...]" за один проход; значения добавляются в values
+// При некорректном элементе выбрасывается исключение
+template <typename T>
+void parseValueList(std::string_view text, std::vector<T>& values) {
+    ValueTokenizer tokenizer(stripBrackets(text), ",");
+    std::string_view token;
+    while (tokenizer.next(token)) {
+        values.push_back(valueFromTokenOrThrow<T>(token));
+    }
+}
+
+// Чтение списка вида "[value1<separator>value2...]" из потока до его конца
+// Для каждого элемента вызывается onItem(std::string_view); пустой поток - пустой список.
+// Пробельные символы перед '[' и после ']' допускаются; при нарушении формата выбрасывается исключение
+template <typename F>
+void readValueList(std::istream& in, std::string_view separator, F&& onItem) {
+    ChunkedReader reader(in);
+    if (!reader.skipSpace()) {
+        return;
+    }
+    char open = 0;
+    reader.get(open);
+    if (open != '[') {
+        throw std::runtime_error("Ожидался символ '[' в начале списка");
+    }
+    
+    std::string_view token;
+    while (reader.readUntil(separator, token)) {
+        if (!reader.endedWithoutSeparator()) {
+            onItem(token);
+            continue;
+        }
+        // Последний элемент завершается закрывающей скобкой
+        token = trimTrailingSpace(token);
+        if (token.empty() || token.back() != ']') {
+            break;
+        }
+        token.remove_suffix(1);
+        if (!token.empty()) {
+            onItem(token);
+        }
+        return;
+    }
+    throw std::runtime_error("Ожидался символ ']' в конце списка");
+}
+
+// Чтение из потока всех сегментов, заключённых в {}, () или [] (как fromStringFormatted)
+// Для каждого сегмента вызывается onSegment(std::string_view); незакрытый сегмент завершает чтение
+template <typename F>
+void readBracketSegments(std::istream& in, F&& onSegment) {
+    ChunkedReader reader(in);
+    char c = 0;
+    while (reader.get(c)) {
+        char close = 0;
+        if (c == '{') close = '}';
+        else if (c == '(') close = ')';
+        else if (c == '[') close = ']';
+        else continue;
+        
+        std::string_view segment;
+        if (!reader.readUntil(std::string_view(&close, 1), segment) || reader.endedWithoutSeparator()) {
+            return;
+        }
+        onSegment(segment);
+    }
+}
+
+#endif // TEXT_IO_H
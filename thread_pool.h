@@ -0,0 +1,178 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+// Режим выполнения массовых операций над контейнерами
+enum class ExecutionMode {
+    Sequential, // В вызывающем потоке
+    Parallel    // Участками на общем пуле потоков
+};
+
+// Пул рабочих потоков с общей очередью задач
+class ThreadPool {
+private:
+    std::vector<std::thread> workers;        // Рабочие потоки
+    std::queue<std::function<void()>> tasks; // Очередь задач
+    std::mutex mutex;                        // Защищает очередь и флаг остановки
+    std::condition_variable hasTasks;        // Сигнал о появлении задачи или остановке
+    bool stopping;                           // Пул останавливается
+
+    // Цикл рабочего потока
+    void workerLoop();
+
+    // Постановка задачи в очередь
+    void enqueue(std::function<void()> task);
+
+public:
+    // Пул из threadCount потоков (по умолчанию - по числу аппаратных потоков)
+    explicit ThreadPool(size_t threadCount = std::thread::hardware_concurrency());
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Количество рабочих потоков
+    size_t getThreadCount() const;
+
+    // Выполнение задачи в пуле; результат и исключение передаются через future
+    template <typename F>
+    auto submit(F task) -> std::future<decltype(task())>;
+
+    // Вызов body(i) для всех i из [0, count) на пуле потоков
+    // Вызывающий поток тоже выполняет итерации, поэтому вложенные вызовы из задач пула
+    // не приводят к взаимной блокировке. Первое исключение из body передаётся вызывающему.
+    template <typename F>
+    void parallelFor(size_t count, F&& body);
+
+    // Общий пул, создаваемый при первом обращении
+    static ThreadPool& shared();
+};
+
+// Реализация методов класса ThreadPool
+
+inline ThreadPool::ThreadPool(size_t threadCount) : workers(), tasks(), mutex(), hasTasks(), stopping(false) {
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+    workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+inline ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    hasTasks.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+inline void ThreadPool::workerLoop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            hasTasks.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (tasks.empty()) {
+                return; // Остановка: очередь разобрана
+            }
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
+
+inline void ThreadPool::enqueue(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(task));
+    }
+    hasTasks.notify_one();
+}
+
+inline size_t ThreadPool::getThreadCount() const {
+    return workers.size();
+}
+
+template <typename F>
+auto ThreadPool::submit(F task) -> std::future<decltype(task())> {
+    using Result = decltype(task());
+    auto packaged = std::make_shared<std::packaged_task<Result()>>(std::move(task));
+    std::future<Result> result = packaged->get_future();
+    enqueue([packaged]() { (*packaged)(); });
+    return result;
+}
+
+template <typename F>
+void ThreadPool::parallelFor(size_t count, F&& body) {
+    if (count == 0) {
+        return;
+    }
+
+    // Общее состояние живёт, пока его держит хотя бы один помощник: помощник, запущенный
+    // после завершения вызова, не находит свободных итераций и не обращается к body
+    struct Job {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::exception_ptr error;
+        std::function<void(size_t)> body;
+    };
+
+    auto job = std::make_shared<Job>();
+    job->body = [&body](size_t index) { body(index); };
+
+    auto run = [job, count]() {
+        size_t index;
+        while ((index = job->next.fetch_add(1)) < count) {
+            try {
+                job->body(index);
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                if (!job->error) {
+                    job->error = std::current_exception();
+                }
+            }
+            if (job->done.fetch_add(1) + 1 == count) {
+                std::lock_guard<std::mutex> lock(job->mutex);
+                job->finished.notify_all();
+            }
+        }
+    };
+
+    size_t helpers = std::min(count, workers.size() + 1) - 1;
+    for (size_t i = 0; i < helpers; ++i) {
+        enqueue(run);
+    }
+    run();
+
+    std::unique_lock<std::mutex> lock(job->mutex);
+    job->finished.wait(lock, [&job, count]() { return job->done.load() == count; });
+    if (job->error) {
+        std::rethrow_exception(job->error);
+    }
+}
+
+inline ThreadPool& ThreadPool::shared() {
+    static ThreadPool pool;
+    return pool;
+}
+
+#endif // THREAD_POOL_H
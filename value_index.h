@@ -0,0 +1,111 @@
+#ifndef VALUE_INDEX_H
+#define VALUE_INDEX_H
+
+#include <vector>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include "data_types.h"
+
+// Индекс для поиска номеров значений в последовательности valueAt(0), ..., valueAt(count - 1)
+// Индекс хранит только номера, а не копии значений, и строится за ожидаемое O(n) в два плоских
+// массива (как в формате CSR):
+//   1) номера раскладываются по корзинам хеша valueHash подсчётом, префиксной суммой и
+//      раскладкой; внутри корзины значения сравниваются через operator==;
+//   2) номера равных значений тем же способом собираются в группы - соседние места в порядке
+//      возрастания номеров, группа задаётся отрезком мест equalRange.
+// Для типов без хеш-функции valueHash постоянен, и все значения попадают в одну корзину:
+// индекс остаётся верным, но построение занимает O(n^2).
+template <typename ValueAt>
+class ValueIndex {
+public:
+    using T = typename std::decay<decltype(std::declval<ValueAt&>()(size_t()))>::type;
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+private:
+    ValueAt valueAt;                  // Доступ к значению по номеру
+    size_t mask;                      // Число корзин минус один (число корзин - степень двойки)
+    std::vector<size_t> hashes;       // Хеши значений по номерам
+    std::vector<size_t> bucketStart;  // Начало корзины в bucketSlots; bucketStart[b + 1] - её конец
+    std::vector<size_t> bucketSlots;  // Номера значений, разложенные по корзинам
+    std::vector<size_t> groupStart;   // Начало группы первого номера группы в members
+    std::vector<size_t> members;      // Номера значений, разложенные по группам равных
+    bool duplicates;                  // Есть ли равные значения
+
+    // Номер первого значения, равного value, в корзине по хешу hash, не больше limit
+    size_t findInBucket(const T& value, size_t hash, size_t limit) const {
+        size_t bucket = hash & mask;
+        for (size_t slot = bucketStart[bucket]; slot < bucketStart[bucket + 1]; ++slot) {
+            size_t index = bucketSlots[slot];
+            if (index > limit) break;
+            if (hashes[index] == hash && valueAt(index) == value) {
+                return index;
+            }
+        }
+        return npos;
+    }
+
+public:
+    ValueIndex(size_t count, ValueAt valueAt)
+        : valueAt(std::move(valueAt)), mask(0), hashes(count), bucketStart(), bucketSlots(count),
+          groupStart(count + 1, 0), members(count), duplicates(false) {
+        size_t buckets = 1;
+        while (buckets < count) buckets *= 2;
+        mask = buckets - 1;
+
+        // Корзины: подсчёт, префиксная сумма, раскладка (в корзине номера возрастают)
+        bucketStart.assign(buckets + 1, 0);
+        for (size_t i = 0; i < count; ++i) {
+            hashes[i] = valueHash(this->valueAt(i));
+            ++bucketStart[(hashes[i] & mask) + 1];
+        }
+        for (size_t b = 0; b < buckets; ++b) {
+            bucketStart[b + 1] += bucketStart[b];
+        }
+        std::vector<size_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+        for (size_t i = 0; i < count; ++i) {
+            bucketSlots[fill[hashes[i] & mask]++] = i;
+        }
+
+        // Группы: каждый номер относится к группе первого равного ему значения
+        std::vector<size_t> group(count);
+        for (size_t i = 0; i < count; ++i) {
+            group[i] = findInBucket(this->valueAt(i), hashes[i], i);
+            if (group[i] != i) duplicates = true;
+            ++groupStart[group[i] + 1];
+        }
+        for (size_t i = 0; i < count; ++i) {
+            groupStart[i + 1] += groupStart[i];
+        }
+        fill.assign(groupStart.begin(), groupStart.end() - 1);
+        for (size_t i = 0; i < count; ++i) {
+            members[fill[group[i]]++] = i;
+        }
+    }
+
+    // Номер первого значения, равного value, или npos, если такого значения нет
+    size_t find(const T& value) const {
+        return findInBucket(value, valueHash(value), npos);
+    }
+
+    // Отрезок мест [first, second) значений, равных value, в порядке их номеров
+    // (пустой, если таких значений нет)
+    std::pair<size_t, size_t> equalRange(const T& value) const {
+        size_t first = find(value);
+        if (first == npos) return {0, 0};
+        return {groupStart[first], groupStart[first + 1]};
+    }
+
+    // Номер значения, занимающего место position в группах равных
+    size_t indexAt(size_t position) const {
+        return members[position];
+    }
+
+    // Есть ли среди проиндексированных значений равные
+    bool hasDuplicates() const {
+        return duplicates;
+    }
+};
+
+#endif // VALUE_INDEX_H